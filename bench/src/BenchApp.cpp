@@ -0,0 +1,464 @@
+#include "BenchApp.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace essentia;
+
+namespace {
+// JSON keys for ProfileStage, in enum order
+const char* kStageKeys[Profiler::kNumStages] = {
+	"audio_handoff", "analysis", "field_lifecycle", "field_spawns", "field_order",
+	"field_erase", "geometry", "field_draw", "falling_petals",
+};
+
+std::vector<std::string> splitList(const std::string& s) {
+	std::vector<std::string> out;
+	std::stringstream ss(s);
+	std::string item;
+	while (std::getline(ss, item, ',')) {
+		if (!item.empty()) out.push_back(item);
+	}
+	return out;
+}
+
+// JSON string body: quotes, backslashes and every control byte escaped
+std::string jsonEscape(const std::string& s) {
+	std::string out;
+	for (char c : s) {
+		unsigned char u = (unsigned char)c;
+		if (c == '"' || c == '\\') {
+			out += '\\';
+			out += c;
+		} else if (c == '\n') {
+			out += "\\n";
+		} else if (c == '\t') {
+			out += "\\t";
+		} else if (u < 0x20) {
+			char buf[8];
+			std::snprintf(buf, sizeof(buf), "\\u%04x", u);
+			out += buf;
+		} else {
+			out += c;
+		}
+	}
+	return out;
+}
+}
+
+// ============================================================
+// Options
+// ============================================================
+
+bool BenchOptions::parse(int argc, char** argv, BenchOptions& out, std::string& error) {
+	CommandLine args(argc, argv);
+	while (args.next()) {
+		const std::string& arg = args.arg();
+		std::string v;
+		try {
+			if (arg == "--help" || arg == "-h") {
+				error.clear();
+				return false;
+			} else if (arg == "--audio") {
+				if (!args.value(v, error)) return false;
+				out.audioFiles.push_back(v);
+			} else if (arg == "--counts") {
+				if (!args.value(v, error)) return false;
+				out.flowerCounts.clear();
+				for (const auto& c : splitList(v)) out.flowerCounts.push_back(std::stoi(c));
+			} else if (arg == "--mixes") {
+				if (!args.value(v, error)) return false;
+				out.mixes = splitList(v);
+			} else if (arg == "--seconds") {
+				if (!args.value(v, error)) return false;
+				out.seconds = std::stof(v);
+			} else if (arg == "--warmup") {
+				if (!args.value(v, error)) return false;
+				out.warmupSeconds = std::stof(v);
+			} else if (arg == "--fps") {
+				if (!args.value(v, error)) return false;
+				out.fps = std::max(1, std::stoi(v));
+			} else if (arg == "--seed") {
+				if (!args.value(v, error)) return false;
+				out.seed = std::stoi(v);
+			} else if (arg == "--size") {
+				if (!args.value(v, error)) return false;
+				if (!parseSize(v, out.width, out.height)) {
+					error = "--size expects WxH";
+					return false;
+				}
+			} else if (arg == "--out") {
+				if (!args.value(v, error)) return false;
+				out.outPath = v;
+			} else if (arg == "--snapshot") {
+				if (!args.value(v, error)) return false;
+				out.snapshotPath = v;
+			} else if (arg == "--save-snapshot") {
+				if (!args.value(v, error)) return false;
+				out.saveSnapshotPath = v;
+			} else if (arg == "--no-render") {
+				out.render = false;
+			} else if (arg == "--immediate") {
+				out.instanced = false;
+			} else if (arg == "--no-lod") {
+				out.lod = false;
+			} else if (arg == "--sprites") {
+				out.sprites = true;
+			} else if (arg == "--profile") {
+				if (!args.value(v, error)) return false;
+				if (!AudioAnalyzer::profileFromName(v, out.profile)) {
+					error = "unknown analysis profile " + v;
+					return false;
+				}
+			} else if (!arg.empty() && arg[0] != '-') {
+				out.audioFiles.push_back(arg);
+			} else {
+				error = "unknown option " + arg;
+				return false;
+			}
+		} catch (const std::exception&) {
+			error = "bad value for " + arg + ": " + v;
+			return false;
+		}
+	}
+
+	if (out.audioFiles.empty()) {
+		error = "no audio files given";
+		return false;
+	}
+	if (out.flowerCounts.empty() || out.mixes.empty()) {
+		error = "need at least one flower count and one mix";
+		return false;
+	}
+	// The field is saved at the end of the warm-up, so there has to be one
+	if (!out.saveSnapshotPath.empty() && (int)(out.warmupSeconds * out.fps) < 1) {
+		error = "--save-snapshot needs a warm-up of at least one frame (--warmup)";
+		return false;
+	}
+	return true;
+}
+
+std::string BenchOptions::usage() {
+	return
+		"usage: musicalFlower_bench [options] <audio file>...\n"
+		"  --audio FILE      audio file to replay (WAV/FLAC/anything Essentia loads); repeatable\n"
+		"  --counts LIST     flower counts, default 300,800,5000\n"
+		"  --mixes LIST      head-type mixes: default, radial, phyllotaxis, rose,\n"
+		"                    superformula, whorls, dense (default: all but dense)\n"
+		"  --seconds S       measured seconds per scenario, default 20 (audio loops)\n"
+		"  --warmup S        unrecorded warm-up seconds, default 2\n"
+		"  --fps N           fixed timestep 1/N, default 60\n"
+		"  --seed N          RNG seed, default 1234\n"
+		"  --size WxH        offscreen render size, default 1024x768\n"
+		"  --no-render       simulate only, skip drawing\n"
+		"  --immediate       draw with the immediate (non-instanced) path\n"
+		"  --no-lod          draw every flower at full detail\n"
+		"  --sprites         draw small heads from the sprite atlas\n"
+		"  --profile NAME    analysis profile: low-latency, standard (default), precision\n"
+		"  --snapshot FILE   start each scenario from a saved field (replaces --counts)\n"
+		"  --save-snapshot FILE  save the field after the first scenario's warm-up\n"
+		"  --out FILE        write JSON to FILE instead of stdout\n";
+}
+
+// ============================================================
+// BenchApp
+// ============================================================
+
+BenchApp::BenchApp(const BenchOptions& o) : options(o) {
+}
+
+void BenchApp::setup() {
+	OfflineApp::setup();
+
+	if (options.render) {
+		ofFboSettings fboSettings;
+		fboSettings.width = options.width;
+		fboSettings.height = options.height;
+		fboSettings.internalformat = GL_RGBA;
+		fboSettings.useDepth = true;   // instanced petals depth-test
+		fbo.allocate(fboSettings);
+	}
+}
+
+void BenchApp::run() {
+	// A snapshot fixes the starting field, so it also fixes the flower count
+	std::vector<int> counts = options.flowerCounts;
+	if (!options.snapshotPath.empty()) {
+		if (!snapshot.open(options.snapshotPath)) {
+			ofLogError("Bench") << "Could not load snapshot " << options.snapshotPath;
+			exitCode = 1;
+			return;
+		}
+		counts = {(int)snapshot.header().flowerCount};
+	}
+
+	for (const auto& file : options.audioFiles) {
+		std::vector<Real> audio;
+		if (!loadMonoAudio(file, kSampleRate, kMinAudioSamples, audio, "Bench")) {
+			exitCode = 1;
+			continue;
+		}
+		for (const auto& mix : options.mixes) {
+			for (int count : counts) {
+				ofLogNotice("Bench") << file << " mix=" << mix << " flowers=" << count;
+				results.push_back(runScenario(audio, file, mix, count));
+			}
+		}
+	}
+
+	if (options.outPath.empty()) {
+		writeJson(std::cout);
+	} else {
+		std::ofstream out(options.outPath);
+		if (!out) {
+			ofLogError("Bench") << "Could not open " << options.outPath;
+			exitCode = 1;
+		} else {
+			writeJson(out);
+		}
+	}
+}
+
+bool BenchApp::mixWeights(const std::string& mix, std::array<float, kNumHeadTypes>& out) const {
+	// radial, phyllotaxis, rose curve, superformula, layered whorls
+	if (mix == "default") {
+		out = FlowerField().getHeadTypeWeights();
+	} else if (mix == "radial") {
+		out = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+	} else if (mix == "phyllotaxis") {
+		out = {0.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+	} else if (mix == "rose") {
+		out = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f};
+	} else if (mix == "superformula") {
+		out = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+	} else if (mix == "whorls") {
+		out = {0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+	} else if (mix == "dense") {
+		// Highest petal counts per head: worst case for layout and batching
+		out = {0.0f, 0.5f, 0.0f, 0.0f, 0.5f};
+	} else {
+		return false;
+	}
+	return true;
+}
+
+BenchApp::ScenarioResult BenchApp::runScenario(const std::vector<Real>& audio,
+                                                const std::string& file,
+                                                const std::string& mix, int flowers) {
+	ScenarioResult result;
+	result.audio = file;
+	result.mix = mix;
+	result.flowers = flowers;
+
+	std::array<float, kNumHeadTypes> weights;
+	if (!mixWeights(mix, weights)) {
+		ofLogWarning("Bench") << "Unknown mix '" << mix << "', using default";
+		mixWeights("default", weights);
+	}
+
+	// Fresh pipeline per scenario so smoothing/onset state never leaks across
+	AudioRingBuffer ring;
+	ring.allocate(kSampleRate / 2);
+	AudioAnalyzer analyzer;
+	AudioAnalyzer::Settings analysisSettings =
+		AudioAnalyzer::Settings::forProfile(options.profile, kSampleRate);
+	analyzer.setup(ring, analysisSettings);
+
+	FlowerField field;
+	field.setHeadTypeWeights(weights);
+	field.setRenderMode(options.instanced ? FieldRenderMode::INSTANCED : FieldRenderMode::IMMEDIATE);
+	LodSettings lod;
+	lod.enabled = options.lod;
+	lod.spriteAtlas = options.sprites;
+	field.setLodSettings(lod);
+	field.setCanvasSize(options.width, options.height);
+	field.setSeed(options.seed);
+	field.setup(flowers);
+	if (snapshot.isOpen()) {
+		if (!field.restoreSnapshot(snapshot)) exitCode = 1;
+		if (snapshot.header().hasTracker) analyzer.restoreTracker(snapshot.header().tracker);
+	}
+
+	Profiler& prof = Profiler::shared();
+	prof.setEnabled(true);
+	prof.endFrame(0.0f);   // discard anything recorded before this scenario
+
+	const float dt = 1.0f / options.fps;
+	const int warmupFrames = (int)(options.warmupSeconds * options.fps);
+	const int measuredFrames = std::max(1, (int)(options.seconds * options.fps));
+	const double samplesPerFrame = (double)kSampleRate / options.fps;
+
+	std::vector<float> frameMs;
+	std::array<std::vector<float>, Profiler::kNumStages> stageMs;
+	std::array<std::vector<float>, Profiler::kNumStages> workerMs;
+	frameMs.reserve(measuredFrames);
+	for (auto& v : stageMs) v.reserve(measuredFrames);
+	for (auto& v : workerMs) v.reserve(measuredFrames);
+
+	size_t cursor = 0;
+	double sampleDebt = 0.0;
+	auto wallStart = std::chrono::steady_clock::now();
+
+	for (int f = 0; f < warmupFrames + measuredFrames; f++) {
+		auto frameStart = std::chrono::steady_clock::now();
+
+		// Feed one frame's worth of audio, looping the file
+		sampleDebt += samplesPerFrame;
+		size_t toPush = (size_t)sampleDebt;
+		sampleDebt -= toPush;
+		{
+			ScopedTimer timer(ProfileStage::AUDIO_HANDOFF);
+			while (toPush > 0) {
+				size_t n = std::min(toPush, audio.size() - cursor);
+				ring.push(audio.data() + cursor, n);
+				cursor = (cursor + n) % audio.size();
+				toPush -= n;
+			}
+		}
+		result.hopsAnalyzed += analyzer.processPending();
+		{
+			ScopedTimer timer(ProfileStage::AUDIO_HANDOFF);
+			analyzer.update();
+		}
+
+		field.advance(analyzer.getFeatures(), dt);
+
+		if (options.render) {
+			fbo.begin();
+			ofClear(0, 0, 0, 255);
+			ofEnableAlphaBlending();
+			field.draw();
+			ofDisableAlphaBlending();
+			fbo.end();
+			glFinish();   // charge GPU work to the frame that issued it
+		}
+
+		float ms = (float)(secondsSince(frameStart) * 1000.0);
+		prof.endFrame(ms / 1000.0f);
+		if (f < warmupFrames) {
+			if (f == warmupFrames - 1) {
+				if (!options.saveSnapshotPath.empty() && !snapshotSaved) {
+					SnapshotBuilder builder;
+					field.saveSnapshot(builder);
+					builder.header().tracker = analyzer.getTrackerState();
+					builder.header().hasTracker = 1;
+					if (!SnapshotWriter::writeFile(options.saveSnapshotPath, builder.finish())) exitCode = 1;
+					snapshotSaved = true;
+				}
+				wallStart = std::chrono::steady_clock::now();
+			}
+			continue;
+		}
+
+		frameMs.push_back(ms);
+		for (int s = 0; s < Profiler::kNumStages; s++) {
+			stageMs[s].push_back(prof.getStageMs(0, (ProfileStage)s));
+			workerMs[s].push_back(prof.getWorkerStageMs(0, (ProfileStage)s));
+		}
+		result.drawCalls += prof.getCount(ProfileCounter::DRAW_CALLS);
+		result.rebuilds += prof.getCount(ProfileCounter::REBUILDS);
+		result.meshBuilds += prof.getCount(ProfileCounter::MESH_BUILDS);
+		result.liveFlowers += prof.getCount(ProfileCounter::INSTANCES);
+		int64_t falling = prof.getCount(ProfileCounter::FALLING_PETALS);
+		result.fallingPetals += falling;
+		result.peakFallingPetals = std::max(result.peakFallingPetals, falling);
+	}
+
+	result.wallSeconds = secondsSince(wallStart);
+	result.frames = measuredFrames;
+	result.frame = summarize(frameMs);
+	for (int s = 0; s < Profiler::kNumStages; s++) {
+		result.stages[s] = summarize(stageMs[s]);
+		result.workerStages[s] = summarize(workerMs[s]);
+	}
+	result.drawCalls /= measuredFrames;
+	result.rebuilds /= measuredFrames;
+	result.meshBuilds /= measuredFrames;
+	result.liveFlowers /= measuredFrames;
+	result.fallingPetals /= measuredFrames;
+	result.droppedHops = analyzer.getDroppedHops();
+
+	analyzer.stop();
+	return result;
+}
+
+BenchApp::StageStats BenchApp::summarize(std::vector<float>& samples) {
+	StageStats st;
+	if (samples.empty()) return st;
+	std::sort(samples.begin(), samples.end());
+	auto at = [&](double p) {
+		return samples[std::min(samples.size() - 1, (size_t)(p * (samples.size() - 1) + 0.5))];
+	};
+	double sum = 0.0;
+	for (float v : samples) sum += v;
+	st.mean = sum / samples.size();
+	st.p50 = at(0.50);
+	st.p95 = at(0.95);
+	st.p99 = at(0.99);
+	st.max = samples.back();
+	return st;
+}
+
+void BenchApp::writeJson(std::ostream& os) const {
+	auto stats = [&](const StageStats& st) {
+		std::ostringstream s;
+		s << std::fixed << std::setprecision(4)
+		  << "{\"mean_ms\": " << st.mean << ", \"p50_ms\": " << st.p50
+		  << ", \"p95_ms\": " << st.p95 << ", \"p99_ms\": " << st.p99
+		  << ", \"max_ms\": " << st.max << "}";
+		return s.str();
+	};
+
+	os << "{\n";
+	os << "  \"benchmark\": \"musicalFlower_bench\",\n";
+	os << "  \"seed\": " << options.seed << ",\n";
+	os << "  \"fps\": " << options.fps << ",\n";
+	os << "  \"seconds\": " << options.seconds << ",\n";
+	os << "  \"render\": " << (options.render ? "true" : "false") << ",\n";
+	os << "  \"render_mode\": \"" << (options.instanced ? "instanced" : "immediate") << "\",\n";
+	os << "  \"lod\": " << (options.lod ? "true" : "false") << ",\n";
+	os << "  \"sprites\": " << (options.sprites ? "true" : "false") << ",\n";
+	os << "  \"analysis_profile\": \"" << AudioAnalyzer::profileName(options.profile) << "\",\n";
+	os << "  \"size\": [" << options.width << ", " << options.height << "],\n";
+	os << "  \"snapshot\": \"" << jsonEscape(options.snapshotPath) << "\",\n";
+	os << "  \"scenarios\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const ScenarioResult& r = results[i];
+		double simSeconds = (double)r.frames / options.fps;
+		os << "    {\n";
+		os << "      \"audio\": \"" << jsonEscape(r.audio) << "\",\n";
+		os << "      \"mix\": \"" << jsonEscape(r.mix) << "\",\n";
+		os << "      \"flowers\": " << r.flowers << ",\n";
+		os << "      \"frames\": " << r.frames << ",\n";
+		os << std::fixed << std::setprecision(3);
+		os << "      \"frames_per_second\": " << (r.wallSeconds > 0.0 ? r.frames / r.wallSeconds : 0.0) << ",\n";
+		os << "      \"realtime_factor\": " << (r.wallSeconds > 0.0 ? simSeconds / r.wallSeconds : 0.0) << ",\n";
+		os << "      \"hops_analyzed\": " << r.hopsAnalyzed << ",\n";
+		os << "      \"dropped_hops\": " << r.droppedHops << ",\n";
+		os << "      \"frame\": " << stats(r.frame) << ",\n";
+		os << "      \"stages\": {\n";
+		for (int s = 0; s < Profiler::kNumStages; s++) {
+			os << "        \"" << kStageKeys[s] << "\": " << stats(r.stages[s])
+			   << (s + 1 < Profiler::kNumStages ? ",\n" : "\n");
+		}
+		os << "      },\n";
+		os << "      \"worker_stages\": {\n";
+		for (int s = 0; s < Profiler::kNumStages; s++) {
+			os << "        \"" << kStageKeys[s] << "\": " << stats(r.workerStages[s])
+			   << (s + 1 < Profiler::kNumStages ? ",\n" : "\n");
+		}
+		os << "      },\n";
+		os << "      \"counters\": {\"draw_calls\": " << r.drawCalls
+		   << ", \"rebuilds\": " << r.rebuilds
+		   << ", \"mesh_builds\": " << r.meshBuilds
+		   << ", \"live_flowers\": " << r.liveFlowers
+		   << ", \"falling_petals\": " << r.fallingPetals
+		   << ", \"peak_falling_petals\": " << r.peakFallingPetals << "}\n";
+		os << std::defaultfloat;
+		os << "    }" << (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	os << "  ]\n";
+	os << "}\n";
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Flower.h"
+#include "AudioRingBuffer.h"
+#include "AudioAnalyzer.h"
+#include "Profiler.h"
+#include "OfflineApp.h"
+
+// --- Benchmark options (parsed from the command line) ---
+
+struct BenchOptions {
+	std::vector<std::string> audioFiles;
+	std::vector<int> flowerCounts = {300, 800, 5000};
+	std::vector<std::string> mixes = {"default", "radial", "phyllotaxis", "rose", "superformula", "whorls"};
+	float seconds = 20.0f;        // measured simulation time per scenario (audio loops)
+	float warmupSeconds = 2.0f;   // simulated but not recorded
+	int fps = 60;                 // fixed timestep = 1 / fps
+	int seed = 1234;
+	bool render = true;           // draw into an offscreen FBO
+	bool instanced = true;
+	bool lod = true;              // level of detail for small flowers
+	bool sprites = false;         // small heads from the sprite atlas (instanced only)
+	AnalysisProfile profile = AnalysisProfile::STANDARD;
+	int width = 1024;
+	int height = 768;
+	std::string outPath;          // empty = stdout
+	std::string snapshotPath;     // start every scenario from this field snapshot
+	std::string saveSnapshotPath; // write the field after the first warm-up
+
+	static bool parse(int argc, char** argv, BenchOptions& out, std::string& error);
+	static std::string usage();
+};
+
+// --- Headless benchmark ---
+// Replays audio files through the analysis chain and the flower field with a
+// fixed timestep and seeded RNG, one scenario per (file, head-type mix, flower
+// count), and writes per-stage latency percentiles as JSON.
+
+class BenchApp : public OfflineApp {
+public:
+	explicit BenchApp(const BenchOptions& options);
+
+	void setup() override;
+
+private:
+	struct StageStats {
+		double mean = 0.0, p50 = 0.0, p95 = 0.0, p99 = 0.0, max = 0.0;
+	};
+
+	struct ScenarioResult {
+		std::string audio;
+		std::string mix;
+		int flowers = 0;
+		int frames = 0;
+		double wallSeconds = 0.0;
+		StageStats frame;
+		std::array<StageStats, Profiler::kNumStages> stages;        // main thread, exclusive
+		std::array<StageStats, Profiler::kNumStages> workerStages;  // summed over pool workers
+		double drawCalls = 0.0;     // per-frame means
+		double rebuilds = 0.0;
+		double meshBuilds = 0.0;
+		double liveFlowers = 0.0;
+		double fallingPetals = 0.0;
+		int64_t peakFallingPetals = 0;
+		int hopsAnalyzed = 0;
+		uint64_t droppedHops = 0;
+	};
+
+	void run() override;
+	bool mixWeights(const std::string& mix, std::array<float, kNumHeadTypes>& out) const;
+	ScenarioResult runScenario(const std::vector<essentia::Real>& audio, const std::string& file,
+	                           const std::string& mix, int flowers);
+	static StageStats summarize(std::vector<float>& samples);
+	void writeJson(std::ostream& os) const;
+
+	BenchOptions options;
+	std::vector<ScenarioResult> results;
+	FieldSnapshot snapshot;
+	bool snapshotSaved = false;
+	ofFbo fbo;
+
+	static const int kSampleRate = 44100;
+	static const int kMinAudioSamples = 4096;   // one precision-profile window
+};
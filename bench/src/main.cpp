@@ -0,0 +1,27 @@
+#include "ofMain.h"
+#include "BenchApp.h"
+
+//========================================================================
+int main(int argc, char** argv){
+
+	BenchOptions options;
+	std::string error;
+	if(!BenchOptions::parse(argc, argv, options, error)){
+		if(!error.empty()) std::cerr << "error: " << error << "\n";
+		std::cerr << BenchOptions::usage();
+		return error.empty() ? 0 : 2;
+	}
+
+	// Hidden window: only needed for the GL context behind the offscreen FBO
+	ofGLFWWindowSettings settings;
+	settings.setSize(options.width, options.height);
+	settings.setGLVersion(3, 3);
+	settings.visible = false;
+
+	auto window = ofCreateWindow(settings);
+	auto app = std::make_shared<BenchApp>(options);
+	ofRunApp(window, app);
+	ofRunMainLoop();
+
+	return app->getExitCode();
+}
@@ -0,0 +1,127 @@
+#include "FfmpegWriter.h"
+#include "ofMain.h"
+#include <cstring>
+
+namespace {
+std::string shellQuote(const std::string& s) {
+	std::string out = "'";
+	for (char c : s) {
+		if (c == '\'') {
+			out += "'\\''";
+		} else {
+			out += c;
+		}
+	}
+	return out + "'";
+}
+}
+
+FfmpegWriter::~FfmpegWriter() {
+	close();
+}
+
+bool FfmpegWriter::open(const Settings& s) {
+	close();
+	settings = s;
+	frameBytes = (size_t)s.width * s.height * 4;
+
+	// -threads 0: one encoder thread per core. Output is bit-identical for the
+	// same input and settings on the same machine.
+	std::string cmd = "ffmpeg -y -loglevel error -f rawvideo -pix_fmt rgba";
+	cmd += " -s " + ofToString(s.width) + "x" + ofToString(s.height);
+	cmd += " -framerate " + ofToString(s.fps) + " -i -";
+	if (!s.audioPath.empty()) cmd += " -i " + shellQuote(s.audioPath);
+	if (s.bottomUp) cmd += " -vf vflip";
+	cmd += " -c:v " + shellQuote(s.codec) + " -crf " + ofToString(s.crf);
+	cmd += " -pix_fmt yuv420p -threads 0";
+	if (!s.audioPath.empty()) cmd += " -c:a aac -b:a 256k -shortest";
+	cmd += " " + shellQuote(s.outPath);
+	command = cmd;
+
+	pipe = popen(command.c_str(), "w");
+	if (!pipe) {
+		ofLogError("FfmpegWriter") << "Could not start: " << command;
+		return false;
+	}
+
+	buffers.assign(std::max(s.queueFrames, 1), std::vector<uint8_t>(frameBytes));
+	freeBuffers.clear();
+	for (int i = (int)buffers.size(); i-- > 0;) freeBuffers.push_back(i);
+	queued.clear();
+	closing = false;
+	failed = false;
+	written = 0;
+	writer = std::thread(&FfmpegWriter::run, this);
+	return true;
+}
+
+bool FfmpegWriter::push(const uint8_t* rgba) {
+	if (!pipe || failed) return false;
+	int idx;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		space.wait(lock, [this]{ return !freeBuffers.empty() || failed; });
+		if (failed) return false;
+		idx = freeBuffers.back();
+		freeBuffers.pop_back();
+	}
+	std::memcpy(buffers[idx].data(), rgba, frameBytes);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queued.push_back(idx);
+	}
+	wake.notify_one();
+	return true;
+}
+
+bool FfmpegWriter::close() {
+	if (!pipe) return !failed;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		closing = true;
+	}
+	wake.notify_one();
+	if (writer.joinable()) writer.join();
+
+	int status = pclose(pipe);
+	pipe = nullptr;
+	if (status != 0) {
+		ofLogError("FfmpegWriter") << "ffmpeg exited with status " << status;
+		failed = true;
+	}
+	return !failed;
+}
+
+uint64_t FfmpegWriter::getFramesWritten() const {
+	return written;
+}
+
+std::string FfmpegWriter::getCommand() const {
+	return command;
+}
+
+void FfmpegWriter::run() {
+	for (;;) {
+		int idx;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this]{ return !queued.empty() || closing; });
+			if (queued.empty()) return;
+			idx = queued.front();
+			queued.pop_front();
+		}
+
+		bool ok = !failed && std::fwrite(buffers[idx].data(), 1, frameBytes, pipe) == frameBytes;
+		if (ok) {
+			written++;
+		} else if (!failed) {
+			ofLogError("FfmpegWriter") << "Write to ffmpeg failed";
+			failed = true;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			freeBuffers.push_back(idx);
+		}
+		space.notify_one();
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// --- Raw RGBA frames piped into an ffmpeg process ---
+// push() copies a frame into one of a fixed set of buffers; a writer thread
+// feeds them to ffmpeg's stdin, so encoding overlaps rendering and ffmpeg
+// runs its encoder on every core. push() only blocks when all buffers are
+// still waiting to be written.
+
+class FfmpegWriter {
+public:
+	struct Settings {
+		int width = 0;
+		int height = 0;
+		int fps = 60;
+		std::string outPath;
+		std::string audioPath;        // muxed in when set
+		std::string codec = "libx264";
+		int crf = 18;
+		int queueFrames = 4;
+		// Rows arrive bottom row first; off by default because oF flips FBO
+		// drawing, so a read-back FBO already starts at the top of the image
+		bool bottomUp = false;
+	};
+
+	~FfmpegWriter();
+
+	bool open(const Settings& settings);
+	bool push(const uint8_t* rgba);   // width * height * 4 bytes
+	bool close();                     // drains the queue and waits for ffmpeg
+
+	uint64_t getFramesWritten() const;
+	std::string getCommand() const;
+
+private:
+	void run();
+
+	Settings settings;
+	std::string command;
+	FILE* pipe = nullptr;
+	size_t frameBytes = 0;
+
+	std::thread writer;
+	std::mutex mutex;
+	std::condition_variable wake;       // writer: a frame is queued or closing
+	std::condition_variable space;      // push: a buffer was freed
+	std::vector<std::vector<uint8_t>> buffers;
+	std::deque<int> queued;             // buffer indices in frame order
+	std::vector<int> freeBuffers;
+	bool closing = false;
+	std::atomic<bool> failed{false};
+	std::atomic<uint64_t> written{0};
+};
@@ -0,0 +1,249 @@
+#include "RenderApp.h"
+#include <chrono>
+
+using namespace essentia;
+
+// ============================================================
+// Options
+// ============================================================
+
+bool RenderOptions::parse(int argc, char** argv, RenderOptions& out, std::string& error) {
+	CommandLine args(argc, argv);
+	while (args.next()) {
+		const std::string& arg = args.arg();
+		std::string v;
+		try {
+			if (arg == "--help" || arg == "-h") {
+				error.clear();
+				return false;
+			} else if (arg == "--out" || arg == "-o") {
+				if (!args.value(v, error)) return false;
+				out.outPath = v;
+			} else if (arg == "--size") {
+				if (!args.value(v, error)) return false;
+				if (v == "4k") {
+					out.width = 3840;
+					out.height = 2160;
+				} else if (v == "8k") {
+					out.width = 7680;
+					out.height = 4320;
+				} else if (!parseSize(v, out.width, out.height)) {
+					error = "--size expects WxH, 4k or 8k";
+					return false;
+				}
+			} else if (arg == "--base-height") {
+				if (!args.value(v, error)) return false;
+				out.baseHeight = std::max(1, std::stoi(v));
+			} else if (arg == "--fps") {
+				if (!args.value(v, error)) return false;
+				out.fps = std::max(1, std::stoi(v));
+			} else if (arg == "--samples") {
+				if (!args.value(v, error)) return false;
+				out.samples = std::max(0, std::stoi(v));
+			} else if (arg == "--seed") {
+				if (!args.value(v, error)) return false;
+				out.seed = std::stoi(v);
+			} else if (arg == "--flowers") {
+				if (!args.value(v, error)) return false;
+				out.flowers = std::max(1, std::stoi(v));
+			} else if (arg == "--color") {
+				if (!args.value(v, error)) return false;
+				out.colorMode = std::stoi(v);
+			} else if (arg == "--codec") {
+				if (!args.value(v, error)) return false;
+				out.codec = v;
+			} else if (arg == "--crf") {
+				if (!args.value(v, error)) return false;
+				out.crf = std::stoi(v);
+			} else if (arg == "--reactive") {
+				out.reactive = true;
+			} else if (arg == "--sprites") {
+				out.sprites = true;
+			} else if (arg == "--no-audio") {
+				out.muxAudio = false;
+			} else if (arg == "--profile") {
+				if (!args.value(v, error)) return false;
+				if (!AudioAnalyzer::profileFromName(v, out.profile)) {
+					error = "unknown analysis profile " + v;
+					return false;
+				}
+			} else if (!arg.empty() && arg[0] != '-' && out.audioPath.empty()) {
+				out.audioPath = arg;
+			} else {
+				error = "unknown option " + arg;
+				return false;
+			}
+		} catch (const std::exception&) {
+			error = "bad value for " + arg + ": " + v;
+			return false;
+		}
+	}
+
+	if (out.audioPath.empty()) {
+		error = "no audio file given";
+		return false;
+	}
+	return true;
+}
+
+std::string RenderOptions::usage() {
+	return
+		"usage: musicalFlower_render [options] <audio file>\n"
+		"  --out FILE        output video, default render.mp4\n"
+		"  --size WxH        output size, or 4k / 8k; default 4k\n"
+		"  --base-height N   height the field is laid out at, default 768 (scaled up to --size)\n"
+		"  --fps N           frame rate and fixed timestep 1/N, default 60\n"
+		"  --samples N       MSAA samples, default 4 (0 = off)\n"
+		"  --seed N          RNG seed, default 1234\n"
+		"  --flowers N       flower count, default 300\n"
+		"  --reactive        reactive mode (flower count follows the music)\n"
+		"  --color N         color mode: 0 cycling, 1-8 scheme, 9 random\n"
+		"  --sprites         draw small heads from the sprite atlas\n"
+		"  --profile NAME    analysis profile: low-latency, standard (default), precision\n"
+		"  --codec NAME      ffmpeg video encoder, default libx264\n"
+		"  --crf N           encoder quality, default 18\n"
+		"  --no-audio        don't mux the source audio into the output\n";
+}
+
+// ============================================================
+// RenderApp
+// ============================================================
+
+RenderApp::RenderApp(const RenderOptions& o) : options(o) {
+}
+
+void RenderApp::setup() {
+	OfflineApp::setup();
+
+	ofFboSettings msaaSettings;
+	msaaSettings.width = options.width;
+	msaaSettings.height = options.height;
+	msaaSettings.internalformat = GL_RGBA8;
+	msaaSettings.numSamples = options.samples;
+	msaaSettings.useDepth = true;   // instanced petals depth-test
+	msaa.allocate(msaaSettings);
+
+	ofFboSettings resolvedSettings;
+	resolvedSettings.width = options.width;
+	resolvedSettings.height = options.height;
+	resolvedSettings.internalformat = GL_RGBA8;
+	resolved.allocate(resolvedSettings);
+
+	size_t frameBytes = (size_t)options.width * options.height * 4;
+	for (auto& pbo : readback) pbo.allocate(frameBytes, GL_STREAM_READ);
+}
+
+void RenderApp::run() {
+	std::vector<Real> audio;
+	if (!loadMonoAudio(options.audioPath, kSampleRate, 1, audio, "Render") || !render(audio)) exitCode = 1;
+}
+
+bool RenderApp::render(const std::vector<Real>& audio) {
+	if (!msaa.isAllocated() || !resolved.isAllocated()) {
+		ofLogError("Render") << "Could not allocate a " << options.width << "x" << options.height
+			<< " framebuffer";
+		return false;
+	}
+
+	FfmpegWriter::Settings encode;
+	encode.width = options.width;
+	encode.height = options.height;
+	encode.fps = options.fps;
+	encode.outPath = options.outPath;
+	encode.audioPath = options.muxAudio ? options.audioPath : "";
+	encode.codec = options.codec;
+	encode.crf = options.crf;
+	if (!writer.open(encode)) return false;
+	ofLogNotice("Render") << writer.getCommand();
+
+	// Synchronous analysis: hops are processed as soon as their samples are
+	// pushed, so the features match the audio clock exactly
+	AudioRingBuffer ring;
+	ring.allocate(kSampleRate / 2);
+	AudioAnalyzer analyzer;
+	analyzer.setup(ring, AudioAnalyzer::Settings::forProfile(options.profile, kSampleRate));
+
+	// The field is laid out at the base height and drawn scaled up, so a
+	// 4K render shows the same composition as the window, only sharper
+	float scale = (float)options.height / options.baseHeight;
+	FlowerField field;
+	field.setRenderMode(FieldRenderMode::INSTANCED);
+	field.setReactiveMode(options.reactive);
+	field.setColorMode(options.colorMode);
+	LodSettings lod;
+	lod.pixelScale = scale;
+	lod.spriteAtlas = options.sprites;
+	field.setLodSettings(lod);
+	field.setCanvasSize(options.width / scale, options.height / scale);
+	field.setTickRate(options.fps);
+	field.setSeed(options.seed);
+	field.setup(options.flowers);
+
+	const float dt = 1.0f / options.fps;
+	const double samplesPerFrame = (double)kSampleRate / options.fps;
+	const int totalFrames = (int)std::ceil(audio.size() / samplesPerFrame);
+
+	size_t cursor = 0;
+	double sampleDebt = 0.0;
+	auto wallStart = std::chrono::steady_clock::now();
+	bool ok = true;
+	int frame = 0;
+	for (; frame < totalFrames && ok; frame++) {
+		sampleDebt += samplesPerFrame;
+		size_t toPush = std::min((size_t)sampleDebt, audio.size() - cursor);
+		sampleDebt -= (size_t)sampleDebt;
+		ring.push(audio.data() + cursor, toPush);
+		cursor += toPush;
+		analyzer.processPending();
+		analyzer.update();
+
+		field.advance(analyzer.getFeatures(), dt);
+
+		msaa.begin();
+		ofClear(0, 0, 0, 255);
+		ofEnableAlphaBlending();
+		field.draw();
+		ofDisableAlphaBlending();
+		msaa.end();
+
+		resolveAndCopy(frame);
+		if (frame >= kReadbackDepth - 1) ok = emit(frame - (kReadbackDepth - 1));
+
+		if (frame % (options.fps * 10) == 0) {
+			ofLogNotice("Render") << "frame " << frame << " / " << totalFrames;
+		}
+	}
+
+	// Frames still in flight
+	for (int f = std::max(frame - (kReadbackDepth - 1), 0); f < frame && ok; f++) {
+		ok = emit(f);
+	}
+	ok = writer.close() && ok;
+
+	double wall = secondsSince(wallStart);
+	double mediaSeconds = (double)frame / options.fps;
+	ofLogNotice("Render") << writer.getFramesWritten() << " frames in " << wall << " s ("
+		<< (wall > 0.0 ? mediaSeconds / wall : 0.0) << "x real time) -> " << options.outPath;
+	analyzer.stop();
+	return ok;
+}
+
+// Blit the multisampled frame down, then start an asynchronous copy into
+// this frame's pixel buffer; glReadPixels into a bound PBO returns at once
+void RenderApp::resolveAndCopy(int frame) {
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, msaa.getId());
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolved.getId());
+	glBlitFramebuffer(0, 0, options.width, options.height, 0, 0, options.width, options.height,
+		GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	resolved.copyTo(readback[frame % kReadbackDepth]);
+}
+
+// By now the copy has had kReadbackDepth - 1 frames of GPU time to land
+bool RenderApp::emit(int frame) {
+	ofBufferObject& pbo = readback[frame % kReadbackDepth];
+	const uint8_t* pixels = pbo.map<uint8_t>(GL_READ_ONLY);
+	bool ok = pixels && writer.push(pixels);
+	pbo.unmap();
+	return ok;
+}
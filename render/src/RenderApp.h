@@ -0,0 +1,63 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Flower.h"
+#include "AudioRingBuffer.h"
+#include "AudioAnalyzer.h"
+#include "FfmpegWriter.h"
+#include "OfflineApp.h"
+
+// --- Render options (parsed from the command line) ---
+
+struct RenderOptions {
+	std::string audioPath;
+	std::string outPath = "render.mp4";
+	int width = 3840;
+	int height = 2160;
+	int baseHeight = 768;         // canvas height the composition is laid out at
+	int fps = 60;                 // fixed timestep = 1 / fps
+	int samples = 4;              // MSAA samples, 0 = off
+	int seed = 1234;
+	int flowers = 300;
+	bool reactive = false;
+	int colorMode = 0;
+	bool sprites = false;
+	AnalysisProfile profile = AnalysisProfile::STANDARD;
+	std::string codec = "libx264";
+	int crf = 18;
+	bool muxAudio = true;
+
+	static bool parse(int argc, char** argv, RenderOptions& out, std::string& error);
+	static std::string usage();
+};
+
+// --- Offline render ---
+// Replays one audio file through the analysis chain as fast as it decodes,
+// steps the field once per output frame, draws each frame into a multisampled
+// FBO at the output size and streams it to ffmpeg. Readback goes through a
+// ring of pixel buffers: a frame is copied on the GPU when it is drawn and
+// mapped kReadbackDepth - 1 frames later, so the CPU never waits on
+// glReadPixels. The same seed and options give the same frames every run.
+
+class RenderApp : public OfflineApp {
+public:
+	explicit RenderApp(const RenderOptions& options);
+
+	void setup() override;
+
+private:
+	static const int kReadbackDepth = 3;
+
+	void run() override;
+	bool render(const std::vector<essentia::Real>& audio);
+	void resolveAndCopy(int frame);
+	bool emit(int frame);
+
+	RenderOptions options;
+	ofFbo msaa;                     // drawn into
+	ofFbo resolved;                 // single-sample copy for readback
+	std::array<ofBufferObject, kReadbackDepth> readback;
+	FfmpegWriter writer;
+
+	static const int kSampleRate = 44100;
+};
@@ -0,0 +1,31 @@
+#include "ofMain.h"
+#include "RenderApp.h"
+#include <csignal>
+
+//========================================================================
+int main(int argc, char** argv){
+
+	RenderOptions options;
+	std::string error;
+	if(!RenderOptions::parse(argc, argv, options, error)){
+		if(!error.empty()) std::cerr << "error: " << error << "\n";
+		std::cerr << RenderOptions::usage();
+		return error.empty() ? 0 : 2;
+	}
+
+	// A dead encoder shows up as a failed write, not a SIGPIPE
+	std::signal(SIGPIPE, SIG_IGN);
+
+	// Hidden window: only needed for the GL context behind the offscreen FBOs
+	ofGLFWWindowSettings settings;
+	settings.setSize(640, 360);
+	settings.setGLVersion(3, 3);
+	settings.visible = false;
+
+	auto window = ofCreateWindow(settings);
+	auto app = std::make_shared<RenderApp>(options);
+	ofRunApp(window, app);
+	ofRunMainLoop();
+
+	return app->getExitCode();
+}
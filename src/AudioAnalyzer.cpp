@@ -0,0 +1,309 @@
+#include "AudioAnalyzer.h"
+#include "Profiler.h"
+#include <cmath>
+
+using namespace essentia;
+using namespace essentia::standard;
+
+namespace {
+// Smoothing is defined by time constants (seconds) so it behaves the same
+// for any hop size; alpha = 1 - exp(-dt / tau)
+const float kPitchTau = 0.018f;        // pitch/confidence follow
+const float kConfidenceDecayTau = 0.33f;
+
+float emaAlpha(float dt, float tau) {
+	return 1.0f - std::exp(-dt / tau);
+}
+
+struct ProfileDef {
+	const char* name;
+	int frameSize;
+	int hopSize;
+	int bufferSize;
+};
+
+const ProfileDef kProfiles[kNumAnalysisProfiles] = {
+	{"low-latency", 1024, 256, 128},
+	{"standard",    2048, 512, 512},
+	{"precision",   4096, 512, 512},
+};
+}
+
+AudioAnalyzer::Settings AudioAnalyzer::Settings::forProfile(AnalysisProfile profile, int sampleRate) {
+	// Keep the window length in seconds at 88.2 kHz and up
+	int scale = 1;
+	while (sampleRate >= 48000 * scale * 1.5f) scale *= 2;
+
+	const ProfileDef& def = kProfiles[(int)profile];
+	Settings s;
+	s.frameSize = def.frameSize * scale;
+	s.hopSize = def.hopSize * scale;
+	s.bufferSize = def.bufferSize * scale;
+	s.sampleRate = sampleRate;
+	return s;
+}
+
+const char* AudioAnalyzer::profileName(AnalysisProfile profile) {
+	return kProfiles[(int)profile].name;
+}
+
+bool AudioAnalyzer::profileFromName(const std::string& name, AnalysisProfile& out) {
+	for (int i = 0; i < kNumAnalysisProfiles; i++) {
+		if (name == kProfiles[i].name) {
+			out = (AnalysisProfile)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+AudioAnalyzer::~AudioAnalyzer() {
+	stop();
+}
+
+void AudioAnalyzer::setup(AudioRingBuffer& r, const Settings& s) {
+	ring = &r;
+
+	AlgorithmFactory& factory = AlgorithmFactory::instance();
+	windowing = factory.create("Windowing");
+	spectrum = factory.create("Spectrum");
+	pitchYinFFT = factory.create("PitchYinFFT");
+	applySettings(s);
+	{
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		pendingSettings = s;
+	}
+
+	AudioFeatures blank;
+	blank.spectrum.assign(settings.frameSize / 2 + 1, 0.0f);
+	blank.spectrumDb.assign(settings.frameSize / 2 + 1, -200.0f);
+	features.reset(blank);
+}
+
+void AudioAnalyzer::configure(const Settings& s) {
+	std::lock_guard<std::mutex> lock(pendingMutex);
+	pendingSettings = s;
+	configPending.store(true, std::memory_order_release);
+}
+
+AudioAnalyzer::Settings AudioAnalyzer::getSettings() const {
+	std::lock_guard<std::mutex> lock(pendingMutex);
+	return pendingSettings;
+}
+
+// Worker thread (or setup): reconfigure Essentia and resize buffers. Only
+// happens on a profile switch, so allocating here is fine.
+void AudioAnalyzer::applySettings(const Settings& s) {
+	settings = s;
+
+	windowing->configure(
+		"type", "hann",
+		"size", settings.frameSize,
+		"zeroPadding", 0);
+
+	spectrum->configure(
+		"size", settings.frameSize);
+
+	pitchYinFFT->configure(
+		"frameSize", settings.frameSize,
+		"sampleRate", (Real)settings.sampleRate);
+
+	// Pre-allocate buffers (hops never allocate)
+	frame.assign(settings.frameSize, 0.0f);
+	windowedFrame.assign(settings.frameSize, 0.0f);
+	spectrumValues.assign(settings.frameSize / 2 + 1, 0.0f);
+	spectralKernel.setup(settings.frameSize, (float)settings.sampleRate);
+	onsets.setup((float)settings.hopSize / settings.sampleRate);
+}
+
+void AudioAnalyzer::start() {
+	if (running || !ring) return;
+	running = true;
+	worker = std::thread(&AudioAnalyzer::threadedFunction, this);
+}
+
+void AudioAnalyzer::stop() {
+	running = false;
+	if (worker.joinable()) worker.join();
+	freeAlgorithms();
+}
+
+void AudioAnalyzer::freeAlgorithms() {
+	if (windowing) AlgorithmFactory::free(windowing);
+	if (spectrum) AlgorithmFactory::free(spectrum);
+	if (pitchYinFFT) AlgorithmFactory::free(pitchYinFFT);
+	windowing = spectrum = pitchYinFFT = nullptr;
+}
+
+bool AudioAnalyzer::update() {
+	return features.update();
+}
+
+const AudioFeatures& AudioAnalyzer::getFeatures() const {
+	return features.read();
+}
+
+uint64_t AudioAnalyzer::getDroppedHops() const {
+	return droppedHops.load(std::memory_order_relaxed);
+}
+
+OnsetDetector::TrackerState AudioAnalyzer::getTrackerState() const {
+	std::lock_guard<std::mutex> lock(trackerMutex);
+	return publishedTracker;
+}
+
+void AudioAnalyzer::restoreTracker(const OnsetDetector::TrackerState& state) {
+	std::lock_guard<std::mutex> lock(pendingMutex);
+	pendingTracker = state;
+	trackerPending.store(true, std::memory_order_release);
+}
+
+void AudioAnalyzer::threadedFunction() {
+	while (running) {
+		if (processPending() == 0) {
+			// A quarter hop, re-read in case the profile changed
+			std::this_thread::sleep_for(std::chrono::microseconds(
+				std::max(250, (int)(250000.0 * settings.hopSize / settings.sampleRate))));
+		}
+	}
+}
+
+int AudioAnalyzer::processPending() {
+	if (!ring) return 0;
+	if (configPending.exchange(false, std::memory_order_acq_rel)) {
+		Settings s;
+		{
+			std::lock_guard<std::mutex> lock(pendingMutex);
+			s = pendingSettings;
+		}
+		applySettings(s);
+		nextEnd = ring->writePosition();   // old hops were cut for the old size
+	}
+	if (trackerPending.exchange(false, std::memory_order_acq_rel)) {
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		onsets.setTrackerState(pendingTracker);
+	}
+
+	const uint64_t frameSize = settings.frameSize;
+	const uint64_t hop = settings.hopSize;
+	if (nextEnd < frameSize) nextEnd = frameSize;
+
+	int hops = 0;
+	uint64_t available = ring->writePosition();
+	while (available >= nextEnd) {
+		// Fell so far behind that the window was overwritten: skip ahead
+		if (!ring->isIntact(nextEnd, frameSize)) {
+			uint64_t skipped = (available - nextEnd) / hop;
+			droppedHops += skipped;
+			nextEnd += skipped * hop;
+		}
+
+		analyzeWindow(nextEnd);
+		nextEnd += hop;
+		hops++;
+	}
+	return hops;
+}
+
+void AudioAnalyzer::analyzeWindow(uint64_t end) {
+	const int frameSize = settings.frameSize;
+	const float hopSeconds = (float)settings.hopSize / settings.sampleRate;
+
+	// Essentia's standard API takes a std::vector, so copy the window once
+	const float* window = ring->window(end, frameSize);
+	std::copy(window, window + frameSize, frame.begin());
+	if (!ring->isIntact(end, frameSize)) {
+		droppedHops++;
+		return;
+	}
+
+	// RMS of the newest hop
+	float sumSquares = 0.0f;
+	for (int i = frameSize - settings.hopSize; i < frameSize; i++) {
+		sumSquares += frame[i] * frame[i];
+	}
+	float rms = std::sqrt(sumSquares / settings.hopSize);
+
+	{
+		ScopedTimer timer(ProfileStage::ANALYSIS);
+		// Essentia pipeline: frame -> Windowing -> Spectrum -> PitchYinFFT
+		windowing->input("frame").set(frame);
+		windowing->output("frame").set(windowedFrame);
+		windowing->compute();
+
+		spectrum->input("frame").set(windowedFrame);
+		spectrum->output("spectrum").set(spectrumValues);
+		spectrum->compute();
+
+		pitchYinFFT->input("spectrum").set(spectrumValues);
+		pitchYinFFT->output("pitch").set(currentPitch);
+		pitchYinFFT->output("pitchConfidence").set(currentPitchConfidence);
+		pitchYinFFT->compute();
+	}
+
+	// Smooth pitch and confidence
+	if (currentPitchConfidence > 0.15f && currentPitch > 50.0f) {
+		float alpha = emaAlpha(hopSeconds, kPitchTau);
+		smoothedPitch = smoothedPitch * (1.0f - alpha) + currentPitch * alpha;
+		smoothedConfidence = smoothedConfidence * (1.0f - alpha) + currentPitchConfidence * alpha;
+	} else {
+		smoothedConfidence *= std::exp(-hopSeconds / kConfidenceDecayTau);
+	}
+
+	// Fused spectral pass: fullness, band energies, centroid, flux, display dB
+	SpectralSummary summary;
+	AudioFeatures& out = features.writeBuffer();
+	out.spectrumDb.resize(spectrumValues.size());
+	spectralKernel.process(spectrumValues.data(), out.spectrumDb.data(), summary);
+
+	int totalBins = (int)spectrumValues.size();
+	float bassEnergy = summary.bandRms[BAND_BASS];
+	float rawFullness = (totalBins > 0) ? (float)summary.activeBins / totalBins : 0.0f;
+	// Boost with power curve so typical music lands around 0.4-0.7
+	float fullness = std::pow(rawFullness, 0.4f);
+
+	// Onsets and tempo from multi-band flux, every hop
+	double time = (double)end / settings.sampleRate;
+	if (onsets.process(summary.bandFlux, rms, time)) {
+		lastBeatTime = onsets.getOnsetTime();
+		recentBeats[beatCount % AudioFeatures::kRecentBeats] = lastBeatTime;
+		beatCount++;
+	}
+	{
+		std::lock_guard<std::mutex> lock(trackerMutex);
+		publishedTracker = onsets.getTrackerState();
+	}
+
+	// Publish
+	out.sequence = ++sequence;
+	out.sampleTime = end;
+	out.time = time;
+	out.pitch = smoothedPitch;
+	out.confidence = smoothedConfidence;
+	out.rms = rms;
+	out.bass = bassEnergy;
+	out.fullness = fullness;
+	out.centroid = summary.centroidHz;
+	out.flux = summary.flux;
+	out.bands = summary.bandRms;
+	out.bandFlux = summary.bandFlux;
+	out.beatCount = beatCount;
+	out.lastBeatTime = lastBeatTime;
+	out.recentBeats = recentBeats;
+	out.onsetStrength = onsets.getOdf();
+	out.tempo = onsets.getTempo();
+	out.tempoConfidence = onsets.getTempoConfidence();
+	out.nextBeatTime = onsets.getNextBeatTime(time);
+	out.spectrum.assign(spectrumValues.begin(), spectrumValues.end());
+
+	// Older samples in the delivering push were captured earlier
+	AudioRingBuffer::Stamp stamp;
+	if (ring->stampAt(end, stamp)) {
+		out.arrivalNs = stamp.arrivalNs;
+		out.captureNs = stamp.captureNs - (int64_t)((stamp.endPos - end) * 1000000000ull / settings.sampleRate);
+		out.publishNs = audioClockNs();
+	} else {
+		out.arrivalNs = out.captureNs = out.publishNs = 0;
+	}
+	features.publish();
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "ofMain.h"
+#include "AudioFeatures.h"
+#include "AudioRingBuffer.h"
+#include "SpectralKernel.h"
+#include "OnsetDetector.h"
+#include "TripleBuffer.h"
+#include <essentia/essentia.h>
+#include <essentia/algorithmfactory.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// --- Analysis resolution presets ---
+
+enum class AnalysisProfile {
+	LOW_LATENCY,    // 1024 frame, 256 hop, 128-sample capture quantum
+	STANDARD,       // 2048 frame, 512 hop
+	PRECISION       // 4096 frame for bass pitch resolution, 512 hop
+};
+const int kNumAnalysisProfiles = 3;
+
+// --- Hop-based Essentia analysis on a dedicated thread ---
+// Consumes the audio ring every hopSize samples (independent of the render
+// rate), runs Windowing -> Spectrum -> PitchYinFFT on the newest frameSize
+// window, derives spectral features, onsets and tempo, and publishes an
+// AudioFeatures frame through a triple buffer.
+
+class AudioAnalyzer {
+public:
+	struct Settings {
+		int frameSize = 2048;
+		int hopSize = 512;
+		int sampleRate = 44100;
+		int bufferSize = 512;   // capture quantum suggested for this resolution
+
+		// Sizes are for 44.1/48 kHz and double per octave of sample rate
+		static Settings forProfile(AnalysisProfile profile, int sampleRate = 44100);
+	};
+
+	static const char* profileName(AnalysisProfile profile);
+	static bool profileFromName(const std::string& name, AnalysisProfile& out);
+
+	~AudioAnalyzer();
+
+	void setup(AudioRingBuffer& ring, const Settings& settings);
+
+	// Any thread: switch resolution without restarting. The worker applies
+	// it before its next hop and resumes from the newest audio; tempo
+	// tracking restarts since its history is in hops.
+	void configure(const Settings& settings);
+	Settings getSettings() const;          // latest requested settings
+	void start();
+	void stop();     // joins the worker and frees the Essentia algorithms
+
+	// Analyze every complete hop in the ring on the calling thread; for
+	// offline/benchmark use instead of start(). Returns hops analyzed.
+	int processPending();
+
+	// Render thread: pick up the newest frame without locking
+	bool update();                          // true if a new frame arrived
+	const AudioFeatures& getFeatures() const;
+
+	uint64_t getDroppedHops() const;
+
+	// Any thread: the onset tracker's adaptive state as of the latest hop,
+	// and seeding it from a snapshot (applied before the next hop, after
+	// any pending configure) so beats resume without a cold start
+	OnsetDetector::TrackerState getTrackerState() const;
+	void restoreTracker(const OnsetDetector::TrackerState& state);
+
+private:
+	void threadedFunction();
+	void analyzeWindow(uint64_t end);
+	void applySettings(const Settings& settings);
+	void freeAlgorithms();
+
+	Settings settings;              // worker-owned, in effect
+	Settings pendingSettings;       // guarded by pendingMutex
+	mutable std::mutex pendingMutex;
+	std::atomic<bool> configPending{false};
+	OnsetDetector::TrackerState pendingTracker;   // guarded by pendingMutex
+	std::atomic<bool> trackerPending{false};
+	OnsetDetector::TrackerState publishedTracker; // guarded by trackerMutex
+	mutable std::mutex trackerMutex;
+	AudioRingBuffer* ring = nullptr;
+	std::thread worker;
+	std::atomic<bool> running{false};
+	std::atomic<uint64_t> droppedHops{0};
+	uint64_t nextEnd = 0;          // ring position of the next window's end
+
+	essentia::standard::Algorithm* windowing = nullptr;
+	essentia::standard::Algorithm* spectrum = nullptr;
+	essentia::standard::Algorithm* pitchYinFFT = nullptr;
+
+	// Worker-owned Essentia I/O buffers
+	std::vector<essentia::Real> frame;
+	std::vector<essentia::Real> windowedFrame;
+	std::vector<essentia::Real> spectrumValues;
+	essentia::Real currentPitch = 0.0f;
+	essentia::Real currentPitchConfidence = 0.0f;
+	SpectralKernel spectralKernel;
+	OnsetDetector onsets;
+
+	// Worker-owned smoothing and onset state
+	float smoothedPitch = 0.0f;
+	float smoothedConfidence = 0.0f;
+	uint64_t beatCount = 0;
+	double lastBeatTime = 0.0;
+	std::array<double, AudioFeatures::kRecentBeats> recentBeats{};
+	uint64_t sequence = 0;
+
+	TripleBuffer<AudioFeatures> features;
+};
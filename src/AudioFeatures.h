@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Spectral bands summarised per hop (edges in SpectralKernel.cpp)
+enum SpectralBand {
+	BAND_BASS,        // 20-200 Hz
+	BAND_LOW_MID,     // 200-800 Hz
+	BAND_HIGH_MID,    // 800-3200 Hz
+	BAND_HIGH,        // 3200 Hz - Nyquist
+	kNumSpectralBands
+};
+
+// --- One analysis hop, published by AudioAnalyzer ---
+
+struct AudioFeatures {
+	uint64_t sequence = 0;          // hop counter (0 = nothing analyzed yet)
+	uint64_t sampleTime = 0;        // ring position just past the analyzed window
+	double time = 0.0;              // sampleTime in seconds (audio clock)
+
+	float pitch = 0.0f;             // smoothed pitch (Hz)
+	float confidence = 0.0f;        // smoothed pitch confidence
+	float rms = 0.0f;               // RMS of the newest hop
+	float bass = 0.0f;              // RMS of ~20-200 Hz bins
+	float fullness = 0.0f;          // shaped fraction of bins above -65 dB
+	float centroid = 0.0f;          // spectral centroid (Hz)
+	float flux = 0.0f;              // half-wave rectified spectral flux
+	std::array<float, kNumSpectralBands> bands{};    // RMS magnitude per band
+	std::array<float, kNumSpectralBands> bandFlux{}; // flux per band
+
+	// Onsets (multi-band spectral flux) and the tempo tracker
+	static const int kRecentBeats = 8;
+	uint64_t beatCount = 0;         // onsets detected so far
+	double lastBeatTime = 0.0;      // audio-clock seconds of the newest onset
+	std::array<double, kRecentBeats> recentBeats{}; // onset n at [n % kRecentBeats]
+	float onsetStrength = 0.0f;     // onset detection function (~1 = average)
+	float tempo = 0.0f;             // BPM, 0 until a tempo is found
+	float tempoConfidence = 0.0f;   // 0-1
+	double nextBeatTime = 0.0;      // predicted audio-clock time of the next beat
+
+	// Latency stamps for the window's newest sample (audioClockNs(), 0 = unstamped)
+	int64_t captureNs = 0;          // estimated capture at the sound card
+	int64_t arrivalNs = 0;          // delivered to the app
+	int64_t publishNs = 0;          // analysis finished
+
+	std::vector<float> spectrum;    // magnitude spectrum (frameSize/2 + 1 bins)
+	std::vector<float> spectrumDb;  // same bins in dB (approximate, for display)
+};
@@ -0,0 +1,135 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Steady clock shared by capture stamps, analysis and presentation (ns)
+inline int64_t audioClockNs() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// --- Lock-free single-producer/single-consumer sample ring ---
+// The audio callback pushes without blocking or allocating; when the reader
+// falls behind, the oldest samples are overwritten. Storage is mirrored (every
+// sample is also written `capacity` slots later), so any window of up to
+// `capacity` samples is one contiguous span the reader can use in place.
+// A window stays valid while the producer writes fewer than
+// (capacity - count) further samples; isIntact() checks that after use.
+// Each push can carry clock stamps for its newest sample, kept for the last
+// kStamps pushes, so the reader can tell when a position was captured.
+
+class AudioRingBuffer {
+public:
+	// Not thread-safe; call before the audio stream starts. Capacity is
+	// rounded up to a power of two.
+	void allocate(size_t minCapacity) {
+		size_t cap = 1;
+		while (cap < minCapacity) cap <<= 1;
+		data.assign(cap * 2, 0.0f);
+		mask = cap - 1;
+		writePos.store(0, std::memory_order_relaxed);
+		for (auto& s : stamps) s.endPos.store(0, std::memory_order_relaxed);
+	}
+
+	size_t capacity() const { return mask + 1; }
+
+	struct Stamp {
+		uint64_t endPos = 0;      // ring position just past the stamped push
+		int64_t arrivalNs = 0;    // audioClockNs() when the push reached the app
+		int64_t captureNs = 0;    // estimated capture of the push's newest sample
+	};
+
+	// --- Producer (audio thread) ---
+
+	// Stamps of 0 leave the push unstamped (offline replay)
+	void push(const float* samples, size_t count, int64_t arrivalNs = 0, int64_t captureNs = 0) {
+		size_t cap = capacity();
+		if (count > cap) {
+			samples += count - cap;
+			count = cap;
+		}
+		uint64_t pos = writePos.load(std::memory_order_relaxed);
+		size_t start = (size_t)(pos & mask);
+		size_t first = std::min(count, cap - start);
+
+		std::memcpy(&data[start], samples, first * sizeof(float));
+		std::memcpy(&data[start + cap], samples, first * sizeof(float));
+		if (count > first) {
+			std::memcpy(&data[0], samples + first, (count - first) * sizeof(float));
+			std::memcpy(&data[cap], samples + first, (count - first) * sizeof(float));
+		}
+		if (arrivalNs != 0) {
+			// Seqlock: endPos = 0 marks the slot as being rewritten. The fence
+			// keeps the field stores below from becoming visible before it.
+			AtomicStamp& s = stamps[stampHead++ % kStamps];
+			s.endPos.store(0, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			s.arrivalNs.store(arrivalNs, std::memory_order_relaxed);
+			s.captureNs.store(captureNs, std::memory_order_relaxed);
+			s.endPos.store(pos + count, std::memory_order_release);
+		}
+		writePos.store(pos + count, std::memory_order_release);
+	}
+
+	// --- Consumer ---
+
+	// Total samples ever pushed; everything before it is readable
+	uint64_t writePosition() const {
+		return writePos.load(std::memory_order_acquire);
+	}
+
+	// Contiguous view of samples [end - count, end); count <= capacity()
+	const float* window(uint64_t end, size_t count) const {
+		return &data[(size_t)((end - count) & mask)];
+	}
+
+	// True if the producer has not yet overwritten the window ending at `end`
+	bool isIntact(uint64_t end, size_t count) const {
+		return writePosition() - end <= capacity() - count;
+	}
+
+	// Stamp of the push that delivered the sample just before `pos`; false if
+	// no stamped push among the last kStamps covers it. Live capture stamps
+	// every push, offline replay none, so the nearest later stamp is its own.
+	bool stampAt(uint64_t pos, Stamp& out) const {
+		bool found = false;
+		for (const AtomicStamp& s : stamps) {
+			uint64_t endPos = s.endPos.load(std::memory_order_acquire);
+			if (endPos == 0 || endPos < pos || (found && endPos >= out.endPos)) continue;
+			Stamp copy;
+			copy.arrivalNs = s.arrivalNs.load(std::memory_order_relaxed);
+			copy.captureNs = s.captureNs.load(std::memory_order_relaxed);
+			copy.endPos = endPos;
+			// Keeps the field loads above from moving past the re-check
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (s.endPos.load(std::memory_order_relaxed) != endPos) continue;   // torn
+			out = copy;
+			found = true;
+		}
+		return found;
+	}
+
+private:
+	static const int kStamps = 64;
+
+	struct AtomicStamp {
+		std::atomic<uint64_t> endPos{0};
+		std::atomic<int64_t> arrivalNs{0};
+		std::atomic<int64_t> captureNs{0};
+	};
+
+	std::vector<float> data;
+	size_t mask = 0;
+	std::array<AtomicStamp, kStamps> stamps;
+	uint32_t stampHead = 0;   // producer-owned
+
+	// Keep the producer's index on its own cache line so the reader's loads
+	// don't false-share with the callback's stores
+	alignas(64) std::atomic<uint64_t> writePos{0};
+	char padding[64 - sizeof(std::atomic<uint64_t>)];
+};
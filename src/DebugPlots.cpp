@@ -0,0 +1,168 @@
+#include "DebugPlots.h"
+
+namespace {
+// Below this pitch or confidence a sample is treated as unvoiced
+const float kMinPitchHz = 50.0f;
+const float kMinConfidence = 0.05f;
+
+// Attribute location after oF's defaults (position, color, normal, texcoord)
+const int kLevelLocation = 4;
+
+// Bars keep the old HSB ramp: hue 170 -> 50, brightness 50 -> 255 (oF 0-255 units)
+const char* kBarVertexShader = R"(
+#version 330
+uniform mat4 modelViewProjectionMatrix;
+uniform vec4 rect;       // x, y, w, h
+uniform float barCount;
+in vec4 position;
+in float barLevel;
+out vec4 vColor;
+
+vec3 hsb2rgb(vec3 c) {
+	vec3 rgb = clamp(abs(mod(c.x * 6.0 + vec3(0.0, 4.0, 2.0), 6.0) - 3.0) - 1.0, 0.0, 1.0);
+	return c.z * mix(vec3(1.0), rgb, c.y);
+}
+
+void main() {
+	float barW = rect.z / barCount;
+	float barH = barLevel * rect.w;
+	vec2 p = vec2(rect.x + (gl_InstanceID + position.x) * barW - position.x,
+	              rect.y + rect.w - position.y * barH);
+	gl_Position = modelViewProjectionMatrix * vec4(p, 0.0, 1.0);
+	vColor = vec4(hsb2rgb(vec3((170.0 - barLevel * 120.0) / 255.0, 220.0 / 255.0,
+	                           (50.0 + barLevel * 205.0) / 255.0)), 1.0);
+}
+)";
+
+const char* kBarFragmentShader = R"(
+#version 330
+in vec4 vColor;
+out vec4 outputColor;
+void main() {
+	outputColor = vColor;
+}
+)";
+}
+
+// ============================================================
+// Melody trail
+// ============================================================
+
+void MelodyTrail::push(float pitchHz, float confidence) {
+	samples[head] = {pitchHz, confidence};
+	head = (head + 1) % kCapacity;
+	count = std::min(count + 1, kCapacity);
+}
+
+void MelodyTrail::draw(float x, float y, float w, float h, float minHz, float maxHz) {
+	if (count < 2) return;
+
+	// Segments between consecutive voiced points only, so the trail breaks
+	// at unvoiced gaps instead of bridging them with a diagonal
+	strip.setMode(OF_PRIMITIVE_LINES);
+	auto& verts = strip.getVertices();
+	auto& colors = strip.getColors();
+	verts.clear();      // capacity is kept, so steady frames don't allocate
+	colors.clear();
+
+	const float minLog = std::log2(minHz);
+	const float logRange = std::log2(maxHz) - minLog;
+	const float stepX = w / kCapacity;
+	const int start = (head + kCapacity - count) % kCapacity;
+
+	bool prevVoiced = false;
+	glm::vec3 prevPos;
+	ofFloatColor prevColor;
+	for (int i = 0; i < count; i++) {
+		const Sample& s = samples[(start + i) % kCapacity];
+		bool voiced = s.pitch > kMinPitchHz && s.confidence > kMinConfidence;
+		if (!voiced) {
+			prevVoiced = false;
+			continue;
+		}
+		glm::vec3 pos(x + i * stepX, y + h - (std::log2(s.pitch) - minLog) / logRange * h, 0.0f);
+		ofFloatColor color(0.0f, 1.0f, 180.0f / 255.0f, ofClamp(s.confidence * 1.5f, kMinConfidence, 1.0f));
+		if (prevVoiced) {
+			verts.push_back(prevPos);
+			verts.push_back(pos);
+			colors.push_back(prevColor);
+			colors.push_back(color);
+		}
+		prevVoiced = true;
+		prevPos = pos;
+		prevColor = color;
+	}
+	if (verts.empty()) return;
+
+	ofPushStyle();
+	ofSetLineWidth(2);
+	strip.draw();
+	ofPopStyle();
+}
+
+// ============================================================
+// Spectrum bars
+// ============================================================
+
+bool SpectrumBars::setup() {
+	ofMesh unit;
+	unit.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+	unit.addVertex(glm::vec3(0.0f, 0.0f, 0.0f));
+	unit.addVertex(glm::vec3(1.0f, 0.0f, 0.0f));
+	unit.addVertex(glm::vec3(0.0f, 1.0f, 0.0f));
+	unit.addVertex(glm::vec3(1.0f, 1.0f, 0.0f));
+	quad.setup(ofVboMesh(unit));
+	levelBuffer.allocate(kMaxBars * sizeof(float), GL_STREAM_DRAW);
+
+	shader.setupShaderFromSource(GL_VERTEX_SHADER, kBarVertexShader);
+	shader.setupShaderFromSource(GL_FRAGMENT_SHADER, kBarFragmentShader);
+	shader.bindDefaults();
+	shader.bindAttribute(kLevelLocation, "barLevel");
+	ready = shader.linkProgram();
+	if (!ready) {
+		ofLogWarning("SpectrumBars") << "Bar shader failed to link, using a CPU mesh";
+	}
+	return ready;
+}
+
+void SpectrumBars::draw(const std::vector<float>& spectrumDb, float x, float y, float w, float h,
+                        float floorDb) {
+	int numBars = std::min((int)spectrumDb.size(), kMaxBars);
+	if (numBars == 0) return;
+	if (!initialized) {
+		initialized = true;
+		setup();
+	}
+
+	for (int i = 0; i < numBars; i++) {
+		levels[i] = ofClamp((spectrumDb[i] - floorDb) / -floorDb, 0.0f, 1.0f);
+	}
+
+	if (ready) {
+		levelBuffer.updateData(0, numBars * sizeof(float), levels.data());
+		quad.vbo.setAttributeBuffer(kLevelLocation, levelBuffer, 1, sizeof(float), 0);
+		quad.vbo.setAttributeDivisor(kLevelLocation, 1);
+		shader.begin();
+		shader.setUniform4f("rect", x, y, w, h);
+		shader.setUniform1f("barCount", (float)numBars);
+		quad.draw(numBars);
+		shader.end();
+		return;
+	}
+
+	float barW = w / numBars;
+	fallback.clear();
+	fallback.setMode(OF_PRIMITIVE_TRIANGLES);
+	for (int i = 0; i < numBars; i++) {
+		float n = levels[i];
+		ofColor c;
+		c.setHsb((int)(170 - n * 120) % 255, 220, 50 + n * 205);
+		float x0 = x + i * barW;
+		float x1 = x0 + barW - 1.0f;
+		float y0 = y + h - n * h;
+		float y1 = y + h;
+		fallback.addVertices({{x0, y0, 0}, {x1, y0, 0}, {x1, y1, 0}, {x0, y0, 0}, {x1, y1, 0}, {x0, y1, 0}});
+		for (int v = 0; v < 6; v++) fallback.addColor(c);
+	}
+	fallback.draw();
+}
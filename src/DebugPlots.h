@@ -0,0 +1,54 @@
+#pragma once
+#include "ofMain.h"
+#include "PetalBatchRenderer.h"
+#include <array>
+
+// --- Melody trail ---
+// Fixed ring of (pitch, confidence) samples drawn in one call as a line list
+// with per-vertex alpha; only consecutive voiced samples are joined, so the
+// trail breaks at unvoiced gaps.
+
+class MelodyTrail {
+public:
+	static const int kCapacity = 400;
+
+	void push(float pitchHz, float confidence);
+
+	// Log-frequency plot in [minHz, maxHz] over the rectangle, oldest on the left
+	void draw(float x, float y, float w, float h, float minHz, float maxHz);
+
+private:
+	struct Sample {
+		float pitch;
+		float confidence;
+	};
+
+	std::array<Sample, kCapacity> samples{};
+	int head = 0;     // next write
+	int count = 0;
+	ofVboMesh strip;  // voiced segments as a line list, rewritten in place each frame
+};
+
+// --- Spectrum bars ---
+// One unit quad drawn instanced per bar; the shader places each bar from
+// its instance index and colors it from the uploaded level.
+
+class SpectrumBars {
+public:
+	static const int kMaxBars = 512;
+
+	// dB values, mapped from [floorDb, 0] to bar height
+	void draw(const std::vector<float>& spectrumDb, float x, float y, float w, float h,
+	          float floorDb = -80.0f);
+
+private:
+	bool setup();
+
+	InstancedMeshVbo quad;
+	ofShader shader;
+	ofBufferObject levelBuffer;
+	std::array<float, kMaxBars> levels{};
+	bool initialized = false;
+	bool ready = false;
+	ofMesh fallback;   // CPU-built bars in one draw if the shader is unavailable
+};
@@ -0,0 +1,138 @@
+#include "FallingPetalRenderer.h"
+
+namespace {
+// Attribute locations after oF's defaults (position, color, normal, texcoord)
+const int kLaunchLocation = 4;
+const int kSpinLocation = 5;
+const int kTimingLocation = 6;
+const int kColorLocation = 7;
+
+const char* kFallingVertexShader = R"(
+#version 330
+uniform mat4 modelViewProjectionMatrix;
+uniform float time;
+uniform float gravity;
+uniform float fadeDelay;
+uniform float fadeSpeed;
+in vec4 position;
+in vec4 petalLaunch;
+in vec4 petalSpin;
+in vec4 petalTiming;
+in vec4 petalColor;
+out vec4 vColor;
+void main() {
+	float age = max(time - petalTiming.z, 0.0);
+	vec2 base = petalLaunch.xy + petalLaunch.zw * age
+	          + vec2(0.0, 0.5 * gravity * age * age);
+	base.x += sin(age * petalTiming.x * 6.28318530718 + petalSpin.z) * petalSpin.w;
+
+	float rot = radians(petalSpin.x + petalSpin.y * age);
+	float c = cos(rot);
+	float s = sin(rot);
+	vec2 p = position.xy * petalTiming.y;
+	p = vec2(c * p.x - s * p.y, s * p.x + c * p.y) + base;
+	gl_Position = modelViewProjectionMatrix * vec4(p, 0.0, 1.0);
+
+	float fade = clamp(1.0 - max(age - fadeDelay, 0.0) * fadeSpeed, 0.0, 1.0);
+	vColor = vec4(petalColor.rgb, petalColor.a * fade);
+}
+)";
+
+const char* kFallingFragmentShader = R"(
+#version 330
+in vec4 vColor;
+out vec4 outputColor;
+void main() {
+	outputColor = vColor;
+}
+)";
+}
+
+bool FallingPetalRenderer::setup() {
+	shader.setupShaderFromSource(GL_VERTEX_SHADER, kFallingVertexShader);
+	shader.setupShaderFromSource(GL_FRAGMENT_SHADER, kFallingFragmentShader);
+	shader.bindDefaults();
+	shader.bindAttribute(kLaunchLocation, "petalLaunch");
+	shader.bindAttribute(kSpinLocation, "petalSpin");
+	shader.bindAttribute(kTimingLocation, "petalTiming");
+	shader.bindAttribute(kColorLocation, "petalColor");
+	ready = shader.linkProgram();
+	if (!ready) {
+		ofLogWarning("FallingPetalRenderer") << "Falling petal shader failed to link";
+	}
+	return ready;
+}
+
+bool FallingPetalRenderer::isReady() const {
+	return ready;
+}
+
+void FallingPetalRenderer::begin() {
+	for (auto& entry : batches) {
+		entry.second.petals.clear();
+		entry.second.dirty = true;
+	}
+}
+
+FallingPetalRenderer::Batch& FallingPetalRenderer::batchFor(const ofVboMesh& mesh) {
+	auto it = batches.find(&mesh);
+	if (it != batches.end()) return it->second;
+
+	Batch& batch = batches[&mesh];
+	batch.mesh.setup(mesh);
+	return batch;
+}
+
+void FallingPetalRenderer::add(const ofVboMesh& mesh, const FallingPetalLaunch& petal) {
+	Batch& batch = batchFor(mesh);
+	batch.petals.push_back(petal);
+	batch.dirty = true;
+}
+
+void FallingPetalRenderer::upload(Batch& batch) {
+	size_t count = batch.petals.size();
+	if (count > batch.capacity) {
+		batch.capacity = std::max(count, batch.capacity * 2);
+		batch.instanceBuffer.allocate(batch.capacity * sizeof(FallingPetalLaunch), GL_DYNAMIC_DRAW);
+	}
+	batch.instanceBuffer.updateData(0, count * sizeof(FallingPetalLaunch), batch.petals.data());
+
+	int stride = sizeof(FallingPetalLaunch);
+	ofVbo& vbo = batch.mesh.vbo;
+	vbo.setAttributeBuffer(kLaunchLocation, batch.instanceBuffer, 4, stride,
+		offsetof(FallingPetalLaunch, launch));
+	vbo.setAttributeBuffer(kSpinLocation, batch.instanceBuffer, 4, stride,
+		offsetof(FallingPetalLaunch, spin));
+	vbo.setAttributeBuffer(kTimingLocation, batch.instanceBuffer, 4, stride,
+		offsetof(FallingPetalLaunch, timing));
+	vbo.setAttributeBuffer(kColorLocation, batch.instanceBuffer, 4, stride,
+		offsetof(FallingPetalLaunch, color));
+	vbo.setAttributeDivisor(kLaunchLocation, 1);
+	vbo.setAttributeDivisor(kSpinLocation, 1);
+	vbo.setAttributeDivisor(kTimingLocation, 1);
+	vbo.setAttributeDivisor(kColorLocation, 1);
+	batch.dirty = false;
+}
+
+void FallingPetalRenderer::draw(const Motion& motion) {
+	drawCalls = 0;
+	if (!ready) return;
+
+	shader.begin();
+	shader.setUniform1f("time", motion.time);
+	shader.setUniform1f("gravity", motion.gravity);
+	shader.setUniform1f("fadeDelay", motion.fadeDelay);
+	shader.setUniform1f("fadeSpeed", motion.fadeSpeed);
+	for (auto& entry : batches) {
+		Batch& batch = entry.second;
+		if (batch.petals.empty()) continue;
+		if (batch.dirty) upload(batch);
+		batch.mesh.draw((int)batch.petals.size());
+		drawCalls++;
+	}
+	shader.end();
+}
+
+int FallingPetalRenderer::getDrawCalls() const {
+	return drawCalls;
+}
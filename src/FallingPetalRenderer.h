@@ -0,0 +1,55 @@
+#pragma once
+#include "ofMain.h"
+#include "PetalBatchRenderer.h"
+#include <unordered_map>
+
+// --- Launch state of one falling petal, packed for the falling-petal shader ---
+
+struct FallingPetalLaunch {
+	glm::vec4 launch;   // xy = spawn position, zw = initial velocity (px/s)
+	glm::vec4 spin;     // x = rotation deg, y = tumble deg/s, z = waver phase, w = waver amp
+	glm::vec4 timing;   // x = waver freq, y = length px, z = spawn time, w = unused
+	glm::vec4 color;    // normalized RGBA at spawn
+};
+
+// --- GPU-evaluated falling petals ---
+// Petal motion is closed-form in age (constant gravity, sinusoidal waver,
+// linear tumble and fade), so the vertex shader evaluates it from the launch
+// state and a time uniform. Instance buffers only change when petals spawn or
+// retire, never per frame.
+
+class FallingPetalRenderer {
+public:
+	struct Motion {
+		float time = 0.0f;
+		float gravity = 0.0f;
+		float fadeDelay = 0.0f;
+		float fadeSpeed = 0.0f;
+	};
+
+	bool setup();
+	bool isReady() const;
+
+	void begin();                                         // drop all instances
+	void add(const ofVboMesh& mesh, const FallingPetalLaunch& petal);
+	void draw(const Motion& motion);                      // blends, no depth
+
+	int getDrawCalls() const;
+
+private:
+	struct Batch {
+		InstancedMeshVbo mesh;
+		std::vector<FallingPetalLaunch> petals;
+		ofBufferObject instanceBuffer;
+		size_t capacity = 0;
+		bool dirty = false;
+	};
+
+	Batch& batchFor(const ofVboMesh& mesh);
+	void upload(Batch& batch);
+
+	std::unordered_map<const ofVboMesh*, Batch> batches;
+	ofShader shader;
+	bool ready = false;
+	int drawCalls = 0;
+};
@@ -0,0 +1,233 @@
+#include "FieldSnapshot.h"
+#include "ofMain.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+const size_t kSectionAlign = 16;
+
+size_t alignUp(size_t v) {
+	return (v + kSectionAlign - 1) & ~(kSectionAlign - 1);
+}
+
+const uint64_t kFnvBasis = 0xCBF29CE484222325ull;
+
+uint64_t fnv1a(const uint8_t* p, size_t n, uint64_t h = kFnvBasis) {
+	for (size_t i = 0; i < n; i++) {
+		h ^= p[i];
+		h *= 0x100000001B3ull;
+	}
+	return h;
+}
+
+// FNV-1a of the whole file, header included, with the checksum field read as zeros
+uint64_t checksumOf(const uint8_t* file, size_t bytes) {
+	const SnapshotHeader* h = reinterpret_cast<const SnapshotHeader*>(file);
+	size_t at = reinterpret_cast<const uint8_t*>(&h->checksum) - file;
+	const uint8_t zeros[sizeof(h->checksum)] = {};
+	uint64_t sum = fnv1a(file, at);
+	sum = fnv1a(zeros, sizeof(zeros), sum);
+	at += sizeof(zeros);
+	return fnv1a(file + at, bytes - at, sum);
+}
+}
+
+// ============================================================
+// SnapshotBuilder
+// ============================================================
+
+void SnapshotBuilder::begin(uint32_t flowerCount) {
+	head = SnapshotHeader();
+	head.flowerCount = flowerCount;
+	blob.assign(alignUp(sizeof(SnapshotHeader)), 0);
+}
+
+SnapshotHeader& SnapshotBuilder::header() {
+	return head;
+}
+
+void SnapshotBuilder::addRaw(SnapshotSection s, const void* data, size_t elementBytes, size_t n) {
+	int i = (int)s;
+	size_t offset = alignUp(blob.size());
+	size_t bytes = elementBytes * n;
+	blob.resize(offset + bytes, 0);
+	if (bytes > 0) std::memcpy(blob.data() + offset, data, bytes);
+	head.offset[i] = offset;
+	head.count[i] = n;
+	head.elementBytes[i] = (uint32_t)elementBytes;
+}
+
+std::vector<uint8_t>& SnapshotBuilder::finish() {
+	size_t payload = alignUp(sizeof(SnapshotHeader));
+	head.payloadBytes = blob.size() - payload;
+	head.checksum = 0;
+	std::memcpy(blob.data(), &head, sizeof(head));
+	head.checksum = checksumOf(blob.data(), blob.size());
+	std::memcpy(blob.data(), &head, sizeof(head));
+	return blob;
+}
+
+// ============================================================
+// FieldSnapshot
+// ============================================================
+
+FieldSnapshot::~FieldSnapshot() {
+	close();
+}
+
+bool FieldSnapshot::open(const std::string& path) {
+	close();
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader)) {
+		::close(fd);
+		ofLogWarning("FieldSnapshot") << path << ": too short";
+		return false;
+	}
+	void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (p == MAP_FAILED) {
+		ofLogWarning("FieldSnapshot") << path << ": could not map";
+		return false;
+	}
+	data = static_cast<const uint8_t*>(p);
+	bytes = st.st_size;
+
+	const SnapshotHeader& h = header();
+	const char* problem = nullptr;
+	size_t payload = alignUp(sizeof(SnapshotHeader));
+	if (std::memcmp(h.magic, SnapshotHeader().magic, sizeof(h.magic)) != 0) {
+		problem = "not a field snapshot";
+	} else if (h.endianTag != SnapshotHeader::kEndianTag) {
+		problem = "written on a machine of the other byte order";
+	} else if (h.version != SnapshotHeader::kVersion || h.headerBytes != sizeof(SnapshotHeader)) {
+		problem = "different snapshot version";
+	} else if (payload + h.payloadBytes != bytes) {
+		problem = "truncated";
+	} else if (checksumOf(data, bytes) != h.checksum) {
+		problem = "checksum mismatch";
+	} else {
+		// Written so that no product or sum can wrap
+		for (int i = 0; i < kNumSnapshotSections && !problem; i++) {
+			bool inRange = h.offset[i] >= payload && h.offset[i] <= bytes
+				&& (h.elementBytes[i] == 0 ? h.count[i] == 0
+				                           : h.count[i] <= (bytes - h.offset[i]) / h.elementBytes[i]);
+			if (!inRange) problem = "section out of range";
+		}
+	}
+	if (problem) {
+		ofLogWarning("FieldSnapshot") << path << ": " << problem;
+		close();
+		return false;
+	}
+	return true;
+}
+
+void FieldSnapshot::close() {
+	if (data) munmap(const_cast<uint8_t*>(data), bytes);
+	data = nullptr;
+	bytes = 0;
+}
+
+bool FieldSnapshot::isOpen() const {
+	return data != nullptr;
+}
+
+const SnapshotHeader& FieldSnapshot::header() const {
+	return *reinterpret_cast<const SnapshotHeader*>(data);
+}
+
+const void* FieldSnapshot::arrayRaw(SnapshotSection s, size_t elementBytes, size_t& n) const {
+	n = 0;
+	if (!data) return nullptr;
+	const SnapshotHeader& h = header();
+	int i = (int)s;
+	if (h.elementBytes[i] != elementBytes) return nullptr;
+	n = h.count[i];
+	return data + h.offset[i];
+}
+
+// ============================================================
+// SnapshotWriter
+// ============================================================
+
+SnapshotWriter::~SnapshotWriter() {
+	stop();
+}
+
+void SnapshotWriter::start(const std::string& p) {
+	stop();
+	path = p;
+	quit = false;
+	worker = std::thread(&SnapshotWriter::run, this);
+}
+
+void SnapshotWriter::stop() {
+	if (!worker.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	wake.notify_one();
+	worker.join();
+}
+
+void SnapshotWriter::submit(std::vector<uint8_t>&& blob) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.swap(blob);
+		hasPending = true;
+	}
+	wake.notify_one();
+}
+
+bool SnapshotWriter::isBusy() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return hasPending || writing;
+}
+
+void SnapshotWriter::run() {
+	std::vector<uint8_t> blob;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		wake.wait(lock, [this]{ return hasPending || quit; });
+		if (!hasPending) break;
+		blob.swap(pending);
+		hasPending = false;
+		writing = true;
+		lock.unlock();
+		writeFile(path, blob);
+		lock.lock();
+		writing = false;
+	}
+}
+
+bool SnapshotWriter::writeFile(const std::string& path, const std::vector<uint8_t>& blob) {
+	std::string tmp = path + ".tmp";
+	int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		ofLogWarning("SnapshotWriter") << "Could not create " << tmp;
+		return false;
+	}
+	const uint8_t* p = blob.data();
+	size_t left = blob.size();
+	while (left > 0) {
+		ssize_t n = ::write(fd, p, left);
+		if (n <= 0) break;
+		p += n;
+		left -= n;
+	}
+	bool ok = left == 0 && fsync(fd) == 0;
+	ok = ::close(fd) == 0 && ok;
+	if (ok) ok = std::rename(tmp.c_str(), path.c_str()) == 0;
+	if (!ok) {
+		ofLogWarning("SnapshotWriter") << "Could not write " << path;
+		std::remove(tmp.c_str());
+	}
+	return ok;
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include "OnsetDetector.h"
+#include "Rng.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// --- Binary flower field snapshot ---
+// Native-endian and versioned. The header is followed by one section per
+// array, in the same SoA shape as the field's slot arrays, so restoring is
+// one copy per array straight out of a read-only mapping. Each section
+// records its element size; a build whose structs differ rejects the file
+// instead of misreading it.
+
+enum class SnapshotSection {
+	LIFE_PHASE,
+	LIFE_SPEED,
+	ROTATION,
+	ROTATION_SPEED,
+	ROTATION_DIR,
+	FAST_DEATH,
+	FAST_DEATH_TIMER,
+	RIPPLE,
+	LAST_VISIBLE_PETALS,
+	FLOWER_RNG,
+	GENOMES,
+	TENDRILS,           // kMaxTendrilsPerFlower per flower
+	FALLING_PETALS,
+	BEAT_AGES,          // seconds before the snapshot, newest last
+	COUNT
+};
+const int kNumSnapshotSections = (int)SnapshotSection::COUNT;
+
+// Field-level scalars; times are relative so a new audio clock can resume them
+struct SnapshotFieldState {
+	float smoothedVolume = 0.0f;
+	float smoothedPitch = 0.0f;
+	float smoothedFullness = 0.0f;
+	float slowVolume = 0.0f;
+	float activityLevel = 0.0f;
+	float activityVariability = 0.0f;
+	double noiseClock = 0.0;
+	float fallingPetalClock = 0.0f;
+	int32_t baseCount = 0;
+	int32_t colorMode = 0;
+	int32_t iterateIndex = 0;
+	uint8_t reactiveMode = 0;
+	uint64_t rngSeed = 0;
+	uint64_t spawnCounter = 0;
+	RngStream fieldRng;
+};
+
+struct SnapshotHeader {
+	static const uint32_t kVersion = 3;
+	static const uint32_t kEndianTag = 0x01020304u;
+
+	char magic[8] = {'M', 'F', 'S', 'N', 'A', 'P', 0, 0};
+	uint32_t version = kVersion;
+	uint32_t endianTag = kEndianTag;
+	uint32_t headerBytes = sizeof(SnapshotHeader);
+	uint32_t flowerCount = 0;
+	uint64_t payloadBytes = 0;
+	uint64_t checksum = 0;                     // FNV-1a of the file, this field as zeros
+	uint64_t layoutHash = 0;                   // sizes and offsets of the saved structs, set by the field
+	uint64_t offset[kNumSnapshotSections] = {};   // from the start of the file
+	uint64_t count[kNumSnapshotSections] = {};
+	uint32_t elementBytes[kNumSnapshotSections] = {};
+	SnapshotFieldState field;
+	OnsetDetector::TrackerState tracker;
+	uint8_t hasTracker = 0;
+};
+
+// Collects sections into one blob ready to write
+class SnapshotBuilder {
+public:
+	void begin(uint32_t flowerCount);
+	template <class T>
+	void add(SnapshotSection s, const T* data, size_t n) {
+		addRaw(s, data, sizeof(T), n);
+	}
+	SnapshotHeader& header();
+	std::vector<uint8_t>& finish();     // fills offsets and checksum
+
+private:
+	void addRaw(SnapshotSection s, const void* data, size_t elementBytes, size_t n);
+
+	SnapshotHeader head;
+	std::vector<uint8_t> blob;
+};
+
+// Read-only mapping of a snapshot file
+class FieldSnapshot {
+public:
+	~FieldSnapshot();
+
+	bool open(const std::string& path);   // maps and validates; false leaves it closed
+	void close();
+	bool isOpen() const;
+
+	const SnapshotHeader& header() const;
+
+	// Section contents, or nullptr if missing or its element size differs
+	template <class T>
+	const T* array(SnapshotSection s, size_t& n) const {
+		return static_cast<const T*>(arrayRaw(s, sizeof(T), n));
+	}
+
+private:
+	const void* arrayRaw(SnapshotSection s, size_t elementBytes, size_t& n) const;
+
+	const uint8_t* data = nullptr;
+	size_t bytes = 0;
+};
+
+// --- Background snapshot writer ---
+// submit() hands over a finished blob; a worker writes it to path.tmp,
+// syncs and renames it over path, so a crash mid-write keeps the previous
+// snapshot. A blob submitted while one is being written replaces any
+// blob still waiting.
+
+class SnapshotWriter {
+public:
+	~SnapshotWriter();
+
+	void start(const std::string& path);
+	void stop();                        // writes anything pending first
+	void submit(std::vector<uint8_t>&& blob);
+	bool isBusy() const;                // a blob is waiting or being written
+
+	static bool writeFile(const std::string& path, const std::vector<uint8_t>& blob);
+
+private:
+	void run();
+
+	std::string path;
+	std::thread worker;
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	std::vector<uint8_t> pending;
+	bool hasPending = false;
+	bool writing = false;
+	bool quit = false;
+};
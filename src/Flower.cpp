@@ -1,4 +1,7 @@
 #include "Flower.h"
+#include "Profiler.h"
+#include <random>
+#include <type_traits>
 
 // ============================================================
 // Petal path utility
@@ -28,6 +31,238 @@ void buildPetalPath(ofPath& path, const PetalParams& p, ofColor color) {
 	path.close();
 }
 
+// ============================================================
+// Petal mesh cache
+// ============================================================
+
+namespace {
+// Buckets per unit of each shape parameter (under 2px outline error at the
+// largest petal sizes)
+const float kPetalQuantSteps = 32.0f;
+
+// Low-detail geometry for small heads
+const int kCoarseCurveResolution = 4;  // samples per bezier (oF default is 20)
+const int kDiscSegments = 12;
+
+// Center geometry at unit radius
+const int kCenterDiscSegments = 20;     // oF's default circle resolution
+const int kCenterDotSegments = 8;       // anthers and pollen dots
+const float kStamenHalfWidth = 0.06f;   // filament, ~1.5 px across at typical radii
+const float kPollenDotsPerDetail = 20.0f;
+
+void addDisc(ofMesh& mesh, glm::vec2 c, float r, int segments) {
+	for (int i = 0; i < segments; i++) {
+		float a0 = TWO_PI * i / segments;
+		float a1 = TWO_PI * (i + 1) / segments;
+		mesh.addVertex(glm::vec3(c, 0.0f));
+		mesh.addVertex(glm::vec3(c.x + r * std::cos(a0), c.y + r * std::sin(a0), 0.0f));
+		mesh.addVertex(glm::vec3(c.x + r * std::cos(a1), c.y + r * std::sin(a1), 0.0f));
+	}
+}
+
+// Thin quad from a to b, standing in for a line (no line width when instanced)
+void addSegment(ofMesh& mesh, glm::vec2 a, glm::vec2 b, float halfWidth) {
+	glm::vec2 d = b - a;
+	float len = glm::length(d);
+	if (len <= 0.0f) return;
+	glm::vec2 n = glm::vec2(-d.y, d.x) * (halfWidth / len);
+	glm::vec3 q[4] = {glm::vec3(a - n, 0.0f), glm::vec3(b - n, 0.0f),
+	                  glm::vec3(b + n, 0.0f), glm::vec3(a + n, 0.0f)};
+	mesh.addVertices({q[0], q[1], q[2], q[0], q[2], q[3]});
+}
+
+uint32_t quantisePetal(float v, float lo, float hi) {
+	return (uint32_t)std::round((ofClamp(v, lo, hi) - lo) * kPetalQuantSteps);
+}
+
+float dequantisePetal(uint32_t q, float lo) {
+	return lo + (float)q / kPetalQuantSteps;
+}
+
+// Smoothing is defined by time constants (seconds) so it behaves the same
+// at any tick rate; alpha = 1 - exp(-dt / tau)
+float emaAlpha(float dt, float tau) {
+	return 1.0f - std::exp(-dt / tau);
+}
+}
+
+PetalMeshCache& PetalMeshCache::shared() {
+	static PetalMeshCache cache;
+	return cache;
+}
+
+uint32_t PetalMeshCache::keyFor(const PetalParams& p) {
+	return quantisePetal(p.width, 0.0f, 1.0f)
+	     | quantisePetal(p.tipPointiness, 0.0f, 1.0f) << 8
+	     | quantisePetal(p.bulgePosition, 0.0f, 1.0f) << 16
+	     | quantisePetal(p.edgeCurvature, -1.0f, 1.0f) << 24;
+}
+
+PetalParams PetalMeshCache::paramsFor(uint32_t key) {
+	PetalParams p;
+	p.length = 1.0f;
+	p.width = dequantisePetal(key & 0xff, 0.0f);
+	p.tipPointiness = dequantisePetal((key >> 8) & 0xff, 0.0f);
+	p.bulgePosition = dequantisePetal((key >> 16) & 0xff, 0.0f);
+	p.edgeCurvature = dequantisePetal((key >> 24) & 0xff, -1.0f);
+	return p;
+}
+
+const ofVboMesh& PetalMeshCache::get(uint32_t key) {
+	auto it = meshes.find(key);
+	if (it != meshes.end()) return it->second;
+
+	ofPath path;
+	buildPetalPath(path, paramsFor(key), ofColor(255));
+	buildCount++;
+	Profiler::shared().addCount(ProfileCounter::MESH_BUILDS);
+	return meshes.emplace(key, ofVboMesh(path.getTessellation())).first->second;
+}
+
+const ofVboMesh& PetalMeshCache::get(const PetalParams& params) {
+	return get(keyFor(params));
+}
+
+const ofVboMesh& PetalMeshCache::getCoarse(uint32_t key) {
+	auto it = coarseMeshes.find(key);
+	if (it != coarseMeshes.end()) return it->second;
+
+	ofPath path;
+	path.setCurveResolution(kCoarseCurveResolution);
+	buildPetalPath(path, paramsFor(key), ofColor(255));
+	buildCount++;
+	Profiler::shared().addCount(ProfileCounter::MESH_BUILDS);
+	return coarseMeshes.emplace(key, ofVboMesh(path.getTessellation())).first->second;
+}
+
+const ofVboMesh& PetalMeshCache::getDisc() {
+	if (!discBuilt) {
+		ofMesh mesh;
+		mesh.setMode(OF_PRIMITIVE_TRIANGLE_FAN);
+		mesh.addVertex(glm::vec3(0.0f));
+		for (int i = 0; i <= kDiscSegments; i++) {
+			float a = TWO_PI * i / kDiscSegments;
+			mesh.addVertex(glm::vec3(std::cos(a), std::sin(a), 0.0f));
+		}
+		disc = ofVboMesh(mesh);
+		discBuilt = true;
+	}
+	return disc;
+}
+
+uint32_t PetalMeshCache::centerKeyFor(CenterType type, float detail) {
+	uint32_t count = 0;
+	switch (type) {
+		case CenterType::SIMPLE_DISC:    count = 0; break;
+		case CenterType::STAMENS:        count = (uint32_t)std::max(1, (int)(8 * detail)); break;
+		case CenterType::POLLEN_GRID:    count = (uint32_t)std::max(1, (int)std::ceil(kPollenDotsPerDetail * detail)); break;
+		case CenterType::GEOMETRIC_STAR: count = (uint32_t)std::max(2, (int)(5 * detail)); break;
+	}
+	return (uint32_t)type << 16 | std::min(count, 0xffffu);
+}
+
+const ofVboMesh& PetalMeshCache::getCenter(uint32_t key) {
+	auto it = centerMeshes.find(key);
+	if (it != centerMeshes.end()) return it->second;
+
+	CenterType type = (CenterType)(key >> 16);
+	int count = (int)(key & 0xffff);
+	ofMesh mesh;
+	mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+	switch (type) {
+		case CenterType::SIMPLE_DISC:
+			addDisc(mesh, glm::vec2(0.0f), 1.0f, kCenterDiscSegments);
+			break;
+
+		case CenterType::STAMENS:
+			// Filament out to the rim with an anther disc at the tip
+			for (int i = 0; i < count; i++) {
+				float a = TWO_PI * i / count;
+				glm::vec2 tip(std::cos(a), std::sin(a));
+				addSegment(mesh, glm::vec2(0.0f), tip, kStamenHalfWidth);
+				addDisc(mesh, tip, 0.2f, kCenterDotSegments);
+			}
+			break;
+
+		case CenterType::POLLEN_GRID:
+			// A mini phyllotaxis pattern for the center itself
+			for (int i = 0; i < count; i++) {
+				float angle = ofDegToRad(i * 137.508f);
+				float dist = 0.8f * std::sqrt((float)i / count);
+				addDisc(mesh, glm::vec2(dist * std::cos(angle), dist * std::sin(angle)), 0.15f,
+					kCenterDotSegments);
+			}
+			break;
+
+		case CenterType::GEOMETRIC_STAR:
+			// Star-shaped around the origin, so a fan from it covers the outline
+			for (int i = 0; i < count * 2; i++) {
+				float a0 = i * PI / count;
+				float a1 = (i + 1) * PI / count;
+				float d0 = (i % 2 == 0) ? 1.0f : 0.5f;
+				float d1 = (i % 2 == 0) ? 0.5f : 1.0f;
+				mesh.addVertex(glm::vec3(0.0f));
+				mesh.addVertex(glm::vec3(std::cos(a0) * d0, std::sin(a0) * d0, 0.0f));
+				mesh.addVertex(glm::vec3(std::cos(a1) * d1, std::sin(a1) * d1, 0.0f));
+			}
+			break;
+	}
+	buildCount++;
+	Profiler::shared().addCount(ProfileCounter::MESH_BUILDS);
+	return centerMeshes.emplace(key, ofVboMesh(mesh)).first->second;
+}
+
+size_t PetalMeshCache::size() const {
+	return meshes.size();
+}
+
+int PetalMeshCache::getBuildCount() const {
+	return buildCount;
+}
+
+// ============================================================
+// Noise table
+// ============================================================
+
+NoiseTable& NoiseTable::shared() {
+	static NoiseTable table;
+	return table;
+}
+
+NoiseTable::NoiseTable() {
+	// Each axis maps onto a circle whose circumference is the wrap length,
+	// so one noise unit keeps roughly the feature size of ofSignedNoise(x, t)
+	const float xRadius = (kColumns / (float)kSamplesPerUnit) / TWO_PI;
+	const float tRadius = (kRows / (float)kSamplesPerUnit) / TWO_PI;
+	values.resize(kRows * kColumns);
+	for (int r = 0; r < kRows; r++) {
+		float tAngle = TWO_PI * r / kRows;
+		float tz = tRadius * std::cos(tAngle);
+		float tw = tRadius * std::sin(tAngle);
+		for (int c = 0; c < kColumns; c++) {
+			float xAngle = TWO_PI * c / kColumns;
+			values[r * kColumns + c] = ofSignedNoise(
+				xRadius * std::cos(xAngle), xRadius * std::sin(xAngle), tz, tw);
+		}
+	}
+}
+
+void NoiseTable::setTime(double seconds) {
+	time = seconds;
+}
+
+double NoiseTable::getTime() const {
+	return time;
+}
+
+NoiseTable::Sampler NoiseTable::sampler(float t) const {
+	float v = t * kSamplesPerUnit;
+	float fv = std::floor(v);
+	int r0 = (int)fv & (kRows - 1);
+	int r1 = (r0 + 1) & (kRows - 1);
+	return {&values[r0 * kColumns], &values[r1 * kColumns], v - fv};
+}
+
 // ============================================================
 // Inflorescence
 // ============================================================
@@ -35,11 +270,49 @@ void buildPetalPath(ofPath& path, const PetalParams& p, ofColor color) {
 void Inflorescence::setup(const InflorescenceParams& p) {
 	params = p;
 	dirty = true;
+	tableDirty = true;
+}
+
+namespace {
+bool sameLayoutParams(const InflorescenceParams& a, const InflorescenceParams& b) {
+	if (a.headType != b.headType) return false;
+	switch (a.headType) {
+		case HeadType::RADIAL:
+			return true;
+		case HeadType::PHYLLOTAXIS:
+			return a.phyllotaxis.spiralSpacing == b.phyllotaxis.spiralSpacing;
+		case HeadType::ROSE_CURVE:
+			return a.roseCurve.k == b.roseCurve.k && a.roseCurve.baseScale == b.roseCurve.baseScale;
+		case HeadType::SUPERFORMULA: {
+			const auto& x = a.superformula;
+			const auto& y = b.superformula;
+			return x.m == y.m && x.n1 == y.n1 && x.n2 == y.n2 && x.n3 == y.n3 && x.a == y.a && x.b == y.b;
+		}
+		case HeadType::LAYERED_WHORLS:
+			return a.whorls.layerCount == b.whorls.layerCount
+			    && a.whorls.petalsPerLayer == b.whorls.petalsPerLayer
+			    && a.whorls.phaseShift == b.whorls.phaseShift;
+	}
+	return false;
+}
 }
 
 void Inflorescence::setParams(const InflorescenceParams& p) {
+	// Only shape changes need new meshes; length, color and rotation are
+	// applied at draw time
+	if (PetalMeshCache::keyFor(p.petal) != shapeKey
+	    || p.headType != params.headType
+	    || p.whorls.layerCount != params.whorls.layerCount
+	    || p.whorls.lengthFalloff != params.whorls.lengthFalloff
+	    || p.whorls.widthGrowth != params.whorls.widthGrowth
+	    || PetalMeshCache::centerKeyFor(p.centerType, p.centerDetail) != centerKey) {
+		dirty = true;
+	}
+	// The petal table depends on the count and the type's own params
+	if (p.petal.count != params.petal.count || !sameLayoutParams(p, params)) {
+		tableDirty = true;
+	}
 	params = p;
-	dirty = true;
 }
 
 InflorescenceParams& Inflorescence::getParams() {
@@ -47,219 +320,269 @@ InflorescenceParams& Inflorescence::getParams() {
 }
 
 void Inflorescence::rebuild() {
+	ScopedTimer timer(ProfileStage::GEOMETRY);
+	Profiler::shared().addCount(ProfileCounter::REBUILDS);
+	auto& cache = PetalMeshCache::shared();
+	shapeKey = PetalMeshCache::keyFor(params.petal);
 	if (params.headType == HeadType::LAYERED_WHORLS) {
 		const auto& w = params.whorls;
-		whorlPaths.resize(w.layerCount);
+		whorlMeshes.resize(w.layerCount);
+		whorlLengthScales.resize(w.layerCount);
+		whorlKeys.resize(w.layerCount);
 		for (int layer = 0; layer < w.layerCount; layer++) {
 			float t = (float)layer / std::max(w.layerCount - 1, 1);
 			PetalParams lp = params.petal;
-			lp.length *= (1.0f - t * (1.0f - w.lengthFalloff));
 			lp.width = std::min(lp.width * (1.0f + t * (w.widthGrowth - 1.0f)), 0.8f);
-			buildPetalPath(whorlPaths[layer], lp, params.petalColor);
+			whorlLengthScales[layer] = 1.0f - t * (1.0f - w.lengthFalloff);
+			whorlKeys[layer] = PetalMeshCache::keyFor(lp);
+			whorlMeshes[layer] = &cache.get(whorlKeys[layer]);
 		}
 	} else {
-		buildPetalPath(petalPath, params.petal, params.petalColor);
+		petalMesh = &cache.get(shapeKey);
 	}
+	centerKey = PetalMeshCache::centerKeyFor(params.centerType, params.centerDetail);
+	centerMesh = &cache.getCenter(centerKey);
+	coarseReady = false;
 	dirty = false;
+	tableDirty = true;   // whorl length scales may have changed
 }
 
 Inflorescence::NoiseResult Inflorescence::computeNoise(int petalIdx) const {
 	NoiseResult nr = {1.0f, 0.0f, 0.0f};
 	if (!params.noise.enabled) return nr;
 
-	float seed = params.noise.seed;
-	float time = ofGetElapsedTimef() * params.noise.timeSpeed;
-	float px = seed + petalIdx * 7.3f;
-
-	nr.lengthScale = 1.0f + ofSignedNoise(px, time) * params.noise.lengthAmount;
-	nr.angleDeg = ofSignedNoise(px + 100.0f, time) * params.noise.angleAmount;
-	nr.scaleVal = ofSignedNoise(px + 200.0f, time) * params.noise.scaleAmount;
+	float px = params.noise.seed + petalIdx * 7.3f;
+	nr.lengthScale = 1.0f + noiseSampler(px) * params.noise.lengthAmount;
+	nr.angleDeg = noiseSampler(px + 100.0f) * params.noise.angleAmount;
+	nr.scaleVal = noiseSampler(px + 200.0f) * params.noise.scaleAmount;
 
 	return nr;
 }
 
-void Inflorescence::draw() {
-	if (dirty) rebuild();
+void Inflorescence::draw(std::vector<PetalPlacement>& placements, LodTier lod) {
+	layoutPetals(placements, lod);
 
+	ofPushStyle();
 	ofPushMatrix();
 	ofRotateDeg(params.rotation);
 
-	switch (params.headType) {
-		case HeadType::RADIAL:        drawRadial(); break;
-		case HeadType::PHYLLOTAXIS:   drawPhyllotaxis(); break;
-		case HeadType::ROSE_CURVE:    drawRoseCurve(); break;
-		case HeadType::SUPERFORMULA:  drawSuperformula(); break;
-		case HeadType::LAYERED_WHORLS: drawLayeredWhorls(); break;
+	ofFill();
+	ofSetColor(params.petalColor);
+	for (const auto& pl : placements) {
+		ofPushMatrix();
+		ofTranslate(pl.offset.x, pl.offset.y);
+		ofRotateDeg(pl.angleDeg);
+		ofScale(pl.scale.x, pl.scale.y);
+		pl.mesh->draw();
+		ofPopMatrix();
 	}
 
-	// Center
+	ofPopMatrix();
+	ofPopStyle();
+	Profiler::shared().addCount(ProfileCounter::DRAW_CALLS, (int64_t)placements.size());
+
+	drawCenter(lod);
+}
+
+void Inflorescence::drawCenter(LodTier lod) {
+	const ofVboMesh* mesh = getCenterMesh(lod);
+	if (!mesh) return;
+	float r = params.centerRadius;
 	ofPushStyle();
+	ofPushMatrix();
+	ofRotateDeg(params.rotation);
+	ofScale(r, r);
 	ofFill();
 	ofSetColor(params.centerColor);
-	drawCenter();
+	mesh->draw();
+	ofPopMatrix();
 	ofPopStyle();
+	Profiler::shared().addCount(ProfileCounter::DRAW_CALLS);
+}
 
-	ofPopMatrix();
+const ofVboMesh* Inflorescence::getCenterMesh(LodTier lod) {
+	// Impostors are a single disc that already covers the center
+	if (lod == LodTier::IMPOSTOR) return nullptr;
+	// Small heads: every center type collapses to a coarse disc
+	if (lod != LodTier::FULL) return &PetalMeshCache::shared().getDisc();
+	if (dirty) rebuild();
+	return centerMesh;
 }
 
-void Inflorescence::drawCenter() {
-    float r = params.centerRadius;
-    
-    switch (params.centerType) {
-        case CenterType::SIMPLE_DISC:
-            ofDrawCircle(0, 0, r);
-            break;
-
-        case CenterType::STAMENS: {
-            int count = 8 * params.centerDetail;
-            for (int i = 0; i < count; i++) {
-                ofRotateDeg(360.0f / count);
-                ofSetLineWidth(1.5);
-                ofDrawLine(0, 0, r, 0); // The filament
-                ofDrawCircle(r, 0, r * 0.2f); // The anther (tip)
-            }
-            break;
-        }
-
-        case CenterType::POLLEN_GRID: {
-            // A mini phyllotaxis pattern for the center itself
-            for (int i = 0; i < 20 * params.centerDetail; i++) {
-                float angle = i * 137.508f;
-                float dist = (r * 0.8f) * sqrt(i / (20.0f * params.centerDetail));
-                ofDrawCircle(dist * cos(ofDegToRad(angle)), dist * sin(ofDegToRad(angle)), r * 0.15f);
-            }
-            break;
-        }
-
-        case CenterType::GEOMETRIC_STAR: {
-            int points = 5 * params.centerDetail;
-            ofBeginShape();
-            for (int i = 0; i < points * 2; i++) {
-                float angle = i * PI / points;
-                float dist = (i % 2 == 0) ? r : r * 0.5f;
-                ofVertex(cos(angle) * dist, sin(angle) * dist);
-            }
-            ofEndShape(true);
-            break;
-        }
-    }
-}
-
-void Inflorescence::drawRadial() {
-	int count = params.petal.count;
-	if (count <= 0) return;
-	float angleStep = 360.0f / count;
-	for (int i = 0; i < count; i++) {
-		NoiseResult nr = computeNoise(i);
-		ofPushMatrix();
-		ofRotateDeg(i * angleStep + nr.angleDeg);
-		ofScale(1.0f + nr.scaleVal, nr.lengthScale);
-		petalPath.draw();
-		ofPopMatrix();
+void Inflorescence::reserve(int maxPetals, int maxWhorlLayers) {
+	petalTable.reserve(maxPetals);
+	whorlMeshes.reserve(maxWhorlLayers);
+	whorlLengthScales.reserve(maxWhorlLayers);
+	whorlKeys.reserve(maxWhorlLayers);
+	coarseWhorlMeshes.reserve(maxWhorlLayers);
+}
+
+float Inflorescence::getRadius() const {
+	float r = params.petal.count > 0 ? params.petal.length : 0.0f;
+	if (params.headType == HeadType::PHYLLOTAXIS && params.petal.count > 1) {
+		r += params.phyllotaxis.spiralSpacing * std::sqrt((float)(params.petal.count - 1));
 	}
+	return std::max(r, params.centerRadius);
 }
 
-void Inflorescence::drawPhyllotaxis() {
-	int count = params.petal.count;
-	if (count <= 0) return;
-	float c = params.phyllotaxis.spiralSpacing;
-	float goldenAngle = 137.508f;
+namespace {
+// Sprite keys: each quantised field is folded in with a splitmix64 finaliser
+const float kSpriteRatioSteps = 8.0f;   // buckets per unit of size ratios
+const float kSpriteShapeSteps = 4.0f;   // buckets per unit of curve parameters
 
-	for (int i = 0; i < count; i++) {
-		float angle = i * goldenAngle;
-		float r = c * std::sqrt((float)i);
+uint64_t mixSpriteKey(uint64_t h, int64_t v) {
+	uint64_t z = h ^ ((uint64_t)v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2));
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
 
-		NoiseResult nr = computeNoise(i);
+uint64_t mixSpriteKey(uint64_t h, float v, float steps) {
+	return mixSpriteKey(h, (int64_t)std::round(v * steps));
+}
+}
 
-		ofPushMatrix();
-		float rad = ofDegToRad(angle);
-		ofTranslate(r * std::cos(rad), -r * std::sin(rad));
-		ofRotateDeg(-angle + 90.0f + nr.angleDeg);
-		ofScale(1.0f + nr.scaleVal, nr.lengthScale);
-		petalPath.draw();
-		ofPopMatrix();
+uint64_t Inflorescence::spriteKey() const {
+	const auto& p = params;
+	float len = std::max(p.petal.length, 1e-3f);
+	uint64_t h = mixSpriteKey(0, (int64_t)p.headType);
+	h = mixSpriteKey(h, (int64_t)p.petal.count);
+	h = mixSpriteKey(h, (int64_t)PetalMeshCache::keyFor(p.petal));
+	h = mixSpriteKey(h, (int64_t)p.centerType);
+	h = mixSpriteKey(h, p.centerDetail, kSpriteShapeSteps);
+	h = mixSpriteKey(h, p.centerRadius / len, kSpriteRatioSteps);
+	switch (p.headType) {
+		case HeadType::RADIAL:
+			break;
+		case HeadType::PHYLLOTAXIS:
+			h = mixSpriteKey(h, p.phyllotaxis.spiralSpacing / len, kSpriteRatioSteps * 4.0f);
+			break;
+		case HeadType::ROSE_CURVE:
+			h = mixSpriteKey(h, p.roseCurve.k, kSpriteShapeSteps);
+			h = mixSpriteKey(h, p.roseCurve.baseScale, kSpriteRatioSteps);
+			break;
+		case HeadType::SUPERFORMULA: {
+			const auto& sf = p.superformula;
+			for (float v : {sf.m, sf.n1, sf.n2, sf.n3, sf.a, sf.b}) {
+				h = mixSpriteKey(h, v, kSpriteShapeSteps);
+			}
+			break;
+		}
+		case HeadType::LAYERED_WHORLS:
+			h = mixSpriteKey(h, (int64_t)p.whorls.layerCount);
+			h = mixSpriteKey(h, (int64_t)p.whorls.petalsPerLayer);
+			h = mixSpriteKey(h, p.whorls.lengthFalloff, kSpriteRatioSteps);
+			h = mixSpriteKey(h, p.whorls.widthGrowth, kSpriteRatioSteps);
+			h = mixSpriteKey(h, p.whorls.phaseShift, kSpriteRatioSteps);
+			break;
 	}
+	return h;
 }
 
-void Inflorescence::drawRoseCurve() {
-	int count = params.petal.count;
-	if (count <= 0) return;
-	float k = params.roseCurve.k;
-	float baseScale = params.roseCurve.baseScale;
-	float angleStep = 360.0f / count;
-
-	for (int i = 0; i < count; i++) {
-		float angle = i * angleStep;
-		float theta = ofDegToRad(angle);
-		float roseVal = std::abs(std::cos(k * theta));
-		float lengthMod = baseScale + roseVal * (1.0f - baseScale);
-
-		NoiseResult nr = computeNoise(i);
-
-		ofPushMatrix();
-		ofRotateDeg(angle + nr.angleDeg);
-		ofScale(1.0f + nr.scaleVal, lengthMod * nr.lengthScale);
-		petalPath.draw();
-		ofPopMatrix();
+void Inflorescence::layoutPetals(std::vector<PetalPlacement>& out, LodTier lod) {
+	switch (params.headType) {
+		case HeadType::RADIAL:         layoutPetalsAs<HeadType::RADIAL>(out, lod); break;
+		case HeadType::PHYLLOTAXIS:    layoutPetalsAs<HeadType::PHYLLOTAXIS>(out, lod); break;
+		case HeadType::ROSE_CURVE:     layoutPetalsAs<HeadType::ROSE_CURVE>(out, lod); break;
+		case HeadType::SUPERFORMULA:   layoutPetalsAs<HeadType::SUPERFORMULA>(out, lod); break;
+		case HeadType::LAYERED_WHORLS: layoutPetalsAs<HeadType::LAYERED_WHORLS>(out, lod); break;
 	}
 }
 
-void Inflorescence::drawSuperformula() {
+template <HeadType T>
+void Inflorescence::buildPetalTable() {
 	int count = params.petal.count;
-	if (count <= 0) return;
-	const auto& sf = params.superformula;
-	float angleStep = 360.0f / count;
-
+	petalTable.clear();
 	for (int i = 0; i < count; i++) {
-		float angle = i * angleStep;
-		float theta = ofDegToRad(angle);
-
-		float ct = std::cos(sf.m * theta / 4.0f) / sf.a;
-		float st = std::sin(sf.m * theta / 4.0f) / sf.b;
-		float term = std::pow(std::abs(ct), sf.n2) + std::pow(std::abs(st), sf.n3);
-		float r = (term > 1e-6f) ? std::pow(term, -1.0f / sf.n1) : 1.0f;
-		r = ofClamp(r, 0.2f, 1.5f);
-
-		NoiseResult nr = computeNoise(i);
-
-		ofPushMatrix();
-		ofRotateDeg(angle + nr.angleDeg);
-		ofScale(1.0f + nr.scaleVal, r * nr.lengthScale);
-		petalPath.draw();
-		ofPopMatrix();
+		PetalPosition pp = computePetalPosition(T, i, count, params);
+		PetalBase b = {pp.angleDeg, glm::vec2(0.0f), glm::vec2(1.0f), i, 0};
+
+		if constexpr (T == HeadType::PHYLLOTAXIS) {
+			float rad = ofDegToRad(pp.angleDeg);
+			b.offset = glm::vec2(pp.radiusFromCenter * std::cos(rad), -pp.radiusFromCenter * std::sin(rad));
+			b.angleDeg = 90.0f - pp.angleDeg;
+		} else if constexpr (T == HeadType::ROSE_CURVE) {
+			const auto& rc = params.roseCurve;
+			float roseVal = std::abs(std::cos(rc.k * ofDegToRad(pp.angleDeg)));
+			b.scaleMod.y = rc.baseScale + roseVal * (1.0f - rc.baseScale);
+		} else if constexpr (T == HeadType::SUPERFORMULA) {
+			const auto& sf = params.superformula;
+			float theta = ofDegToRad(pp.angleDeg);
+			float ct = std::cos(sf.m * theta / 4.0f) / sf.a;
+			float st = std::sin(sf.m * theta / 4.0f) / sf.b;
+			float term = std::pow(std::abs(ct), sf.n2) + std::pow(std::abs(st), sf.n3);
+			float r = (term > 1e-6f) ? std::pow(term, -1.0f / sf.n1) : 1.0f;
+			b.scaleMod.y = ofClamp(r, 0.2f, 1.5f);
+		} else if constexpr (T == HeadType::LAYERED_WHORLS) {
+			// Inner layers are shorter and wider (their own mesh); outer drawn first
+			int layer = i / params.whorls.petalsPerLayer;
+			if (layer >= (int)whorlLengthScales.size()) break;
+			b.scaleMod = glm::vec2(whorlLengthScales[layer]);
+			b.layer = (int)whorlLengthScales.size() - 1 - layer;
+		}
+		petalTable.push_back(b);
+	}
+	if constexpr (T == HeadType::LAYERED_WHORLS) {
+		std::stable_sort(petalTable.begin(), petalTable.end(),
+			[](const PetalBase& a, const PetalBase& b) { return a.layer < b.layer; });
 	}
+	tableDirty = false;
 }
 
-void Inflorescence::drawLayeredWhorls() {
-	const auto& w = params.whorls;
-	int totalVisible = params.petal.count;
-	if (totalVisible <= 0) return;
-
-	int layers = w.layerCount;
-	int perLayer = w.petalsPerLayer;
-
-	// Draw outer-to-inner (outer = highest indices, drawn first = behind)
-	for (int layer = layers - 1; layer >= 0; layer--) {
-		int layerStart = layer * perLayer;
-		float angleStep = 360.0f / perLayer;
-		float phaseOffset = (layer % 2 == 1) ? angleStep * w.phaseShift : 0.0f;
-
-		int pathIdx = layer;
-		if (pathIdx >= (int)whorlPaths.size()) continue;
-
-		for (int p = 0; p < perLayer; p++) {
-			int globalIdx = layerStart + p;
-			if (globalIdx >= totalVisible) break;
-
-			float angle = p * angleStep + phaseOffset;
-			NoiseResult nr = computeNoise(globalIdx);
+template <HeadType T>
+void Inflorescence::layoutPetalsAs(std::vector<PetalPlacement>& out, LodTier lod) {
+	if (dirty) rebuild();
+	out.clear();
+
+	if (lod == LodTier::IMPOSTOR) {
+		// Petals have gaps between them, so the disc covers a bit less than the tips
+		const float kImpostorCoverage = 0.75f;
+		float r = getRadius() * kImpostorCoverage;
+		out.push_back({&PetalMeshCache::shared().getDisc(), glm::vec2(0.0f), 0.0f, glm::vec2(r), 0});
+		return;
+	}
+	if (tableDirty) buildPetalTable<T>();
+
+	const float len = params.petal.length;
+	const int layers = (int)whorlMeshes.size();
+	auto place = [&](const PetalBase& b, const NoiseResult& nr) {
+		const ofVboMesh* mesh = petalMesh;
+		if constexpr (T == HeadType::LAYERED_WHORLS) mesh = whorlMeshes[layers - 1 - b.layer];
+		out.push_back({mesh, b.offset, b.angleDeg + nr.angleDeg,
+			glm::vec2((1.0f + nr.scaleVal) * len * b.scaleMod.x, nr.lengthScale * len * b.scaleMod.y),
+			b.layer});
+	};
+
+	if (params.noise.enabled) {
+		const NoiseTable& table = NoiseTable::shared();
+		noiseSampler = table.sampler((float)(table.getTime() * params.noise.timeSpeed));
+		for (const PetalBase& b : petalTable) place(b, computeNoise(b.petalIdx));
+	} else {
+		const NoiseResult none = {1.0f, 0.0f, 0.0f};
+		for (const PetalBase& b : petalTable) place(b, none);
+	}
+	if (lod == LodTier::SIMPLE || lod == LodTier::SPRITE) useCoarseMeshes(out);
+}
 
-			ofPushMatrix();
-			ofRotateDeg(angle + nr.angleDeg);
-			ofScale(1.0f + nr.scaleVal, nr.lengthScale);
-			whorlPaths[pathIdx].draw();
-			ofPopMatrix();
+void Inflorescence::useCoarseMeshes(std::vector<PetalPlacement>& out) {
+	auto& cache = PetalMeshCache::shared();
+	bool whorls = params.headType == HeadType::LAYERED_WHORLS;
+	if (!coarseReady) {
+		if (whorls) {
+			coarseWhorlMeshes.resize(whorlKeys.size());
+			for (size_t i = 0; i < whorlKeys.size(); i++) {
+				coarseWhorlMeshes[i] = &cache.getCoarse(whorlKeys[i]);
+			}
+		} else {
+			coarsePetalMesh = &cache.getCoarse(shapeKey);
 		}
+		coarseReady = true;
+	}
+
+	// Whorl placements store the draw layer; the mesh index runs the other way
+	int layers = (int)coarseWhorlMeshes.size();
+	for (auto& pl : out) {
+		pl.mesh = whorls ? coarseWhorlMeshes[layers - 1 - pl.layer] : coarsePetalMesh;
 	}
 }
 
@@ -267,30 +590,130 @@ void Inflorescence::drawLayeredWhorls() {
 // Stem
 // ============================================================
 
+namespace {
+// Stem height is quantised in relative steps; the residual is a vertical
+// scale at draw time, which is visually exact for near-vertical stems
+const float kStemHeightStep = 1.04f;
+const float kStemCurvatureStep = 0.02f;
+
+int quantiseStemHeight(float h) {
+	return (int)std::round(std::log(std::max(h, 0.1f)) / std::log(kStemHeightStep));
+}
+
+int quantiseStemCurvature(float c) {
+	return (int)std::round(c / kStemCurvatureStep);
+}
+}
+
 void Stem::setup(const StemParams& p) {
 	params = p;
-	tendrils.clear();
+	tendrils = TendrilSpan();
 	dirty = true;
+	bakeDirty = true;
 }
 
 void Stem::setParams(const StemParams& p) {
+	// Color changes are applied at draw time and never rebuild the mesh
+	if (shapeKeyFor(p) != shapeKey) dirty = true;
+	if (bakeKeyFor(p) != bakedKey) bakeDirty = true;
 	params = p;
-	dirty = true;
 }
 
 StemParams& Stem::getParams() {
 	return params;
 }
 
+uint64_t Stem::shapeKeyFor(const StemParams& p) {
+	uint64_t h = (uint64_t)(quantiseStemHeight(p.height) + 2048) & 0xfff;
+	uint64_t c = (uint64_t)(quantiseStemCurvature(p.curvature) + 512) & 0x3ff;
+	uint64_t th = (uint64_t)std::round(p.thickness * 20.0f) & 0x3ff;
+	uint64_t tr = (uint64_t)std::round(p.taperRatio * 100.0f) & 0xff;
+	uint64_t seg = (uint64_t)p.segments & 0xff;
+	uint64_t nw = (uint64_t)std::round(p.nodeWidth * 50.0f) & 0xff;
+	return h | c << 12 | th << 22 | tr << 32 | seg << 40 | nw << 48;
+}
+
+uint64_t Stem::bakeKeyFor(const StemParams& p) {
+	// Thickness, taper, segments and node width; height and curvature are live
+	return shapeKeyFor(p) >> 22;
+}
+
 glm::vec2 Stem::getTopPosition() const {
 	// The top of the stem is offset horizontally by curvature
 	float xOffset = params.curvature * params.height * 0.3f;
 	return glm::vec2(xOffset, -params.height);
 }
 
+void Stem::bake(StemStrip& strip) {
+	ScopedTimer timer(ProfileStage::GEOMETRY);
+	Profiler::shared().addCount(ProfileCounter::REBUILDS);
+	strip.clear();
+
+	// Body: left/right pairs along t, half-width tapered with node bumps.
+	// Tendrils follow, so drawing a prefix of the strip skips them.
+	int numSamples = std::max(params.segments * 8, 20);
+	for (int i = 0; i <= numSamples; i++) {
+		float t = (float)i / numSamples;
+		float halfThick = params.thickness * 0.5f * ofLerp(1.0f, params.taperRatio, t);
+		for (int s = 1; s < params.segments; s++) {
+			float dist = std::abs(t - (float)s / params.segments);
+			float bumpRadius = 0.06f;
+			if (dist < bumpRadius) {
+				halfThick *= 1.0f + (params.nodeWidth - 1.0f)
+					* 0.5f * (1.0f + std::cos(PI * dist / bumpRadius));
+			}
+		}
+		strip.add(glm::vec2(t, -halfThick));
+		strip.add(glm::vec2(t, halfThick));
+	}
+	int bodyVertices = strip.size();
+
+	// Tendrils: the curl is integrated in a frame whose +x is the base
+	// direction, in units of stem height; degenerate joints chain them on
+	const int steps = 15;
+	for (const auto& td : tendrils) {
+		glm::vec2 base(td.direction, ofDegToRad(td.startAngle));
+		float halfWidth = td.thickness * 0.5f;
+		float segLen = td.length / steps;
+		float angleStep = td.curlAmount * PI / steps * td.direction;
+
+		glm::vec2 pos(0.0f);
+		strip.repeatLast();
+		for (int i = 0; i <= steps; i++) {
+			// Direction of the segment leaving this point (last point keeps the previous one)
+			float segAngle = std::min(i + 1, steps) * angleStep;
+			float prevAngle = std::max(i, 1) * angleStep;
+			float a = (i == 0 || i == steps) ? segAngle : 0.5f * (segAngle + prevAngle);
+			glm::vec2 normal(-std::sin(a), std::cos(a));
+			glm::vec4 curl(pos.x, pos.y, normal.x, normal.y);
+
+			if (i == 0) strip.add(glm::vec2(td.stemT, -halfWidth), curl, base);
+			strip.add(glm::vec2(td.stemT, -halfWidth), curl, base);
+			strip.add(glm::vec2(td.stemT, halfWidth), curl, base);
+
+			if (i < steps) {
+				float frac = (float)i / steps;
+				pos += glm::vec2(std::cos(segAngle), std::sin(segAngle)) * segLen * (1.0f - frac * 0.4f);
+			}
+		}
+	}
+
+	StemRenderer::upload(bakedStrip, strip);
+	bakedVertices = strip.size();
+	bakedBodyVertices = bodyVertices;
+	bakedKey = bakeKeyFor(params);
+	bakeDirty = false;
+}
+
 void Stem::rebuild() {
-	float h = params.height;
-	float xOff = params.curvature * h * 0.3f;
+	ScopedTimer timer(ProfileStage::GEOMETRY);
+	Profiler::shared().addCount(ProfileCounter::REBUILDS);
+	shapeKey = shapeKeyFor(params);
+	builtHeight = std::pow(kStemHeightStep, (float)quantiseStemHeight(params.height));
+	builtCurvature = quantiseStemCurvature(params.curvature) * kStemCurvatureStep;
+
+	float h = builtHeight;
+	float xOff = builtCurvature * h * 0.3f;
 
 	// Center bezier: P0=base, P3=top
 	glm::vec2 p0(0.0f, 0.0f);
@@ -338,9 +761,8 @@ void Stem::rebuild() {
 	}
 
 	// Build closed path: left edge forward, right edge backward
-	stemPath.clear();
+	ofPath stemPath;
 	stemPath.setFilled(true);
-	stemPath.setFillColor(params.color);
 
 	stemPath.moveTo(leftEdge[0]);
 	for (size_t i = 1; i < leftEdge.size(); i++) {
@@ -350,42 +772,84 @@ void Stem::rebuild() {
 		stemPath.lineTo(rightEdge[i]);
 	}
 	stemPath.close();
+	stemMesh = stemPath.getTessellation();
 
 	dirty = false;
 }
 
-void Stem::draw() {
+void Stem::draw(StemStrip& scratch, bool withTendrils) {
+	StemRenderer& renderer = StemRenderer::shared();
+	if (!renderer.isReady()) {
+		drawTessellated(withTendrils);
+		return;
+	}
+	if (bakeDirty) bake(scratch);
+	renderer.draw(bakedStrip, withTendrils ? bakedVertices : bakedBodyVertices,
+	              params.height, params.curvature, params.color);
+	Profiler::shared().addCount(ProfileCounter::DRAW_CALLS);
+}
+
+void Stem::drawTessellated(bool withTendrils) {
 	if (dirty) rebuild();
-	stemPath.draw();
+	ofSetColor(params.color);
+	ofPushMatrix();
+	ofMultMatrix(builtToLive());
+	stemMesh.draw();
+	ofPopMatrix();
+	if (!withTendrils) {
+		Profiler::shared().addCount(ProfileCounter::DRAW_CALLS);
+		return;
+	}
 	drawTendrils();
+	Profiler::shared().addCount(ProfileCounter::DRAW_CALLS, 1 + (int64_t)tendrils.size());
 }
 
-void Stem::setTendrils(const std::vector<TendrilDef>& t) {
+void Stem::setTendrils(TendrilSpan t) {
 	tendrils = t;
+	bakeDirty = true;
+}
+
+glm::mat4 Stem::builtToLive() const {
+	// Vertical scale for the residual height, then a shear that moves the
+	// built tip sideways onto getTopPosition(); the base stays put
+	float sy = params.height / builtHeight;
+	float builtXOff = builtCurvature * builtHeight * 0.3f;
+	float liveXOff = params.curvature * params.height * 0.3f;
+	float shear = (builtXOff - liveXOff) / std::max(params.height, 1e-3f);
+
+	glm::mat4 m(1.0f);
+	m[1].x = shear * sy;
+	m[1].y = sy;
+	return m;
 }
 
+// Both on the built bezier, mapped like the mesh so tendrils stay on the body
 glm::vec2 Stem::stemPointAt(float t) const {
-	float h = params.height;
-	float xOff = params.curvature * h * 0.3f;
+	float h = builtHeight;
+	float xOff = builtCurvature * h * 0.3f;
 	glm::vec2 p0(0.0f, 0.0f);
 	glm::vec2 p1(xOff * 0.6f, -h * 0.5f);
 	glm::vec2 p2(xOff, -h + h * 0.1f);
 	glm::vec2 p3(xOff, -h);
 
 	float u = 1.0f - t;
-	return u*u*u*p0 + 3.0f*u*u*t*p1 + 3.0f*u*t*t*p2 + t*t*t*p3;
+	glm::vec2 p = u*u*u*p0 + 3.0f*u*u*t*p1 + 3.0f*u*t*t*p2 + t*t*t*p3;
+	glm::mat4 m = builtToLive();
+	return glm::vec2(p.x + m[1].x * p.y, m[1].y * p.y);
 }
 
 glm::vec2 Stem::stemTangentAt(float t) const {
-	float h = params.height;
-	float xOff = params.curvature * h * 0.3f;
+	float h = builtHeight;
+	float xOff = builtCurvature * h * 0.3f;
 	glm::vec2 p0(0.0f, 0.0f);
 	glm::vec2 p1(xOff * 0.6f, -h * 0.5f);
 	glm::vec2 p2(xOff, -h + h * 0.1f);
 	glm::vec2 p3(xOff, -h);
 
 	float u = 1.0f - t;
-	return 3.0f*u*u*(p1 - p0) + 6.0f*u*t*(p2 - p1) + 3.0f*t*t*(p3 - p2);
+	glm::vec2 d = 3.0f*u*u*(p1 - p0) + 6.0f*u*t*(p2 - p1) + 3.0f*t*t*(p3 - p2);
+	glm::mat4 m = builtToLive();
+	return glm::vec2(d.x + m[1].x * d.y, m[1].y * d.y);
 }
 
 void Stem::drawTendrils() {
@@ -436,17 +900,17 @@ void Flower::setup(const InflorescenceParams& ip, const StemParams& sp) {
 	stem.setup(sp);
 }
 
-void Flower::draw(float x, float y) {
+void Flower::draw(float x, float y, FlowerDrawScratch& scratch, LodTier lod, bool withTendrils) {
 	ofPushMatrix();
 	ofTranslate(x, y);  // ground position (stem base)
 
 	// Draw stem from base upward
-	stem.draw();
+	stem.draw(scratch.strip, withTendrils);
 
 	// Move to top of stem and draw flower head
 	glm::vec2 top = stem.getTopPosition();
 	ofTranslate(top.x, top.y);
-	inflorescence.draw();
+	inflorescence.draw(scratch.placements, lod);
 
 	ofPopMatrix();
 }
@@ -463,28 +927,50 @@ Stem& Flower::getStem() {
 // Falling Petal System
 // ============================================================
 
-glm::vec2 FallingPetal::drawPosition() const {
-	return glm::vec2(
-		basePosition.x + std::sin(age * waverFreq * TWO_PI + waverPhase) * waverAmp,
-		basePosition.y
-	);
+glm::vec2 FallingPetal::positionAt(float age, float gravity) const {
+	glm::vec2 base = origin + velocity * age + glm::vec2(0.0f, 0.5f * gravity * age * age);
+	base.x += std::sin(age * waverFreq * TWO_PI + waverPhase) * waverAmp;
+	return base;
+}
+
+float FallingPetal::rotationAt(float age) const {
+	return rotation + rotationSpeed * age;
 }
 
 void FallingPetalSystem::setConfig(const FallingPetalConfig& cfg) {
 	config = cfg;
+	if ((int)pool.size() != config.capacity) allocatePool();
 }
 
 FallingPetalConfig& FallingPetalSystem::getConfig() {
 	return config;
 }
 
+void FallingPetalSystem::allocatePool() {
+	int cap = std::max(config.capacity, 0);
+	pool.assign(cap, FallingPetal());
+	live.clear();
+	live.reserve(cap);
+	freeList.resize(cap);
+	for (int i = 0; i < cap; i++) {
+		freeList[i] = (uint32_t)(cap - 1 - i);  // pop_back hands out low indices first
+	}
+	gpuDirty = true;
+}
+
 void FallingPetalSystem::spawn(glm::vec2 headPos, float detachAngleDeg,
-                                const PetalParams& shape, ofColor color) {
-	FallingPetal fp;
+                                uint32_t shapeKey, float length, ofColor color, RngStream rng) {
+	if (pool.empty()) allocatePool();
+	if (freeList.empty()) return;  // pool exhausted: drop rather than allocate
+
+	uint32_t idx = freeList.back();
+	freeList.pop_back();
+	live.push_back(idx);
+	FallingPetal& fp = pool[idx];
 
 	float rad = ofDegToRad(detachAngleDeg);
-	float midDist = shape.length * 0.4f;
-	fp.basePosition = glm::vec2(
+	float midDist = length * 0.4f;
+	fp.origin = glm::vec2(
 		headPos.x + midDist * std::sin(rad),
 		headPos.y - midDist * std::cos(rad)
 	);
@@ -496,82 +982,187 @@ void FallingPetalSystem::spawn(glm::vec2 headPos, float detachAngleDeg,
 	);
 
 	fp.rotation = detachAngleDeg;
-	fp.rotationSpeed = config.tumbleSpeed * ofRandom(0.6f, 1.4f)
-	                    * (ofRandom(1.0f) > 0.5f ? 1.0f : -1.0f);
-	fp.alpha = 1.0f;
-	fp.age = 0.0f;
-	fp.waverPhase = ofRandom(0.0f, TWO_PI);
-	fp.waverAmp = config.waverAmplitude * ofRandom(0.7f, 1.3f);
-	fp.waverFreq = config.waverFrequency * ofRandom(0.7f, 1.3f);
-
-	fp.shape = shape;
+	fp.rotationSpeed = config.tumbleSpeed * rng.uniform(0.6f, 1.4f)
+	                    * (rng.chance(0.5f) ? 1.0f : -1.0f);
+	fp.waverPhase = rng.uniform(0.0f, TWO_PI);
+	fp.waverAmp = config.waverAmplitude * rng.uniform(0.7f, 1.3f);
+	fp.waverFreq = config.waverFrequency * rng.uniform(0.7f, 1.3f);
+
+	fp.shapeKey = shapeKey;
+	fp.mesh = &PetalMeshCache::shared().get(shapeKey);
+	fp.length = length;
 	fp.color = color;
-	fp.alive = true;
 
-	petals.push_back(fp);
+	// Retirement time is known up front: max lifetime, fully faded, or the
+	// oscillation center falling 50 px below the floor
+	float lifetime = config.maxLifetime;
+	if (config.fadeSpeed > 0.0f) {
+		lifetime = std::min(lifetime, config.fadeDelay + 1.0f / config.fadeSpeed);
+	}
+	float drop = floorY + 50.0f - fp.origin.y;
+	if (config.gravity > 0.0f) {
+		float vy = fp.velocity.y;
+		float tFall = (-vy + std::sqrt(vy * vy + 2.0f * config.gravity * std::max(drop, 0.0f)))
+		              / config.gravity;
+		lifetime = std::min(lifetime, tFall);
+	}
+	fp.spawnTime = clock;
+	fp.deathTime = clock + lifetime;
+	gpuDirty = true;
 }
 
-void FallingPetalSystem::update(float dt) {
-	for (auto& fp : petals) {
-		if (!fp.alive) continue;
-
-		fp.age += dt;
-
-		if (fp.age > config.maxLifetime || fp.basePosition.y > ofGetHeight() + 50.0f) {
-			fp.alive = false;
-			continue;
-		}
-
-		// Gravity
-		fp.velocity.y += config.gravity * dt;
-
-		// Move base position
-		fp.basePosition += fp.velocity * dt;
+namespace {
+// Float seconds keep sub-millisecond steps well past this; the shader's
+// time uniform and spawn times are shifted back before they lose it
+const float kClockRebaseSeconds = 600.0f;
+}
 
-		// Tumble
-		fp.rotation += fp.rotationSpeed * dt;
+void FallingPetalSystem::update(float dt) {
+	ScopedTimer timer(ProfileStage::FALLING_PETALS);
+	clock += dt;
+	if (clock > kClockRebaseSeconds) rebaseClock();
+
+	// Retire expired petals: swap-remove from the live list, recycle the slot
+	for (size_t i = live.size(); i-- > 0;) {
+		if (pool[live[i]].deathTime > clock) continue;
+		freeList.push_back(live[i]);
+		live[i] = live.back();
+		live.pop_back();
+		gpuDirty = true;
+	}
 
-		// Fade after delay
-		if (fp.age > config.fadeDelay) {
-			fp.alpha -= config.fadeSpeed * dt;
-			if (fp.alpha < 0.0f) fp.alpha = 0.0f;
-		}
+	if (live.empty()) clock = 0.0f;
+}
 
-		if (fp.alpha <= 0.0f) fp.alive = false;
+void FallingPetalSystem::rebaseClock() {
+	// Ages are differences, so shifting every time by the same amount leaves
+	// motion untouched; petals live seconds, so their times stay small
+	for (uint32_t idx : live) {
+		pool[idx].spawnTime -= clock;
+		pool[idx].deathTime -= clock;
 	}
+	clock = 0.0f;
+	gpuDirty = true;
+}
 
-	// Remove dead petals
-	petals.erase(
-		std::remove_if(petals.begin(), petals.end(),
-			[](const FallingPetal& fp) { return !fp.alive; }),
-		petals.end()
-	);
+float FallingPetalSystem::alphaAt(float age) const {
+	return ofClamp(1.0f - std::max(age - config.fadeDelay, 0.0f) * config.fadeSpeed, 0.0f, 1.0f);
 }
 
 void FallingPetalSystem::draw() {
-	ofPath path;
-	for (const auto& fp : petals) {
-		if (!fp.alive || fp.alpha <= 0.01f) continue;
+	if (live.empty()) return;
+	ScopedTimer timer(ProfileStage::FALLING_PETALS);
 
-		ofColor c = fp.color;
-		c.a = (unsigned char)(fp.alpha * 255.0f);
-		buildPetalPath(path, fp.shape, c);
+	if (gpuSimulation && !gpuInitialized) {
+		gpuRenderer.setup();
+		gpuInitialized = true;
+	}
+	if (gpuSimulation && gpuRenderer.isReady()) {
+		drawGpu();
+	} else {
+		drawCpu();
+	}
+}
 
-		glm::vec2 pos = fp.drawPosition();
+void FallingPetalSystem::drawCpu() {
+	ofPushStyle();
+	ofFill();
+	for (uint32_t idx : live) {
+		const FallingPetal& fp = pool[idx];
+		float age = std::max(clock - drawLag - fp.spawnTime, 0.0f);
+		float alpha = alphaAt(age);
+		if (alpha <= 0.01f) continue;
+
+		glm::vec2 pos = fp.positionAt(age, config.gravity);
+		ofSetColor(fp.color, (unsigned char)(alpha * 255.0f));
 		ofPushMatrix();
 		ofTranslate(pos.x, pos.y);
-		ofRotateDeg(fp.rotation);
-		path.draw();
+		ofRotateDeg(fp.rotationAt(age));
+		ofScale(fp.length, fp.length);
+		fp.mesh->draw();
 		ofPopMatrix();
 	}
+	ofPopStyle();
+	Profiler::shared().addCount(ProfileCounter::DRAW_CALLS, (int64_t)live.size());
+}
+
+void FallingPetalSystem::drawGpu() {
+	// Launch data is re-sent only when the live set changes; proper motion
+	// between spawns/retirements is just a new time uniform
+	if (gpuDirty) {
+		gpuRenderer.begin();
+		for (uint32_t idx : live) {
+			const FallingPetal& fp = pool[idx];
+			FallingPetalLaunch launch;
+			launch.launch = glm::vec4(fp.origin.x, fp.origin.y, fp.velocity.x, fp.velocity.y);
+			launch.spin = glm::vec4(fp.rotation, fp.rotationSpeed, fp.waverPhase, fp.waverAmp);
+			launch.timing = glm::vec4(fp.waverFreq, fp.length, fp.spawnTime, 0.0f);
+			launch.color = glm::vec4(fp.color.r / 255.0f, fp.color.g / 255.0f,
+			                         fp.color.b / 255.0f, 1.0f);
+			gpuRenderer.add(*fp.mesh, launch);
+		}
+		gpuDirty = false;
+	}
+
+	FallingPetalRenderer::Motion motion;
+	motion.time = clock - drawLag;   // the shader clamps age at 0
+	motion.gravity = config.gravity;
+	motion.fadeDelay = config.fadeDelay;
+	motion.fadeSpeed = config.fadeSpeed;
+	gpuRenderer.draw(motion);
+	Profiler::shared().addCount(ProfileCounter::DRAW_CALLS, gpuRenderer.getDrawCalls());
+}
+
+void FallingPetalSystem::setDrawLag(float seconds) {
+	drawLag = seconds;
+}
+
+void FallingPetalSystem::setFloor(float y) {
+	floorY = y;
 }
 
 void FallingPetalSystem::clear() {
-	petals.clear();
+	for (uint32_t idx : live) freeList.push_back(idx);
+	live.clear();
+	clock = 0.0f;
+	gpuDirty = true;
+}
+
+void FallingPetalSystem::setGpuSimulation(bool enabled) {
+	gpuSimulation = enabled;
+	gpuDirty = true;
+}
+
+bool FallingPetalSystem::isGpuSimulation() const {
+	return gpuSimulation;
+}
+
+void FallingPetalSystem::exportLive(std::vector<FallingPetal>& out) const {
+	out.clear();
+	out.reserve(live.size());
+	for (uint32_t idx : live) out.push_back(pool[idx]);
+}
+
+float FallingPetalSystem::getClock() const {
+	return clock;
+}
+
+void FallingPetalSystem::restore(const FallingPetal* petals, size_t n, float restoredClock) {
+	if (pool.empty()) allocatePool();
+	clear();
+	clock = restoredClock;
+	for (size_t i = 0; i < n && !freeList.empty(); i++) {
+		uint32_t idx = freeList.back();
+		freeList.pop_back();
+		live.push_back(idx);
+		FallingPetal& fp = pool[idx];
+		fp = petals[i];
+		fp.mesh = &PetalMeshCache::shared().get(fp.shapeKey);   // pointers don't survive a restart
+	}
 }
 
 int FallingPetalSystem::activeCount() const {
-	return (int)petals.size();
+	return (int)live.size();
 }
 
 // ============================================================
@@ -636,95 +1227,210 @@ static const ColorSchemeDef kColorSchemes[8] = {
 };
 static const int kNumSchemes = 8;
 
+// ============================================================
+// FlowerStateArrays
+// ============================================================
+
+void FlowerStateArrays::clear() {
+	lifePhase.clear();
+	prevLifePhase.clear();
+	prevRotationAccum.clear();
+	prevFastDeathTimer.clear();
+	ripple.clear();
+	lifeSpeedMult.clear();
+	currentAlpha.clear();
+	lastVisiblePetals.clear();
+	rotationAccum.clear();
+	rotationSpeed.clear();
+	rotationDir.clear();
+	fastDeath.clear();
+	fastDeathTimer.clear();
+	rng.clear();
+	handle.clear();
+}
+
+void FlowerStateArrays::reserve(size_t n) {
+	lifePhase.reserve(n);
+	prevLifePhase.reserve(n);
+	prevRotationAccum.reserve(n);
+	prevFastDeathTimer.reserve(n);
+	ripple.reserve(n);
+	lifeSpeedMult.reserve(n);
+	currentAlpha.reserve(n);
+	lastVisiblePetals.reserve(n);
+	rotationAccum.reserve(n);
+	rotationSpeed.reserve(n);
+	rotationDir.reserve(n);
+	fastDeath.reserve(n);
+	fastDeathTimer.reserve(n);
+	rng.reserve(n);
+	handle.reserve(n);
+}
+
+void FlowerStateArrays::push(uint32_t h) {
+	lifePhase.push_back(0.0f);
+	prevLifePhase.push_back(0.0f);
+	prevRotationAccum.push_back(0.0f);
+	prevFastDeathTimer.push_back(0.0f);
+	ripple.push_back(0.0f);
+	lifeSpeedMult.push_back(1.0f);
+	currentAlpha.push_back(1.0f);
+	lastVisiblePetals.push_back(-1);
+	rotationAccum.push_back(0.0f);
+	rotationSpeed.push_back(0.0f);
+	rotationDir.push_back(1.0f);
+	fastDeath.push_back(0);
+	fastDeathTimer.push_back(0.0f);
+	rng.push_back(RngStream());
+	handle.push_back(h);
+}
+
+void FlowerStateArrays::swapRemove(size_t slot) {
+	size_t last = handle.size() - 1;
+	if (slot != last) {
+		lifePhase[slot] = lifePhase[last];
+		prevLifePhase[slot] = prevLifePhase[last];
+		prevRotationAccum[slot] = prevRotationAccum[last];
+		prevFastDeathTimer[slot] = prevFastDeathTimer[last];
+		ripple[slot] = ripple[last];
+		lifeSpeedMult[slot] = lifeSpeedMult[last];
+		currentAlpha[slot] = currentAlpha[last];
+		lastVisiblePetals[slot] = lastVisiblePetals[last];
+		rotationAccum[slot] = rotationAccum[last];
+		rotationSpeed[slot] = rotationSpeed[last];
+		rotationDir[slot] = rotationDir[last];
+		fastDeath[slot] = fastDeath[last];
+		fastDeathTimer[slot] = fastDeathTimer[last];
+		rng[slot] = rng[last];
+		handle[slot] = handle[last];
+	}
+	lifePhase.pop_back();
+	prevLifePhase.pop_back();
+	prevRotationAccum.pop_back();
+	prevFastDeathTimer.pop_back();
+	ripple.pop_back();
+	lifeSpeedMult.pop_back();
+	currentAlpha.pop_back();
+	lastVisiblePetals.pop_back();
+	rotationAccum.pop_back();
+	rotationSpeed.pop_back();
+	rotationDir.pop_back();
+	fastDeath.pop_back();
+	fastDeathTimer.pop_back();
+	rng.pop_back();
+	handle.pop_back();
+}
+
+void FlowerStateArrays::snapshot(size_t begin, size_t end) {
+	std::copy(lifePhase.begin() + begin, lifePhase.begin() + end, prevLifePhase.begin() + begin);
+	std::copy(rotationAccum.begin() + begin, rotationAccum.begin() + end, prevRotationAccum.begin() + begin);
+	std::copy(fastDeathTimer.begin() + begin, fastDeathTimer.begin() + end, prevFastDeathTimer.begin() + begin);
+}
+
 // ============================================================
 // FlowerField
 // ============================================================
 
-void FlowerField::respawnFlower(FlowerInstance& fi) {
+void FlowerField::respawnFlower(size_t slot) {
+	FlowerGenome& g = genomes[state.handle[slot]];
+
+	// Each spawn gets its own stream: the genome comes from one batch and
+	// the flower keeps the rest for its per-tick decisions
+	state.rng[slot] = RngStream(rngSeed, ++spawnCounter);
+	RngBatch<kGenomeRolls> roll(state.rng[slot]);
+
 	// Random position: full screen coverage
-	fi.normPos.x = ofRandom(0.02f, 0.98f);
-	fi.normPos.y = ofRandom(0.05f, 0.98f);
+	g.normPos.x = roll(0.02f, 0.98f);
+	g.normPos.y = roll(0.05f, 0.98f);
+	grid.insert(state.handle[slot], g.normPos);
+	state.ripple[slot] = 0.0f;
 
 	// Depth scale: flowers near bottom (y~0.98) are close/large, near top (y~0.05) are far/small
-	float depthT = (fi.normPos.y - 0.05f) / 0.93f;
-	fi.depthScale = ofLerp(0.3f, 1.2f, depthT);
+	float depthT = (g.normPos.y - 0.05f) / 0.93f;
+	g.depthScale = ofLerp(0.3f, 1.2f, depthT);
 
 	// Random base petal properties (defaults; head type may override some)
-	fi.baseLength = ofRandom(35.0f, 75.0f);
-	fi.baseWidth = ofRandom(0.2f, 0.55f);
-	fi.basePointiness = ofRandom(0.2f, 0.8f);
-	fi.baseBulge = ofRandom(0.3f, 0.7f);
-	fi.baseEdgeCurvature = ofRandom(-0.15f, 0.4f);
-	fi.baseCenterRadius = ofRandom(4.0f, 12.0f);
+	g.length = roll(35.0f, 75.0f);
+	g.width = roll(0.2f, 0.55f);
+	g.pointiness = roll(0.2f, 0.8f);
+	g.bulge = roll(0.3f, 0.7f);
+	g.edgeCurvature = roll(-0.15f, 0.4f);
+	g.centerRadius = roll(4.0f, 12.0f);
 
 	// Assign head type with weighted distribution
-	float typeRoll = ofRandom(1.0f);
-	if (typeRoll < 0.25f) {
-		fi.baseHeadType = HeadType::RADIAL;
-		fi.basePetalCount = (int)ofRandom(4, 9);
-	} else if (typeRoll < 0.45f) {
-		fi.baseHeadType = HeadType::PHYLLOTAXIS;
-		fi.basePetalCount = (int)ofRandom(25, 41);
-		fi.basePhyllotaxis.spiralSpacing = ofRandom(3.0f, 6.0f);
-		fi.baseLength = ofRandom(15.0f, 30.0f);
-		fi.baseCenterRadius = ofRandom(2.0f, 5.0f);
-	} else if (typeRoll < 0.65f) {
-		fi.baseHeadType = HeadType::ROSE_CURVE;
-		fi.basePetalCount = (int)ofRandom(10, 17);
+	float weightSum = 0.0f;
+	for (float wgt : headTypeWeights) weightSum += wgt;
+	float typeRoll = roll(weightSum);
+	int typeIdx = 0;
+	while (typeIdx < kNumHeadTypes - 1 && typeRoll >= headTypeWeights[typeIdx]) {
+		typeRoll -= headTypeWeights[typeIdx];
+		typeIdx++;
+	}
+	g.headType = (HeadType)typeIdx;
+
+	if (g.headType == HeadType::RADIAL) {
+		g.petalCount = roll.range(4, 9);
+	} else if (g.headType == HeadType::PHYLLOTAXIS) {
+		g.petalCount = roll.range(25, 41);
+		g.phyllotaxis.spiralSpacing = roll(3.0f, 6.0f);
+		g.length = roll(15.0f, 30.0f);
+		g.centerRadius = roll(2.0f, 5.0f);
+	} else if (g.headType == HeadType::ROSE_CURVE) {
+		g.petalCount = roll.range(10, 17);
 		float kOptions[] = {2.0f, 2.5f, 3.0f, 3.5f, 4.0f, 5.0f};
-		fi.baseRoseCurve.k = kOptions[(int)ofRandom(0, 6)];
-		fi.baseRoseCurve.baseScale = ofRandom(0.2f, 0.45f);
-	} else if (typeRoll < 0.80f) {
-		fi.baseHeadType = HeadType::SUPERFORMULA;
-		fi.basePetalCount = (int)ofRandom(12, 21);
-		fi.baseSuperformula.m = ofRandom(3.0f, 8.0f);
-		fi.baseSuperformula.n1 = ofRandom(0.3f, 2.0f);
-		fi.baseSuperformula.n2 = ofRandom(0.5f, 2.0f);
-		fi.baseSuperformula.n3 = ofRandom(0.5f, 2.0f);
-		fi.baseSuperformula.a = ofRandom(0.8f, 1.2f);
-		fi.baseSuperformula.b = ofRandom(0.8f, 1.2f);
+		g.roseCurve.k = kOptions[roll.range(0, 6)];
+		g.roseCurve.baseScale = roll(0.2f, 0.45f);
+	} else if (g.headType == HeadType::SUPERFORMULA) {
+		g.petalCount = roll.range(12, 21);
+		g.superformula.m = roll(3.0f, 8.0f);
+		g.superformula.n1 = roll(0.3f, 2.0f);
+		g.superformula.n2 = roll(0.5f, 2.0f);
+		g.superformula.n3 = roll(0.5f, 2.0f);
+		g.superformula.a = roll(0.8f, 1.2f);
+		g.superformula.b = roll(0.8f, 1.2f);
 	} else {
-		fi.baseHeadType = HeadType::LAYERED_WHORLS;
-		fi.baseWhorls.layerCount = (int)ofRandom(3, 5);
-		fi.baseWhorls.petalsPerLayer = (int)ofRandom(5, 9);
-		fi.basePetalCount = fi.baseWhorls.layerCount * fi.baseWhorls.petalsPerLayer;
-		fi.baseWhorls.lengthFalloff = ofRandom(0.55f, 0.8f);
-		fi.baseWhorls.widthGrowth = ofRandom(1.2f, 1.6f);
-		fi.baseWhorls.phaseShift = ofRandom(0.4f, 0.6f);
+		g.whorls.layerCount = roll.range(3, 5);
+		g.whorls.petalsPerLayer = roll.range(5, 9);
+		g.petalCount = g.whorls.layerCount * g.whorls.petalsPerLayer;
+		g.whorls.lengthFalloff = roll(0.55f, 0.8f);
+		g.whorls.widthGrowth = roll(1.2f, 1.6f);
+		g.whorls.phaseShift = roll(0.4f, 0.6f);
 	}
 
 	// Noise modifier: 60% of flowers get gentle wobble
-	fi.baseNoise.enabled = (ofRandom(1.0f) > 0.4f);
-	fi.baseNoise.seed = ofRandom(0.0f, 10000.0f);
-	fi.baseNoise.lengthAmount = ofRandom(0.03f, 0.10f);
-	fi.baseNoise.angleAmount = ofRandom(1.0f, 5.0f);
-	fi.baseNoise.scaleAmount = ofRandom(0.02f, 0.06f);
-	fi.baseNoise.timeSpeed = ofRandom(0.05f, 0.2f);
+	g.noise.enabled = (roll(1.0f) > 0.4f);
+	g.noise.seed = roll(0.0f, 10000.0f);
+	g.noise.lengthAmount = roll(0.03f, 0.10f);
+	g.noise.angleAmount = roll(1.0f, 5.0f);
+	g.noise.scaleAmount = roll(0.02f, 0.06f);
+	g.noise.timeSpeed = roll(0.05f, 0.2f);
 
 	// Stem
-	fi.baseStemHeight = ofRandom(60.0f, 140.0f);
-	fi.baseStemCurvature = ofRandom(-0.4f, 0.4f);
+	g.stemHeight = roll(60.0f, 140.0f);
+	g.stemCurvature = roll(-0.4f, 0.4f);
 
 	// Stem diversity: taper + segments
-	fi.baseTaperRatio = ofRandom(0.15f, 0.5f);
-	fi.baseSegments = (ofRandom(1.0f) > 0.4f) ? (int)ofRandom(2, 5) : 1;
-	fi.baseNodeWidth = ofRandom(1.4f, 2.0f);
-
-	// Tendrils (40% of flowers)
-	fi.baseTendrils.clear();
-	if (ofRandom(1.0f) > 0.6f) {
-		int numTendrils = (int)ofRandom(1, 4);
+	g.taperRatio = roll(0.15f, 0.5f);
+	g.segments = (roll(1.0f) > 0.4f) ? roll.range(2, 5) : 1;
+	g.nodeWidth = roll(1.4f, 2.0f);
+
+	// Tendrils (40% of flowers), written into this handle's slab entry
+	TendrilDef* tendrilSlot = &tendrilSlab[(size_t)state.handle[slot] * kMaxTendrilsPerFlower];
+	int numTendrils = 0;
+	if (roll(1.0f) > 0.6f) {
+		numTendrils = roll.range(1, 4);
 		for (int i = 0; i < numTendrils; i++) {
 			TendrilDef td;
-			td.stemT = ofRandom(0.2f, 0.7f);
-			td.length = ofRandom(0.15f, 0.35f);
-			td.curlAmount = ofRandom(1.0f, 3.0f);
-			td.direction = (ofRandom(1.0f) > 0.5f) ? 1.0f : -1.0f;
-			td.startAngle = ofRandom(10.0f, 50.0f);
-			td.thickness = ofRandom(1.0f, 2.5f);
-			fi.baseTendrils.push_back(td);
+			td.stemT = roll(0.2f, 0.7f);
+			td.length = roll(0.15f, 0.35f);
+			td.curlAmount = roll(1.0f, 3.0f);
+			td.direction = (roll(1.0f) > 0.5f) ? 1.0f : -1.0f;
+			td.startAngle = roll(10.0f, 50.0f);
+			td.thickness = roll(1.0f, 2.5f);
+			tendrilSlot[i] = td;
 		}
 	}
+	g.tendrils = {tendrilSlot, numTendrils};
 
 	// Color scheme selection
 	int schemeIdx;
@@ -732,93 +1438,101 @@ void FlowerField::respawnFlower(FlowerInstance& fi) {
 		schemeIdx = iterateIndex;
 		iterateIndex = (iterateIndex + 1) % kNumSchemes;
 	} else if (colorMode == 9) {
-		schemeIdx = (int)ofRandom(0, kNumSchemes);
+		schemeIdx = roll.range(0, kNumSchemes);
 	} else {
 		schemeIdx = ofClamp(colorMode - 1, 0, kNumSchemes - 1);
 	}
 	const auto& cs = kColorSchemes[schemeIdx];
 
 	// 1. Pick Petal Color from scheme
-	float hue = ofRandom(cs.hueMin, cs.hueMax);
-	fi.basePetalColor.setHsb(hue, ofRandom(cs.satMin, cs.satMax),
-	                         ofRandom(cs.briMin, cs.briMax));
+	float hue = roll(cs.hueMin, cs.hueMax);
+	g.petalColor.setHsb(hue, roll(cs.satMin, cs.satMax),
+	                         roll(cs.briMin, cs.briMax));
 
 	// 2. Complementary center color (hue + 128)
 	float centerHue = fmod(hue + 128.0f, 256.0f);
-	fi.baseCenterColor.setHsb(
+	g.centerColor.setHsb(
 		(int)centerHue,
-		(int)ofRandom(200, 255),
-		(int)ofRandom(200, 255)
+		roll.range(200, 255),
+		roll.range(200, 255)
 	);
 
 	// 3. Stem: natural green tinted slightly toward the scheme
 	float schemeMidHue = (cs.hueMin + cs.hueMax) * 0.5f;
 	float stemHue = fmod(ofLerp(85.0f, schemeMidHue, 0.2f), 256.0f);
-	fi.baseStemColor.setHsb(stemHue, ofRandom(100, 170), ofRandom(80, 160));
+	g.stemColor.setHsb(stemHue, roll(100, 170), roll(80, 160));
 
 	// 3. Assign a Center Type based on Head Type for "Best Fit"
-	if (fi.baseHeadType == HeadType::PHYLLOTAXIS) {
-		fi.baseCenterType = CenterType::POLLEN_GRID; // Fits the "sunflower" look
-	} else if (fi.baseHeadType == HeadType::RADIAL) {
-		fi.baseCenterType = CenterType::STAMENS;     // Fits the "lily/daisy" look
+	if (g.headType == HeadType::PHYLLOTAXIS) {
+		g.centerType = CenterType::POLLEN_GRID; // Fits the "sunflower" look
+	} else if (g.headType == HeadType::RADIAL) {
+		g.centerType = CenterType::STAMENS;     // Fits the "lily/daisy" look
 	} else {
-		fi.baseCenterType = (ofRandom(1.0f) > 0.5f) ? CenterType::SIMPLE_DISC : CenterType::GEOMETRIC_STAR;
+		g.centerType = (roll(1.0f) > 0.5f) ? CenterType::SIMPLE_DISC : CenterType::GEOMETRIC_STAR;
 	}
-	fi.baseCenterDetail = ofRandom(1.0f, 2.5f);
+	g.centerDetail = roll(1.0f, 2.5f);
 
 	// Music reactivity personality
-	fi.pitchDirection = (ofRandom(1.0f) > 0.5f) ? 1.0f : -1.0f;
-	fi.lifeSpeedMult = ofRandom(0.7f, 1.3f);
+	g.pitchDirection = (roll(1.0f) > 0.5f) ? 1.0f : -1.0f;
+	state.lifeSpeedMult[slot] = roll(0.7f, 1.3f);
 
-	// Reset fast death state
-	fi.fastDeath = false;
-	fi.fastDeathTimer = 0.0f;
+	// Restart the lifecycle and reset fast death state
+	state.lifePhase[slot] = 0.0f;
+	state.fastDeath[slot] = 0;
+	state.fastDeathTimer[slot] = 0.0f;
 
 	// Rotation: in reactive mode all flowers rotate faster based on activity
-	fi.rotationAccum = 0.0f;
+	state.rotationAccum[slot] = 0.0f;
 	if (reactiveMode) {
-		fi.rotationSpeed = ofRandom(20.0f, 60.0f) * (0.5f + activityLevel);
-		fi.rotationDir = (ofRandom(1.0f) > 0.5f) ? 1.0f : -1.0f;
-	} else if (ofRandom(1.0f) > 0.4f) {
-		fi.rotationSpeed = ofRandom(15.0f, 45.0f);
-		fi.rotationDir = (ofRandom(1.0f) > 0.5f) ? 1.0f : -1.0f;
+		state.rotationSpeed[slot] = roll(20.0f, 60.0f) * (0.5f + activityLevel);
+		state.rotationDir[slot] = (roll(1.0f) > 0.5f) ? 1.0f : -1.0f;
+	} else if (roll(1.0f) > 0.4f) {
+		state.rotationSpeed[slot] = roll(15.0f, 45.0f);
+		state.rotationDir[slot] = (roll(1.0f) > 0.5f) ? 1.0f : -1.0f;
 	} else {
-		fi.rotationSpeed = 0.0f;
-		fi.rotationDir = 1.0f;
+		state.rotationSpeed[slot] = 0.0f;
+		state.rotationDir[slot] = 1.0f;
 	}
+	state.snapshot(slot, slot + 1);   // don't interpolate from the previous life
+	buildFlower(slot);
+}
+
+void FlowerField::buildFlower(size_t slot) {
+	const FlowerGenome& g = genomes[state.handle[slot]];
 
 	// Initialize flower with base params (small — will grow)
 	InflorescenceParams ip;
-	ip.headType = fi.baseHeadType;
-	ip.petal.count = fi.basePetalCount;
+	ip.headType = g.headType;
+	ip.petal.count = g.petalCount;
 	ip.petal.length = 0.1f;
-	ip.petal.width = fi.baseWidth;
-	ip.petal.tipPointiness = fi.basePointiness;
-	ip.petal.bulgePosition = fi.baseBulge;
-	ip.petal.edgeCurvature = fi.baseEdgeCurvature;
+	ip.petal.width = g.width;
+	ip.petal.tipPointiness = g.pointiness;
+	ip.petal.bulgePosition = g.bulge;
+	ip.petal.edgeCurvature = g.edgeCurvature;
 	ip.centerRadius = 0.1f;
-	ip.petalColor = fi.basePetalColor;
-	ip.centerColor = fi.baseCenterColor;
-	ip.centerType = fi.baseCenterType;
-	ip.centerDetail = fi.baseCenterDetail;
-	ip.phyllotaxis = fi.basePhyllotaxis;
-	ip.roseCurve = fi.baseRoseCurve;
-	ip.superformula = fi.baseSuperformula;
-	ip.whorls = fi.baseWhorls;
-	ip.noise = fi.baseNoise;
+	ip.petalColor = g.petalColor;
+	ip.centerColor = g.centerColor;
+	ip.centerType = g.centerType;
+	ip.centerDetail = g.centerDetail;
+	ip.phyllotaxis = g.phyllotaxis;
+	ip.roseCurve = g.roseCurve;
+	ip.superformula = g.superformula;
+	ip.whorls = g.whorls;
+	ip.noise = g.noise;
 
 	StemParams sp;
 	sp.height = 0.1f;
-	sp.thickness = ofLerp(1.5f, 4.0f, fi.depthScale);
-	sp.taperRatio = fi.baseTaperRatio;
-	sp.curvature = fi.baseStemCurvature;
-	sp.color = fi.baseStemColor;
-	sp.segments = fi.baseSegments;
-	sp.nodeWidth = fi.baseNodeWidth;
-
-	fi.flower.setup(ip, sp);
-	fi.flower.getStem().setTendrils(fi.baseTendrils);
-	fi.lastVisiblePetals = -1;
+	sp.thickness = ofLerp(1.5f, 4.0f, g.depthScale);
+	sp.taperRatio = g.taperRatio;
+	sp.curvature = g.stemCurvature;
+	sp.color = g.stemColor;
+	sp.segments = g.segments;
+	sp.nodeWidth = g.nodeWidth;
+
+	Flower& flower = flowers[state.handle[slot]];
+	flower.setup(ip, sp);
+	flower.getStem().setTendrils(g.tendrils);
+	state.lastVisiblePetals[slot] = -1;
 }
 
 void FlowerField::setReactiveMode(bool enabled) {
@@ -829,6 +1543,19 @@ bool FlowerField::isReactiveMode() const {
 	return reactiveMode;
 }
 
+void FlowerField::setBeatLookahead(float seconds) {
+	beatLookahead = ofClamp(seconds, 0.0f, kMaxBeatLookahead);
+}
+
+float FlowerField::getBeatLookahead() const {
+	return beatLookahead;
+}
+
+float FlowerField::getVolumeSmoothingLag() {
+	// A one-pole smoother delays slow signals by its time constant
+	return kVolumeTau;
+}
+
 void FlowerField::setColorMode(int mode) {
 	colorMode = ofClamp(mode, 0, 9);
 	iterateIndex = 0;
@@ -845,33 +1572,373 @@ std::string FlowerField::getColorSchemeName() const {
 	return kColorSchemes[idx].name;
 }
 
+void FlowerField::setSeed(uint64_t value) {
+	seed = value;
+	seedSet = true;
+}
+
+uint64_t FlowerField::getSeed() const {
+	return rngSeed;
+}
+
+void FlowerField::setParallelUpdate(bool enabled) {
+	parallelUpdate = enabled;
+}
+
+bool FlowerField::isParallelUpdate() const {
+	return parallelUpdate;
+}
+
+void FlowerField::setHeadTypeWeights(const std::array<float, kNumHeadTypes>& weights) {
+	headTypeWeights = weights;
+}
+
+const std::array<float, kNumHeadTypes>& FlowerField::getHeadTypeWeights() const {
+	return headTypeWeights;
+}
+
+namespace {
+// Largest heads respawnFlower() generates (phyllotaxis petals, whorl layers)
+const int kMaxPetalsPerHead = 40;
+const int kMaxWhorlLayers = 4;
+}
+
 void FlowerField::setup(int count) {
 	baseCount = count;
-	instances.resize(count);
+	if (!pool) pool = std::make_unique<WorkerPool>();
+	fallingPetals.setGpuSimulation(renderMode == FieldRenderMode::INSTANCED);
+	rngSeed = seedSet ? seed : ((uint64_t)std::random_device()() << 32) ^ std::random_device()();
+	spawnCounter = 0;
+	fieldRng = RngStream(rngSeed, 0);
+
+	// Every handle is built up front; addFlower/removeFlower only move
+	// handles between the free list and the live set
+	size_t cap = (size_t)std::max(capacity, count);
+	state.clear();
+	state.reserve(cap);
+	genomes.assign(cap, FlowerGenome());
+	flowers.clear();
+	flowers.resize(cap);
+	for (Flower& flower : flowers) {
+		flower.getInflorescence().reserve(kMaxPetalsPerHead, kMaxWhorlLayers);
+	}
+	tendrilSlab.assign(cap * kMaxTendrilsPerFlower, TendrilDef());
+	slotOfHandle.assign(cap, kNoSlot);
+	freeHandles.clear();
+	freeHandles.reserve(cap);
+	for (size_t h = cap; h-- > 0;) freeHandles.push_back((uint32_t)h);
+	drawOrder.clear();
+	drawOrder.reserve(cap);
+
+	// About two flowers per cell at capacity
+	int cells = ofClamp((int)std::round(std::sqrt(cap / 2.0f)), 8, 64);
+	grid.setup(cells, cells, cap);
+	inView.assign(cap, 0);
+	inViewList.clear();
+	inViewList.reserve(cap);
+	numRipples = 0;
 
-	for (auto& fi : instances) {
-		respawnFlower(fi);
+	for (int i = 0; i < count; i++) {
+		size_t slot = addFlower();
+		respawnFlower(slot);
 		// Stagger starting phases so they don't all bloom at once
-		fi.lifePhase = ofRandom(0.0f, 1.0f);
+		state.lifePhase[slot] = fieldRng.uniform();
+		state.snapshot(slot, slot + 1);
+		drawOrder.push_back(state.handle[slot]);
 	}
 
-	// Sort back to front (lower y = farther = drawn first)
-	std::sort(instances.begin(), instances.end(),
-		[](const FlowerInstance& a, const FlowerInstance& b) {
-			return a.normPos.y < b.normPos.y;
+	// One full sort for the initial field; afterwards the order is maintained
+	// incrementally as flowers respawn and die
+	std::sort(drawOrder.begin(), drawOrder.end(),
+		[this](uint32_t a, uint32_t b) {
+			return genomes[a].normPos.y < genomes[b].normPos.y;
 		});
 }
 
-void FlowerField::update(float volume, float pitch, float confidence, float fullness, float bass) {
-	// Smooth inputs (lower alpha = smoother, less jitter)
-	float volAlpha = 0.08f;
-	float fullAlpha = 0.10f;
-	float pitchAlpha = 0.12f;
+// Callers check freeHandles first: the pool never grows after setup()
+size_t FlowerField::addFlower() {
+	uint32_t h = freeHandles.back();
+	freeHandles.pop_back();
 
-	smoothedVolume = smoothedVolume * (1.0f - volAlpha) + ofClamp(volume * 5.0f, 0.0f, 1.0f) * volAlpha;
-	smoothedFullness = smoothedFullness * (1.0f - fullAlpha) + fullness * fullAlpha;
+	size_t slot = state.size();
+	state.push(h);
+	slotOfHandle[h] = (uint32_t)slot;
+	return slot;
+}
+
+void FlowerField::removeFlower(size_t slot) {
+	uint32_t h = state.handle[slot];
+	eraseDrawOrder(h);
+	grid.remove(h);
+	slotOfHandle[h] = kNoSlot;
+	freeHandles.push_back(h);
+
+	state.swapRemove(slot);
+	if (slot < state.size()) slotOfHandle[state.handle[slot]] = (uint32_t)slot;
+}
+
+// drawOrder stays sorted back to front (lower y = farther = drawn first).
+// Binary search finds the spot; the shift is a memmove of 4-byte handles.
+void FlowerField::insertDrawOrder(uint32_t h) {
+	ScopedTimer timer(ProfileStage::FIELD_ORDER);
+	float y = genomes[h].normPos.y;
+	auto it = std::upper_bound(drawOrder.begin(), drawOrder.end(), y,
+		[this](float v, uint32_t other) { return v < genomes[other].normPos.y; });
+	drawOrder.insert(it, h);
+}
+
+// Must run before the genome's position changes
+void FlowerField::eraseDrawOrder(uint32_t h) {
+	ScopedTimer timer(ProfileStage::FIELD_ORDER);
+	float y = genomes[h].normPos.y;
+	auto it = std::lower_bound(drawOrder.begin(), drawOrder.end(), y,
+		[this](uint32_t other, float v) { return genomes[other].normPos.y < v; });
+	while (it != drawOrder.end() && *it != h) ++it;
+	if (it != drawOrder.end()) drawOrder.erase(it);
+}
+
+void FlowerField::streamHotState(size_t begin, size_t end, const FrameState& frame) {
+	state.snapshot(begin, end);
+
+	float* life = state.lifePhase.data();
+	const float* speedMult = state.lifeSpeedMult.data();
+	for (size_t i = begin; i < end; i++) {
+		life[i] += frame.lifeStep * speedMult[i];
+	}
+
+	// Beat-driven rotation: flip direction on onset, speed scaled by volume.
+	// Non-rotating flowers have speed 0, so the accumulate needs no branch.
+	float* rotDir = state.rotationDir.data();
+	if (frame.beatThisFrame) {
+		for (size_t i = begin; i < end; i++) {
+			if (state.rotationSpeed[i] > 0.0f && state.rng[i].uniform() > 0.3f) {
+				rotDir[i] = -rotDir[i];
+			}
+		}
+	}
+	float rotStep = (0.3f + frame.volume * 0.7f) * frame.dt;
+	float* rotAccum = state.rotationAccum.data();
+	const float* rotSpeed = state.rotationSpeed.data();
+	for (size_t i = begin; i < end; i++) {
+		rotAccum[i] += rotSpeed[i] * rotDir[i] * rotStep;
+	}
+
+	float* ripple = state.ripple.data();
+	for (size_t i = begin; i < end; i++) {
+		ripple[i] *= frame.rippleDecay;
+	}
+}
+
+FlowerField::FlowerPose FlowerField::poseFor(const FlowerGenome& g, float phase, bool fastDeath,
+                                             float fastDeathTimer, float volume, float pitchNorm) {
+	FlowerPose p;
+	p.pointiness = g.pointiness;
+	p.visiblePetals = g.petalCount;
+
+	// --- Phase: Growing (0.00 - 0.15) ---
+	if (phase < 0.15f) {
+		float t = phase / 0.15f;
+		p.scale = t * t;       // ease-in growth
+		p.stemScale = t;
+		p.alpha = t;
+	}
+	// --- Phase: Blooming (0.15 - 0.60) ---
+	else if (phase < 0.60f) {
+		// Full music reactivity
+		p.volumePulse = 1.0f + volume * 0.9f;
+		float pointinessMod = g.pitchDirection * pitchNorm * 0.35f;
+		p.pointiness = ofClamp(g.pointiness + pointinessMod, 0.0f, 1.0f);
+	}
+	// --- Phase: Losing petals (0.60 - 0.80) ---
+	else if (phase < 0.80f) {
+		float t = (phase - 0.60f) / 0.20f;
+		p.visiblePetals = std::max(0, (int)std::round(g.petalCount * (1.0f - t)));
+		p.scale = 1.0f - t * 0.3f;
+		// Fading music reactivity
+		float reactivity = 1.0f - t;
+		p.volumePulse = 1.0f + volume * 0.9f * reactivity;
+		float pointinessMod = g.pitchDirection * pitchNorm * 0.35f * reactivity;
+		p.pointiness = ofClamp(g.pointiness + pointinessMod, 0.0f, 1.0f);
+	}
+	// --- Phase: Wilting (0.80 - 0.95) ---
+	else if (phase < 0.95f) {
+		float t = (phase - 0.80f) / 0.15f;
+		p.visiblePetals = 0;
+		p.scale = (1.0f - t) * 0.7f;
+		p.stemScale = 1.0f - t * 0.6f;
+		p.stemCurveMod = t * 1.5f;
+		p.alpha = 1.0f - t * 0.6f;
+	}
+	// --- Phase: Dead / fade out (0.95 - 1.0) ---
+	else {
+		float t = ofClamp((phase - 0.95f) / 0.05f, 0.0f, 1.0f);
+		p.visiblePetals = 0;
+		p.scale = 0.01f;
+		p.stemScale = 0.4f * (1.0f - t);
+		p.stemCurveMod = 1.5f;
+		p.alpha = (1.0f - t) * 0.4f;
+	}
+
+	// Fast death override: all petals burst off, stem collapses rapidly
+	if (fastDeath) {
+		float fd = std::min(fastDeathTimer, 1.0f);
+		p.visiblePetals = 0;                         // all petals pop off on the first tick
+		p.scale = std::max(0.01f, (1.0f - fd) * 0.7f);
+		p.stemScale = 1.0f - fd * 0.7f;
+		p.stemCurveMod = fd * 3.0f;                  // dramatic droop
+		p.alpha = 1.0f - fd * fd;                    // ease-out fade
+	}
+	p.alpha = ofClamp(p.alpha, 0.0f, 1.0f);
+	return p;
+}
+
+void FlowerField::stepInstance(size_t slot, const FrameState& frame,
+                               std::vector<PetalSpawn>& spawns) {
+	if (state.fastDeath[slot]) {
+		state.fastDeathTimer[slot] += frame.dt * 1.5f;  // ~0.67s total animation
+		if (state.fastDeathTimer[slot] >= 1.0f) {
+			state.currentAlpha[slot] = 0.0f;
+			state.lifePhase[slot] = 999.0f;  // mark for removal
+			return;
+		}
+	}
+
+	const FlowerGenome& g = genomes[state.handle[slot]];
+	FlowerPose p = poseFor(g, state.lifePhase[slot], state.fastDeath[slot],
+		state.fastDeathTimer[slot], frame.volume, frame.pitchNorm);
+
+	// Detect petal drops and spawn falling petals. The head was last posed
+	// at the previous draw, which is close enough for launch positions.
+	if (state.lastVisiblePetals[slot] >= 0 && p.visiblePetals < state.lastVisiblePetals[slot]) {
+		Flower& flower = flowers[state.handle[slot]];
+		int dropped = state.lastVisiblePetals[slot] - p.visiblePetals;
+		float screenX = g.normPos.x * frame.width;
+		float screenY = g.normPos.y * frame.height;
+		glm::vec2 stemTop = flower.getStem().getTopPosition();
+		glm::vec2 headPos(screenX + stemTop.x, screenY + stemTop.y);
+
+		const InflorescenceParams& currentIp = flower.getInflorescence().getParams();
+
+		// All petals dropped this tick share one shape; only its key travels
+		PetalParams detachedShape;
+		detachedShape.width = g.width;
+		detachedShape.tipPointiness = p.pointiness;
+		detachedShape.bulgePosition = g.bulge;
+		detachedShape.edgeCurvature = g.edgeCurvature;
+		uint32_t shapeKey = PetalMeshCache::keyFor(detachedShape);
+		float length = g.length * g.depthScale * p.scale * p.volumePulse;
+
+		for (int d = 0; d < dropped; d++) {
+			int petalIdx = state.lastVisiblePetals[slot] - 1 - d;
+
+			PetalPosition pp = computePetalPosition(
+				g.headType, petalIdx, g.petalCount, currentIp);
+
+			// Offset spawn by radial distance (for phyllotaxis spiral)
+			float rad = ofDegToRad(pp.angleDeg);
+			float rScaled = pp.radiusFromCenter * g.depthScale * p.scale;
+			glm::vec2 spawnPos = headPos + glm::vec2(
+				rScaled * std::sin(rad),
+				-rScaled * std::cos(rad));
+
+			spawns.push_back({spawnPos, pp.angleDeg, shapeKey, length, g.petalColor,
+				((uint64_t)slot << 32) | spawns.size(), state.rng[slot].fork()});
+		}
+	}
+	state.lastVisiblePetals[slot] = p.visiblePetals;
+}
+
+void FlowerField::poseInstance(size_t slot, float blend, const FrameState& frame) {
+	const FlowerGenome& g = genomes[state.handle[slot]];
+	Flower& flower = flowers[state.handle[slot]];
+
+	// Between the previous and the latest tick
+	float phase = ofLerp(state.prevLifePhase[slot], state.lifePhase[slot], blend);
+	float fastDeathTimer = ofLerp(state.prevFastDeathTimer[slot], state.fastDeathTimer[slot], blend);
+	float rotation = ofLerp(state.prevRotationAccum[slot], state.rotationAccum[slot], blend);
+	FlowerPose p = poseFor(g, phase, state.fastDeath[slot], fastDeathTimer, frame.volume, frame.pitchNorm);
+	state.currentAlpha[slot] = p.alpha;
+
+	// Update inflorescence params
+	InflorescenceParams ip;
+	ip.headType = g.headType;
+	ip.petal.count = p.visiblePetals;
+	float swell = 1.0f + kRippleSwell * state.ripple[slot];
+	ip.petal.length = g.length * g.depthScale * p.scale * p.volumePulse * swell;
+	ip.petal.width = g.width;
+	ip.petal.tipPointiness = p.pointiness;
+	ip.petal.bulgePosition = g.bulge;
+	ip.petal.edgeCurvature = g.edgeCurvature;
+	ip.centerRadius = g.centerRadius * g.depthScale * std::max(p.scale, 0.1f);
+	ip.rotation = rotation;
+	unsigned char a = (unsigned char)(p.alpha * 255.0f);
+	ip.petalColor = ofColor(g.petalColor, a);
+	ip.centerColor = ofColor(g.centerColor, a);
+	ip.centerType = g.centerType;
+	ip.centerDetail = g.centerDetail;
+	ip.phyllotaxis = g.phyllotaxis;
+	ip.roseCurve = g.roseCurve;
+	ip.superformula = g.superformula;
+	ip.whorls = g.whorls;
+	ip.noise = g.noise;
+	flower.getInflorescence().setParams(ip);
+
+	// Update stem params
+	StemParams sp;
+	sp.height = g.stemHeight * g.depthScale * p.stemScale;
+	sp.thickness = ofLerp(1.5f, 4.0f, g.depthScale);
+	sp.taperRatio = g.taperRatio;
+	sp.curvature = ofClamp(g.stemCurvature + p.stemCurveMod, -2.0f, 2.0f);
+	sp.color = ofColor(g.stemColor, a);
+	sp.segments = g.segments;
+	sp.nodeWidth = g.nodeWidth;
+	flower.getStem().setParams(sp);
+}
+
+void FlowerField::update(const AudioFeatures& features, float frameDt) {
+	// A long hitch is dropped rather than replayed
+	runTicks(features, ofClamp(frameDt, 0.0f, kMaxFrameTime));
+}
+
+void FlowerField::advance(const AudioFeatures& features, float frameDt) {
+	runTicks(features, std::max(frameDt, 0.0f));
+}
+
+void FlowerField::runTicks(const AudioFeatures& features, float elapsed) {
+	// Whole ticks of simulation for the time that passed
+	tickAccumulator += elapsed;
+	while (tickAccumulator >= tickDt) {
+		tick(features, tickDt);
+		tickAccumulator -= tickDt;
+	}
+
+	// Draw from a pose between the last two ticks
+	float blend = ofClamp(tickAccumulator / tickDt, 0.0f, 1.0f);
+	pose(blend);
+
+	Profiler::shared().setCount(ProfileCounter::INSTANCES, (int64_t)state.size());
+	Profiler::shared().setCount(ProfileCounter::FALLING_PETALS, fallingPetals.activeCount());
+}
+
+void FlowerField::tick(const AudioFeatures& features, float dt) {
+	float volume = features.rms;
+	float pitch = features.pitch;
+	float confidence = features.confidence;
+	float fullness = features.fullness;
+
+	// Audio clock between analysis frames: advance by ticks from the newest one
+	if (features.sequence != lastFeatureSequence) {
+		lastFeatureSequence = features.sequence;
+		audioClock = features.time;
+	} else {
+		audioClock += dt;
+	}
+
+	// Smooth inputs
+	smoothedVolume += (ofClamp(volume * 5.0f, 0.0f, 1.0f) - smoothedVolume) * emaAlpha(dt, kVolumeTau);
+	smoothedFullness += (fullness - smoothedFullness) * emaAlpha(dt, kFullnessTau);
 	if (confidence > 0.1f && pitch > 50.0f) {
-		smoothedPitch = smoothedPitch * (1.0f - pitchAlpha) + pitch * pitchAlpha;
+		smoothedPitch += (pitch - smoothedPitch) * emaAlpha(dt, kPitchTau);
 	}
 
 	// Normalize pitch to [-1, 1] centered at ~middle C (261 Hz)
@@ -883,9 +1950,11 @@ void FlowerField::update(float volume, float pitch, float confidence, float full
 		pitchNorm = ofClamp((logP - logCenter) / (logRange * 0.5f), -1.0f, 1.0f);
 	}
 
+	// Petal noise follows simulation time (sampled at the pose)
+	noiseClock += dt;
+
 	// Lifecycle speed: fullness controls how fast the cycle runs
 	// ~18s full cycle at fullness=1, slower when quiet, never fully stopped
-	float dt = ofClamp(ofGetLastFrameTime(), 0.001f, 0.1f);
 	float baseSpeed = 1.0f / 18.0f;
 	float speed = baseSpeed * (0.05f + smoothedFullness * 0.95f);
 
@@ -896,300 +1965,954 @@ void FlowerField::update(float volume, float pitch, float confidence, float full
 		speed *= (1.0f + varFactor * activityLevel * 1.5f);
 	}
 	// When returning to normal mode with too many flowers, gently accelerate lifecycle
-	else if ((int)instances.size() > baseCount) {
-		float overshoot = (float)instances.size() / (float)baseCount;
+	else if ((int)state.size() > baseCount) {
+		float overshoot = (float)state.size() / (float)baseCount;
 		speed *= (1.0f + (overshoot - 1.0f) * 2.0f);
 	}
 
-	// Beat/onset detection: bass energy spike vs slow baseline
-	// Fast tracker follows bass transients closely; slow tracks the average level
-	float fastBassAlpha = 0.35f;   // reacts quickly to bass hits
-	float slowBassAlpha = 0.005f;  // very slow baseline (~3-4 second average)
-	fastBass = fastBass * (1.0f - fastBassAlpha) + bass * fastBassAlpha;
-	slowBass = slowBass * (1.0f - slowBassAlpha) + bass * slowBassAlpha;
 	// Keep slowVolume for activity score
-	slowVolume = slowVolume * 0.98f + smoothedVolume * 0.02f;
-	beatCooldown -= dt;
-	elapsedTime += dt;
+	slowVolume += (smoothedVolume - slowVolume) * emaAlpha(dt, kSlowVolumeTau);
 
+	// Onsets and tempo come from the analysis thread. Every onset since the
+	// last tick goes into the history; the visual reaction fires on the
+	// predicted beat when the tempo tracker is locked, otherwise on the onset,
+	// and an onset right after a predicted beat does not fire twice. The
+	// look-ahead moves predicted beats earlier by the measured pipeline delay.
 	bool beatThisFrame = false;
-	if (beatCooldown <= 0.0f && fastBass > 0.001f) {
-		float ratio = (slowBass > 0.0005f) ? fastBass / slowBass : 0.0f;
-		if (ratio > 1.6f) {
+	uint64_t newBeats = std::min<uint64_t>(features.beatCount - lastBeatCount, AudioFeatures::kRecentBeats);
+	for (uint64_t n = features.beatCount - newBeats; n < features.beatCount; n++) {
+		double t = features.recentBeats[n % AudioFeatures::kRecentBeats];
+		beatHistory.push_back(t);
+		if (t - lastFiredBeat > kBeatMergeWindow) {
 			beatThisFrame = true;
-			beatCooldown = 0.20f;  // 200ms cooldown between beats
-			beatHistory.push_back(elapsedTime);
+			lastFiredBeat = t;
 		}
 	}
+	lastBeatCount = features.beatCount;
+
+	if (features.tempoConfidence > kBeatLockConfidence && features.nextBeatTime > 0.0
+	    && features.nextBeatTime - lastFiredBeat > kBeatMergeWindow
+	    && audioClock + dt + beatLookahead >= features.nextBeatTime) {
+		beatThisFrame = true;
+		lastFiredBeat = features.nextBeatTime;
+	}
 
 	// Purge beat history older than 5 seconds
-	while (!beatHistory.empty() && (elapsedTime - beatHistory.front()) > 5.0f) {
+	while (!beatHistory.empty() && (features.time - beatHistory.front()) > 5.0) {
 		beatHistory.pop_front();
 	}
 
-	// Compute activity score (0-1): beat density + volume + fullness
+	// Compute activity score (0-1): beat density + steady pulse + volume + fullness
 	float beatDensity = ofClamp((float)beatHistory.size() / 20.0f, 0.0f, 1.0f);
-	float rawActivity = 0.5f * beatDensity + 0.3f * smoothedVolume + 0.2f * smoothedFullness;
+	float pulse = features.tempoConfidence * ofClamp(features.tempo / 180.0f, 0.0f, 1.0f);
+	float rawActivity = 0.4f * beatDensity + 0.1f * pulse + 0.3f * smoothedVolume + 0.2f * smoothedFullness;
 
 	// Track how much activity is changing (variability)
 	// High = music shifting rapidly, low = steady groove
 	float activityDelta = std::abs(rawActivity - activityLevel);
-	float varAlpha = 0.02f;
-	activityVariability = activityVariability * (1.0f - varAlpha) + activityDelta * varAlpha;
-
-	float actAlpha = 0.03f;
-	activityLevel = activityLevel * (1.0f - actAlpha) + rawActivity * actAlpha;
+	activityVariability += (activityDelta - activityVariability) * emaAlpha(dt, kVariabilityTau);
+	activityLevel += (rawActivity - activityLevel) * emaAlpha(dt, kActivityTau);
 
 	// Dynamic flower count management
-	bool needsSort = false;
 	int targetCount = baseCount;
 	if (reactiveMode) {
-		targetCount = (int)ofLerp(30.0f, 800.0f, activityLevel);
+		targetCount = (int)ofLerp((float)scaling.reactiveMin, (float)scaling.reactiveMax, activityLevel);
 	}
+	targetCount = std::min(targetCount, (int)genomes.size());
+	if (scaling.countLimit > 0) targetCount = std::min(targetCount, scaling.countLimit);
+
+	int currentCount = (int)state.size();
 
-	int currentCount = (int)instances.size();
- 
 	// Growing: spawn new flowers (batched to avoid frame spikes)
 	if (currentCount < targetCount) {
-		int toSpawn = std::min(targetCount - currentCount, 10);
+		ScopedTimer timer(ProfileStage::FIELD_SPAWNS);
+		int toSpawn = std::min(targetCount - currentCount, std::max(scaling.spawnsPerTick, 1));
 		for (int i = 0; i < toSpawn; i++) {
-			FlowerInstance fi;
-			respawnFlower(fi);
-			fi.lifePhase = 0.0f;
-			instances.push_back(std::move(fi));
+			size_t slot = addFlower();
+			respawnFlower(slot);
+			insertDrawOrder(state.handle[slot]);
 		}
-		needsSort = true;
 	}
 	// Shrinking: randomly mark flowers for dramatic fast death across the field
 	else if (currentCount > targetCount + 5) {
-		int toMark = std::min(currentCount - targetCount, 5);
+		int toMark = std::min(currentCount - targetCount, std::max(scaling.deathMarksPerTick, 1));
 		for (int i = 0; i < toMark; i++) {
 			// Try a few random picks to find an eligible flower
 			for (int attempt = 0; attempt < 5; attempt++) {
-				int idx = (int)ofRandom(0, instances.size());
-				auto& candidate = instances[idx];
+				size_t idx = (size_t)fieldRng.range(0, (int)state.size());
 				// Only mark flowers that are alive, visible, and not already dying
-				if (!candidate.fastDeath && candidate.lifePhase > 0.15f
-				    && candidate.lifePhase < 0.80f) {
-					candidate.fastDeath = true;
-					candidate.fastDeathTimer = 0.0f;
+				if (!state.fastDeath[idx] && state.lifePhase[idx] > 0.15f
+				    && state.lifePhase[idx] < 0.80f) {
+					state.fastDeath[idx] = 1;
+					state.fastDeathTimer[idx] = 0.0f;
 					break;
 				}
 			}
 		}
 	}
 
-	for (auto& fi : instances) {
-		// Advance lifecycle
-		fi.lifePhase += speed * fi.lifeSpeedMult * dt;
+	// Per-flower work is independent, so it runs across the worker pool.
+	// Respawns (each takes the next spawn stream, RngStream(rngSeed,
+	// ++spawnCounter), and advances color cycling) and falling-petal spawns
+	// are collected per thread and applied serially afterwards.
+	FrameState frame;
+	frame.dt = dt;
+	frame.lifeStep = speed * dt;
+	frame.pitchNorm = pitchNorm;
+	frame.volume = smoothedVolume;
+	frame.beatThisFrame = beatThisFrame;
+	frame.overTarget = (int)state.size() > targetCount;
+	glm::vec2 size = getCanvasSize();
+	frame.width = size.x;
+	frame.height = size.y;
+	frame.rippleDecay = std::exp(-dt / kRippleTau);
+	prevTick = lastTick;
+	lastTick = frame;
+
+	if (ripplesEnabled) {
+		if (beatThisFrame) spawnRipple(0.5f + smoothedVolume);
+		advanceRipples(dt, frame.width / std::max(frame.height, 1.0f));
+	}
 
-		if (fi.lifePhase >= 1.0f) {
-			// If over target count, mark for removal instead of respawning
-			if ((int)instances.size() > targetCount) {
-				fi.lifePhase = 999.0f;  // sentinel for removal
-				continue;
+	int slots = pool ? pool->size() : 1;
+	if ((int)threadScratch.size() < slots) threadScratch.resize(slots);
+	for (auto& scratch : threadScratch) {
+		scratch.spawns.clear();
+		scratch.respawns.clear();
+	}
+
+	auto updateRange = [&](size_t begin, size_t end, int slot) {
+		ThreadScratch& scratch = threadScratch[slot];
+		streamHotState(begin, end, frame);
+		for (size_t i = begin; i < end; i++) {
+			float& life = state.lifePhase[i];
+			if (life < 1.0f) {
+				stepInstance(i, frame, scratch.spawns);
+			} else if (life < 2.0f) {
+				// If over target count, mark for removal instead of respawning
+				if (frame.overTarget) {
+					life = 999.0f;  // sentinel for removal
+				} else {
+					scratch.respawns.push_back(i);
+				}
 			}
-			respawnFlower(fi);
-			fi.lifePhase = 0.0f;
-			needsSort = true;
 		}
+	};
+	{
+		ScopedTimer timer(ProfileStage::FIELD_LIFECYCLE);
+		if (pool && parallelUpdate) {
+			pool->parallelFor(state.size(), kUpdateGrain, updateRange);
+		} else {
+			updateRange(0, state.size(), 0);
+		}
+	}
+
+	// Merged in slot order rather than thread order, so spawn streams are
+	// handed out and the petal pool fills the same way whatever the worker timing
+	ScopedTimer spawnTimer(ProfileStage::FIELD_SPAWNS);
+	spawnMerge.clear();
+	respawnMerge.clear();
+	for (const auto& scratch : threadScratch) {
+		spawnMerge.insert(spawnMerge.end(), scratch.spawns.begin(), scratch.spawns.end());
+		respawnMerge.insert(respawnMerge.end(), scratch.respawns.begin(), scratch.respawns.end());
+	}
+	std::sort(spawnMerge.begin(), spawnMerge.end(),
+		[](const PetalSpawn& a, const PetalSpawn& b) { return a.order < b.order; });
+	std::sort(respawnMerge.begin(), respawnMerge.end());
+
+	for (size_t idx : respawnMerge) {
+		// Respawning moves the flower to a new y, so re-place its handle
+		eraseDrawOrder(state.handle[idx]);
+		respawnFlower(idx);
+		insertDrawOrder(state.handle[idx]);
+		stepInstance(idx, frame, spawnMerge);
+	}
+	for (const auto& ps : spawnMerge) {
+		fallingPetals.spawn(ps.position, ps.angleDeg, ps.shapeKey, ps.length, ps.color, ps.rng);
+	}
 
-		float phase = fi.lifePhase;
-
-		// Lifecycle phase outputs
-		float scale = 1.0f;         // flower head scale
-		float stemScale = 1.0f;     // stem height scale
-		float stemCurveMod = 0.0f;  // additional bend during wilt
-		float alpha = 1.0f;
-		float volumePulse = 1.0f;
-		float currentPointiness = fi.basePointiness;
-		int visiblePetals = fi.basePetalCount;
-
-		// --- Phase: Growing (0.00 - 0.15) ---
-		if (phase < 0.15f) {
-			float t = phase / 0.15f;
-			scale = t * t;       // ease-in growth
-			stemScale = t;
-			alpha = t;
+	// Remove flowers marked for death (sentinel lifePhase)
+	{
+		ScopedTimer timer(ProfileStage::FIELD_ERASE);
+		for (size_t i = state.size(); i-- > 0;) {
+			if (state.lifePhase[i] >= 2.0f) removeFlower(i);
 		}
-		// --- Phase: Blooming (0.15 - 0.60) ---
-		else if (phase < 0.60f) {
-			// Full music reactivity
-			volumePulse = 1.0f + smoothedVolume * 0.9f;
-			float pointinessMod = fi.pitchDirection * pitchNorm * 0.35f;
-			currentPointiness = ofClamp(fi.basePointiness + pointinessMod, 0.0f, 1.0f);
+	}
+
+	// Update falling petals
+	fallingPetals.setFloor(frame.height);
+	fallingPetals.update(dt);
+}
+
+void FlowerField::pose(float blend) {
+	// Frame-level inputs and the petal noise clock follow the same blend
+	FrameState frame = lastTick;
+	frame.volume = ofLerp(prevTick.volume, lastTick.volume, blend);
+	frame.pitchNorm = ofLerp(prevTick.pitchNorm, lastTick.pitchNorm, blend);
+	float lag = (1.0f - blend) * tickDt;
+	NoiseTable::shared().setTime(noiseClock - lag);
+	fallingPetals.setDrawLag(lag);
+
+	auto poseRange = [&](size_t begin, size_t end, int) {
+		for (size_t i = begin; i < end; i++) poseInstance(i, blend, frame);
+	};
+	ScopedTimer timer(ProfileStage::FIELD_LIFECYCLE);
+	if (pool && parallelUpdate) {
+		pool->parallelFor(state.size(), kUpdateGrain, poseRange);
+	} else {
+		poseRange(0, state.size(), 0);
+	}
+}
+
+// A new ripple takes the place of the weakest one when all are running
+void FlowerField::spawnRipple(float strength) {
+	if (state.size() == 0) return;
+	int idx = numRipples;
+	if (numRipples < kMaxRipples) {
+		numRipples++;
+	} else {
+		idx = 0;
+		for (int r = 1; r < numRipples; r++) {
+			if (ripples[r].strength < ripples[idx].strength) idx = r;
 		}
-		// --- Phase: Losing petals (0.60 - 0.80) ---
-		else if (phase < 0.80f) {
-			float t = (phase - 0.60f) / 0.20f;
-			visiblePetals = std::max(0, (int)std::round(fi.basePetalCount * (1.0f - t)));
-			scale = 1.0f - t * 0.3f;
-			// Fading music reactivity
-			float reactivity = 1.0f - t;
-			volumePulse = 1.0f + smoothedVolume * 0.9f * reactivity;
-			float pointinessMod = fi.pitchDirection * pitchNorm * 0.35f * reactivity;
-			currentPointiness = ofClamp(fi.basePointiness + pointinessMod, 0.0f, 1.0f);
+	}
+	size_t slot = (size_t)fieldRng.range(0, (int)state.size());
+	ripples[idx].origin = genomes[state.handle[slot]].normPos;
+	ripples[idx].radius = 0.0f;
+	ripples[idx].strength = strength;
+}
+
+// Each front only visits the grid cells it crosses this tick, so a ripple
+// costs the flowers it reaches rather than a pass over the field
+void FlowerField::advanceRipples(float dt, float aspect) {
+	float step = kRippleSpeed * dt;
+	for (int r = 0; r < numRipples;) {
+		Ripple& rp = ripples[r];
+		float r0 = rp.radius;
+		float r1 = r0 + step;
+		float hit = rp.strength * std::exp(-kRippleFalloff * r1);
+		glm::vec2 c = rp.origin;
+		grid.queryRing(c, aspect, r0, r1, [&](uint32_t hnd) {
+			const glm::vec2& q = genomes[hnd].normPos;
+			float dx = (q.x - c.x) * aspect;
+			float dy = q.y - c.y;
+			float d2 = dx * dx + dy * dy;
+			if (d2 < r0 * r0 || d2 >= r1 * r1) return;
+			float& swell = state.ripple[slotOfHandle[hnd]];
+			swell = std::max(swell, std::min(hit, 1.0f));
+		});
+		rp.radius = r1;
+
+		// Gone once it has left the field or faded out
+		if (r1 > aspect + 1.0f || hit < 0.02f) {
+			ripples[r] = ripples[--numRipples];
+		} else {
+			r++;
 		}
-		// --- Phase: Wilting (0.80 - 0.95) ---
-		else if (phase < 0.95f) {
-			float t = (phase - 0.80f) / 0.15f;
-			visiblePetals = 0;
-			scale = (1.0f - t) * 0.7f;
-			stemScale = 1.0f - t * 0.6f;
-			stemCurveMod = t * 1.5f;
-			alpha = 1.0f - t * 0.6f;
+	}
+}
+
+void FlowerField::setTickRate(float hz) {
+	tickDt = 1.0f / ofClamp(hz, 15.0f, 1000.0f);
+}
+
+float FlowerField::getTickRate() const {
+	return 1.0f / tickDt;
+}
+
+void FlowerField::setCapacity(int maxFlowers) {
+	capacity = std::max(maxFlowers, 1);
+}
+
+int FlowerField::getCapacity() const {
+	return capacity;
+}
+
+void FlowerField::setScaling(const FieldScaling& s) {
+	scaling = s;
+	scaling.reactiveMin = std::max(scaling.reactiveMin, 0);
+	scaling.reactiveMax = std::max(scaling.reactiveMax, scaling.reactiveMin);
+}
+
+const FieldScaling& FlowerField::getScaling() const {
+	return scaling;
+}
+
+void FlowerField::setBaseCount(int count) {
+	baseCount = std::max(count, 1);
+}
+
+int FlowerField::getBaseCount() const {
+	return baseCount;
+}
+
+int FlowerField::getFlowerCount() const {
+	return (int)state.size();
+}
+
+void FlowerField::setRenderMode(FieldRenderMode mode) {
+	renderMode = mode;
+	fallingPetals.setGpuSimulation(mode == FieldRenderMode::INSTANCED);
+}
+
+FieldRenderMode FlowerField::getRenderMode() const {
+	return renderMode;
+}
+
+void FlowerField::setLodSettings(const LodSettings& settings) {
+	lod = settings;
+}
+
+const LodSettings& FlowerField::getLodSettings() const {
+	return lod;
+}
+
+LodTier FlowerField::headLodFor(uint32_t h) {
+	if (!lod.enabled) return LodTier::FULL;
+	float px = flowers[h].getInflorescence().getRadius() * lod.pixelScale / lod.thresholdScale;
+	if (px < lod.impostorHeadPx) return LodTier::IMPOSTOR;
+	if (lod.spriteAtlas && renderMode == FieldRenderMode::INSTANCED && px < lod.spriteHeadPx) {
+		return LodTier::SPRITE;
+	}
+	if (px < lod.simpleHeadPx) return LodTier::SIMPLE;
+	return LodTier::FULL;
+}
+
+bool FlowerField::tendrilsFor(uint32_t h) {
+	if (!lod.enabled) return true;
+	float px = flowers[h].getStem().getParams().height * lod.pixelScale / lod.thresholdScale;
+	return px >= lod.tendrilStemPx;
+}
+
+void FlowerField::setCanvasSize(float width, float height) {
+	canvas = glm::vec2(std::max(width, 0.0f), std::max(height, 0.0f));
+}
+
+glm::vec2 FlowerField::getCanvasSize() const {
+	if (canvas.x > 0.0f && canvas.y > 0.0f) return canvas;
+	return glm::vec2(ofGetWidth(), ofGetHeight());
+}
+
+void FlowerField::setViewRegion(const ofRectangle& normalized) {
+	viewRegion = normalized;
+}
+
+const ofRectangle& FlowerField::getViewRegion() const {
+	return viewRegion;
+}
+
+void FlowerField::setRipples(bool enabled) {
+	ripplesEnabled = enabled;
+	if (!enabled) numRipples = 0;
+}
+
+bool FlowerField::getRipples() const {
+	return ripplesEnabled;
+}
+
+const SpatialGrid& FlowerField::getSpatialGrid() const {
+	return grid;
+}
+
+// The grid narrows the field to flowers whose base lies within reach of the
+// region; each of those is then tested with its posed extent
+void FlowerField::cullToView() {
+	for (uint32_t hnd : inViewList) inView[hnd] = 0;
+	inViewList.clear();
+	cullActive = viewRegion.x > 0.0f || viewRegion.y > 0.0f
+		|| viewRegion.getRight() < 1.0f || viewRegion.getBottom() < 1.0f;
+	if (!cullActive) return;
+
+	glm::vec2 size = getCanvasSize();
+	float w = size.x;
+	float h = size.y;
+	ofRectangle view = viewRect();
+	float mx = kMaxFlowerReachPx / std::max(w, 1.0f);
+	float my = kMaxFlowerReachPx / std::max(h, 1.0f);
+	grid.query(viewRegion.x - mx, viewRegion.y - my,
+		viewRegion.getRight() + mx, viewRegion.getBottom() + my, [&](uint32_t hnd) {
+			Flower& flower = flowers[hnd];
+			const StemParams& sp = flower.getStem().getParams();
+			glm::vec2 base(genomes[hnd].normPos.x * w, genomes[hnd].normPos.y * h);
+			glm::vec2 top = base + flower.getStem().getTopPosition();
+			// Head radius around the top, plus slack for stem bend and tendrils
+			float pad = flower.getInflorescence().getRadius() + sp.thickness + 0.15f * sp.height;
+			float x0 = std::min(base.x, top.x) - pad;
+			float x1 = std::max(base.x, top.x) + pad;
+			float y0 = std::min(base.y, top.y) - pad;
+			float y1 = std::max(base.y, top.y) + pad;
+			if (x1 < view.getLeft() || x0 > view.getRight()) return;
+			if (y1 < view.getTop() || y0 > view.getBottom()) return;
+			inView[hnd] = 1;
+			inViewList.push_back(hnd);
+		});
+}
+
+ofRectangle FlowerField::viewRect() const {
+	glm::vec2 size = getCanvasSize();
+	return ofRectangle(viewRegion.x * size.x, viewRegion.y * size.y,
+		viewRegion.width * size.x, viewRegion.height * size.y);
+}
+
+// Canvas px of the view region fill the current viewport
+void FlowerField::beginView() {
+	ofRectangle view = viewRect();
+	ofPushView();
+	ofSetupScreenOrtho(view.width, view.height, -1.0f, 1.0f);
+	ofTranslate(-view.x, -view.y);
+}
+
+void FlowerField::draw() {
+	ScopedTimer timer(ProfileStage::FIELD_DRAW);
+	cullToView();
+	if (renderMode == FieldRenderMode::INSTANCED) {
+		drawInstanced();
+	} else {
+		beginView();
+		drawImmediate();
+		ofPopView();
+	}
+
+	// Draw falling petals on top of flowers
+	beginView();
+	fallingPetals.draw();
+	ofPopView();
+}
+
+void FlowerField::drawImmediate() {
+	glm::vec2 size = getCanvasSize();
+	float w = size.x;
+	float h = size.y;
+
+	for (uint32_t hnd : drawOrder) {
+		if (state.currentAlpha[slotOfHandle[hnd]] <= 0.01f || isCulled(hnd)) continue;
+
+		// Lifecycle alpha is baked into the colors in update()
+		const FlowerGenome& g = genomes[hnd];
+		flowers[hnd].draw(g.normPos.x * w, g.normPos.y * h, drawScratch, headLodFor(hnd), tendrilsFor(hnd));
+	}
+}
+
+namespace {
+// Instanced mode replaces painter's order with depth: each flower gets its own
+// slice of [-range, range] (nearer = larger z), split into ranks for the stem,
+// petal layers (back to front) and the center
+const float kFieldDepthRange = 0.9f;
+const int kDepthRanks = 8;
+
+glm::vec4 toVec4(const ofColor& c) {
+	return glm::vec4(c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f);
+}
+
+PetalInstance makePetalInstance(const PetalPlacement& pl, glm::vec2 headPos,
+                                float headRotDeg, float z, const glm::vec4& color) {
+	float headRad = ofDegToRad(headRotDeg);
+	float cr = std::cos(headRad);
+	float sr = std::sin(headRad);
+	float theta = ofDegToRad(headRotDeg + pl.angleDeg);
+	float c = std::cos(theta);
+	float s = std::sin(theta);
+
+	PetalInstance inst;
+	inst.basis = glm::vec4(c * pl.scale.x, s * pl.scale.x, -s * pl.scale.y, c * pl.scale.y);
+	inst.origin = glm::vec4(
+		headPos.x + cr * pl.offset.x - sr * pl.offset.y,
+		headPos.y + sr * pl.offset.x + cr * pl.offset.y,
+		z, 0.0f);
+	inst.color = color;
+	return inst;
+}
+
+PetalInstance makeCenterInstance(glm::vec2 headPos, float headRotDeg, float radius, float z,
+                                 const glm::vec4& color) {
+	float theta = ofDegToRad(headRotDeg);
+	float c = std::cos(theta) * radius;
+	float s = std::sin(theta) * radius;
+
+	PetalInstance inst;
+	inst.basis = glm::vec4(c, s, -s, c);
+	inst.origin = glm::vec4(headPos, z, 0.0f);
+	inst.color = color;
+	return inst;
+}
+}
+
+template <HeadType T>
+void FlowerField::layoutHeads(const std::vector<uint32_t>& drawIndices, float w, float h,
+                              float slot, float rankStep) {
+	for (uint32_t i : drawIndices) {
+		uint32_t hnd = drawOrder[i];
+		float z = -kFieldDepthRange + i * slot;
+		glm::vec2 top = flowers[hnd].getStem().getTopPosition();
+		glm::vec2 headPos(genomes[hnd].normPos.x * w + top.x, genomes[hnd].normPos.y * h + top.y);
+
+		Inflorescence& head = flowers[hnd].getInflorescence();
+		const auto& ip = head.getParams();
+		glm::vec4 color = toVec4(ip.petalColor);
+		head.layoutPetalsAs<T>(drawScratch.placements, tierScratch[i]);
+		for (const auto& pl : drawScratch.placements) {
+			float pz = z + rankStep * std::min(1 + pl.layer, kDepthRanks - 2);
+			petalBatches.add(*pl.mesh, makePetalInstance(pl, headPos, ip.rotation, pz, color));
 		}
-		// --- Phase: Dead / fade out (0.95 - 1.0) ---
-		else {
-			float t = (phase - 0.95f) / 0.05f;
-			visiblePetals = 0;
-			scale = 0.01f;
-			stemScale = 0.4f * (1.0f - t);
-			stemCurveMod = 1.5f;
-			alpha = (1.0f - t) * 0.4f;
+
+		// Centers sit on top of their own petals, in the same batches
+		if (const ofVboMesh* center = head.getCenterMesh(tierScratch[i])) {
+			float cz = z + rankStep * (kDepthRanks - 1);
+			petalBatches.add(*center, makeCenterInstance(headPos, ip.rotation, ip.centerRadius, cz,
+				toVec4(ip.centerColor)));
 		}
+	}
+}
 
-		// Fast death override: all petals burst off, stem collapses rapidly
-		if (fi.fastDeath) {
-			fi.fastDeathTimer += dt * 1.5f;  // ~0.67s total animation
-			if (fi.fastDeathTimer >= 1.0f) {
-				fi.currentAlpha = 0.0f;
-				fi.lifePhase = 999.0f;  // mark for removal
-				continue;
-			}
-			float fd = fi.fastDeathTimer;
-			visiblePetals = 0;                         // all petals pop off on first frame
-			scale = std::max(0.01f, (1.0f - fd) * 0.7f);
-			stemScale = 1.0f - fd * 0.7f;
-			stemCurveMod = fd * 3.0f;                  // dramatic droop
-			alpha = 1.0f - fd * fd;                    // ease-out fade
+void FlowerField::drawInstanced() {
+	if (!batchesInitialized) {
+		petalBatches.setup();
+		batchesInitialized = true;
+	}
+	if (!petalBatches.isReady()) {
+		beginView();
+		drawImmediate();
+		ofPopView();
+		return;
+	}
+
+	// Atlas misses render into the sprite FBO before the field view is set up
+	prepareSprites();
+
+	glm::vec2 size = getCanvasSize();
+	float w = size.x;
+	float h = size.y;
+	float slot = 2.0f * kFieldDepthRange / std::max((int)drawOrder.size(), 1);
+	float rankStep = slot / kDepthRanks;
+
+	beginView();
+	ofEnableDepthTest();
+	glDepthFunc(GL_LEQUAL);
+	glClear(GL_DEPTH_BUFFER_BIT);
+
+	// Opaque stems (one baked strip each, shader kept bound) and sprites, back
+	// to front; translucent stems wait for the blended pass below, and mesh
+	// heads are bucketed by type for the layout pass
+	StemRenderer& stems = StemRenderer::shared();
+	stems.begin();
+	petalBatches.begin();
+	headSprites.begin();
+	for (auto& batch : headBatches) batch.clear();
+	translucentStemScratch.clear();
+	for (size_t i = 0; i < drawOrder.size(); i++) {
+		uint32_t hnd = drawOrder[i];
+		float alpha = state.currentAlpha[slotOfHandle[hnd]];
+		if (alpha <= 0.01f || isCulled(hnd)) continue;
+
+		float z = -kFieldDepthRange + i * slot;
+		float screenX = genomes[hnd].normPos.x * w;
+		float screenY = genomes[hnd].normPos.y * h;
+
+		Stem& stem = flowers[hnd].getStem();
+		if (alpha < 0.999f) {
+			translucentStemScratch.push_back((uint32_t)i);
+		} else {
+			ofPushMatrix();
+			ofTranslate(screenX, screenY, z);
+			stem.draw(drawScratch.strip, tendrilsFor(hnd));
+			ofPopMatrix();
 		}
 
-		fi.currentAlpha = ofClamp(alpha, 0.0f, 1.0f);
+		Inflorescence& head = flowers[hnd].getInflorescence();
+		const auto& ip = head.getParams();
+		if (spriteCellScratch[i] >= 0) {
+			glm::vec2 top = stem.getTopPosition();
+			headSprites.add(spriteCellScratch[i], glm::vec2(screenX + top.x, screenY + top.y),
+				head.getRadius(), ip.rotation, z + rankStep, ip.petalColor, ip.centerColor);
+		} else {
+			headBatches[(int)ip.headType].push_back((uint32_t)i);
+		}
+	}
+	stems.end();
+
+	// Petal and center instances, one type-specialised layout loop per head type
+	layoutHeads<HeadType::RADIAL>(headBatches[(int)HeadType::RADIAL], w, h, slot, rankStep);
+	layoutHeads<HeadType::PHYLLOTAXIS>(headBatches[(int)HeadType::PHYLLOTAXIS], w, h, slot, rankStep);
+	layoutHeads<HeadType::ROSE_CURVE>(headBatches[(int)HeadType::ROSE_CURVE], w, h, slot, rankStep);
+	layoutHeads<HeadType::SUPERFORMULA>(headBatches[(int)HeadType::SUPERFORMULA], w, h, slot, rankStep);
+	layoutHeads<HeadType::LAYERED_WHORLS>(headBatches[(int)HeadType::LAYERED_WHORLS], w, h, slot, rankStep);
+	petalBatches.drawOpaque();
+	headSprites.drawOpaque();
+
+	// Blended pass in painter's order: each translucent stem goes down after
+	// the translucent petals and sprites of every flower behind it
+	bool stemsBound = false;
+	for (uint32_t i : translucentStemScratch) {
+		uint32_t hnd = drawOrder[i];
+		float z = -kFieldDepthRange + i * slot;
+		if (std::min(petalBatches.nextTranslucentDepth(), headSprites.nextTranslucentDepth()) < z) {
+			if (stemsBound) stems.end();
+			stemsBound = false;
+			drawTranslucentHeads(z);
+		}
+		if (!stemsBound) stems.begin();
+		stemsBound = true;
 
-		// Beat-driven rotation: flip direction on onset, speed scaled by volume
-		if (fi.rotationSpeed > 0.0f) {
-			if (beatThisFrame && ofRandom(1.0f) > 0.3f) {
-				fi.rotationDir *= -1.0f;
-			}
-			fi.rotationAccum += fi.rotationSpeed * fi.rotationDir
-			                    * (0.3f + smoothedVolume * 0.7f) * dt;
+		glDepthMask(GL_FALSE);
+		ofPushMatrix();
+		ofTranslate(genomes[hnd].normPos.x * w, genomes[hnd].normPos.y * h, z);
+		flowers[hnd].getStem().draw(drawScratch.strip, tendrilsFor(hnd));
+		ofPopMatrix();
+		glDepthMask(GL_TRUE);
+	}
+	if (stemsBound) stems.end();
+	drawTranslucentHeads(std::numeric_limits<float>::infinity());
+	Profiler::shared().addCount(ProfileCounter::DRAW_CALLS,
+		petalBatches.getDrawCalls() + headSprites.getDrawCalls());
+
+	ofDisableDepthTest();
+	ofPopView();
+}
+
+void FlowerField::drawTranslucentHeads(float maxDepth) {
+	// Merge the two sorted lists: draw whichever is further back up to the
+	// other's next depth. Petals win ties, so each step draws something.
+	for (;;) {
+		float petalZ = petalBatches.nextTranslucentDepth();
+		float spriteZ = headSprites.nextTranslucentDepth();
+		if (std::min(petalZ, spriteZ) >= maxDepth) return;
+		if (petalZ <= spriteZ) {
+			petalBatches.drawTranslucent(std::min(maxDepth, std::nextafter(spriteZ, std::numeric_limits<float>::infinity())));
+		} else {
+			headSprites.drawTranslucent(std::min(maxDepth, petalZ));
 		}
+	}
+}
 
-		// Detect petal drops and spawn falling petals
-		if (fi.lastVisiblePetals >= 0 && visiblePetals < fi.lastVisiblePetals) {
-			int dropped = fi.lastVisiblePetals - visiblePetals;
-			float screenX = fi.normPos.x * ofGetWidth();
-			float screenY = fi.normPos.y * ofGetHeight();
-			glm::vec2 stemTop = fi.flower.getStem().getTopPosition();
-			glm::vec2 headPos(screenX + stemTop.x, screenY + stemTop.y);
-
-			InflorescenceParams currentIp = fi.flower.getInflorescence().getParams();
-
-			for (int d = 0; d < dropped; d++) {
-				int petalIdx = fi.lastVisiblePetals - 1 - d;
-
-				PetalPosition pp = computePetalPosition(
-					fi.baseHeadType, petalIdx, fi.basePetalCount, currentIp);
-
-				PetalParams detachedShape;
-				detachedShape.length = fi.baseLength * fi.depthScale * scale * volumePulse;
-				detachedShape.width = fi.baseWidth;
-				detachedShape.tipPointiness = currentPointiness;
-				detachedShape.bulgePosition = fi.baseBulge;
-				detachedShape.edgeCurvature = fi.baseEdgeCurvature;
-
-				// Offset spawn by radial distance (for phyllotaxis spiral)
-				float rad = ofDegToRad(pp.angleDeg);
-				float rScaled = pp.radiusFromCenter * fi.depthScale * scale;
-				glm::vec2 spawnPos = headPos + glm::vec2(
-					rScaled * std::sin(rad),
-					-rScaled * std::cos(rad));
-
-				fallingPetals.spawn(spawnPos, pp.angleDeg, detachedShape, fi.basePetalColor);
+void FlowerField::prepareSprites() {
+	drawFrame++;
+	tierScratch.resize(drawOrder.size());
+	spriteCellScratch.assign(drawOrder.size(), -1);
+
+	bool atlas = lod.enabled && lod.spriteAtlas;
+	if (atlas && !spritesInitialized) {
+		headSprites.setup();
+		spritesInitialized = true;
+	}
+	atlas = atlas && headSprites.isReady();
+
+	for (size_t i = 0; i < drawOrder.size(); i++) {
+		uint32_t hnd = drawOrder[i];
+		if (state.currentAlpha[slotOfHandle[hnd]] <= 0.01f || isCulled(hnd)) continue;
+
+		LodTier tier = headLodFor(hnd);
+		if (tier == LodTier::SPRITE) {
+			// Atlas off or full this frame: coarse meshes instead
+			Inflorescence& head = flowers[hnd].getInflorescence();
+			bool needsRender = false;
+			int cell = atlas ? headSprites.acquire(head.spriteKey(), drawFrame, needsRender) : -1;
+			if (cell < 0) {
+				tier = LodTier::SIMPLE;
+			} else {
+				spriteCellScratch[i] = cell;
+				if (needsRender) renderSprite(head, cell);
 			}
 		}
-		fi.lastVisiblePetals = visiblePetals;
-
-		// Update inflorescence params
-		InflorescenceParams ip;
-		ip.headType = fi.baseHeadType;
-		ip.petal.count = visiblePetals;
-		ip.petal.length = fi.baseLength * fi.depthScale * scale * volumePulse;
-		ip.petal.width = fi.baseWidth;
-		ip.petal.tipPointiness = currentPointiness;
-		ip.petal.bulgePosition = fi.baseBulge;
-		ip.petal.edgeCurvature = fi.baseEdgeCurvature;
-		ip.centerRadius = fi.baseCenterRadius * fi.depthScale * std::max(scale, 0.1f);
-		ip.rotation = fi.rotationAccum;
-		ip.petalColor = fi.basePetalColor;
-		ip.centerColor = fi.baseCenterColor;
-		ip.centerType = fi.baseCenterType;
-		ip.centerDetail = fi.baseCenterDetail;
-		ip.phyllotaxis = fi.basePhyllotaxis;
-		ip.roseCurve = fi.baseRoseCurve;
-		ip.superformula = fi.baseSuperformula;
-		ip.whorls = fi.baseWhorls;
-		ip.noise = fi.baseNoise;
-		fi.flower.getInflorescence().setParams(ip);
-
-		// Update stem params
-		StemParams sp;
-		sp.height = fi.baseStemHeight * fi.depthScale * stemScale;
-		sp.thickness = ofLerp(1.5f, 4.0f, fi.depthScale);
-		sp.taperRatio = fi.baseTaperRatio;
-		sp.curvature = ofClamp(fi.baseStemCurvature + stemCurveMod, -2.0f, 2.0f);
-		sp.color = fi.baseStemColor;
-		sp.segments = fi.baseSegments;
-		sp.nodeWidth = fi.baseNodeWidth;
-		fi.flower.getStem().setParams(sp);
+		tierScratch[i] = tier;
 	}
+	headSprites.endRender();
+}
 
-	// Remove flowers marked for death (sentinel lifePhase)
-	instances.erase(
-		std::remove_if(instances.begin(), instances.end(),
-			[](const FlowerInstance& fi) { return fi.lifePhase >= 2.0f; }),
-		instances.end());
+void FlowerField::renderSprite(Inflorescence& head, int cell) {
+	// Unrotated, noise-free head at cell size: red petals, green center
+	InflorescenceParams p = head.getParams();
+	float scale = headSprites.cellRadius() / std::max(head.getRadius(), 1e-3f);
+	p.petal.length *= scale;
+	p.centerRadius *= scale;
+	p.phyllotaxis.spiralSpacing *= scale;
+	p.rotation = 0.0f;
+	p.noise.enabled = false;
+	p.petalColor = ofColor(255, 0, 0);
+	p.centerColor = ofColor(0, 255, 0);
+	spriteHead.setParams(p);
+
+	headSprites.beginRender();
+	headSprites.clearCell(cell);
+	glm::vec2 center = headSprites.cellCenter(cell);
+	ofPushMatrix();
+	ofTranslate(center.x, center.y);
+	spriteHead.draw(drawScratch.placements, LodTier::FULL);
+	ofPopMatrix();
+}
 
-	// Re-sort if any flowers respawned to new y positions
-	if (needsSort) {
-		std::sort(instances.begin(), instances.end(),
-			[](const FlowerInstance& a, const FlowerInstance& b) {
-				return a.normPos.y < b.normPos.y;
-			});
+// ============================================================
+// FlowerField snapshots
+// ============================================================
+
+// Sections are copied as raw bytes, so everything in them must be plain data
+static_assert(std::is_trivially_copyable<FlowerGenome>::value, "FlowerGenome is snapshotted as bytes");
+static_assert(std::is_trivially_copyable<TendrilDef>::value, "TendrilDef is snapshotted as bytes");
+static_assert(std::is_trivially_copyable<FallingPetal>::value, "FallingPetal is snapshotted as bytes");
+static_assert(std::is_trivially_copyable<RngStream>::value, "RngStream is snapshotted as bytes");
+static_assert(std::is_trivially_copyable<SnapshotHeader>::value, "SnapshotHeader is written as bytes");
+
+namespace {
+// FNV-1a over the size and member offsets of everything copied as bytes, so a
+// build whose structs moved rejects a snapshot even when the sizes still match
+struct LayoutHash {
+	uint64_t h = 0xCBF29CE484222325ull;
+	LayoutHash& operator<<(size_t v) {
+		for (int i = 0; i < 8; i++) {
+			h ^= (v >> (i * 8)) & 0xFF;
+			h *= 0x100000001B3ull;
+		}
+		return *this;
 	}
+};
 
-	// Update falling petals
-	fallingPetals.update(dt);
+#define MF_LAYOUT(T, m) offsetof(T, m) << sizeof(T::m)
+
+uint64_t snapshotLayoutHash() {
+	LayoutHash l;
+	l << sizeof(FlowerGenome)
+	  << MF_LAYOUT(FlowerGenome, normPos) << MF_LAYOUT(FlowerGenome, depthScale)
+	  << MF_LAYOUT(FlowerGenome, headType) << MF_LAYOUT(FlowerGenome, phyllotaxis)
+	  << MF_LAYOUT(FlowerGenome, roseCurve) << MF_LAYOUT(FlowerGenome, superformula)
+	  << MF_LAYOUT(FlowerGenome, whorls) << MF_LAYOUT(FlowerGenome, noise)
+	  << MF_LAYOUT(FlowerGenome, centerType) << MF_LAYOUT(FlowerGenome, centerDetail)
+	  << MF_LAYOUT(FlowerGenome, petalCount) << MF_LAYOUT(FlowerGenome, length)
+	  << MF_LAYOUT(FlowerGenome, width) << MF_LAYOUT(FlowerGenome, pointiness)
+	  << MF_LAYOUT(FlowerGenome, bulge) << MF_LAYOUT(FlowerGenome, edgeCurvature)
+	  << MF_LAYOUT(FlowerGenome, centerRadius) << MF_LAYOUT(FlowerGenome, stemHeight)
+	  << MF_LAYOUT(FlowerGenome, stemCurvature) << MF_LAYOUT(FlowerGenome, taperRatio)
+	  << MF_LAYOUT(FlowerGenome, segments) << MF_LAYOUT(FlowerGenome, nodeWidth)
+	  << MF_LAYOUT(FlowerGenome, tendrils) << MF_LAYOUT(FlowerGenome, petalColor)
+	  << MF_LAYOUT(FlowerGenome, centerColor) << MF_LAYOUT(FlowerGenome, stemColor)
+	  << MF_LAYOUT(FlowerGenome, pitchDirection);
+	l << MF_LAYOUT(LayeredWhorlsParams, layerCount) << MF_LAYOUT(LayeredWhorlsParams, petalsPerLayer)
+	  << MF_LAYOUT(LayeredWhorlsParams, lengthFalloff) << MF_LAYOUT(LayeredWhorlsParams, widthGrowth)
+	  << MF_LAYOUT(LayeredWhorlsParams, phaseShift)
+	  << MF_LAYOUT(NoiseModParams, enabled) << MF_LAYOUT(NoiseModParams, seed)
+	  << MF_LAYOUT(NoiseModParams, timeSpeed)
+	  << sizeof(PhyllotaxisParams) << sizeof(RoseCurveParams) << sizeof(SuperformulaParams)
+	  << MF_LAYOUT(TendrilSpan, data) << MF_LAYOUT(TendrilSpan, count);
+	l << sizeof(TendrilDef)
+	  << MF_LAYOUT(TendrilDef, stemT) << MF_LAYOUT(TendrilDef, length)
+	  << MF_LAYOUT(TendrilDef, curlAmount) << MF_LAYOUT(TendrilDef, direction)
+	  << MF_LAYOUT(TendrilDef, startAngle) << MF_LAYOUT(TendrilDef, thickness);
+	l << sizeof(FallingPetal)
+	  << MF_LAYOUT(FallingPetal, origin) << MF_LAYOUT(FallingPetal, velocity)
+	  << MF_LAYOUT(FallingPetal, rotation) << MF_LAYOUT(FallingPetal, rotationSpeed)
+	  << MF_LAYOUT(FallingPetal, waverPhase) << MF_LAYOUT(FallingPetal, waverAmp)
+	  << MF_LAYOUT(FallingPetal, waverFreq) << MF_LAYOUT(FallingPetal, spawnTime)
+	  << MF_LAYOUT(FallingPetal, deathTime) << MF_LAYOUT(FallingPetal, shapeKey)
+	  << MF_LAYOUT(FallingPetal, mesh) << MF_LAYOUT(FallingPetal, length)
+	  << MF_LAYOUT(FallingPetal, color);
+	l << sizeof(SnapshotFieldState)
+	  << MF_LAYOUT(SnapshotFieldState, smoothedVolume) << MF_LAYOUT(SnapshotFieldState, noiseClock)
+	  << MF_LAYOUT(SnapshotFieldState, fallingPetalClock) << MF_LAYOUT(SnapshotFieldState, baseCount)
+	  << MF_LAYOUT(SnapshotFieldState, colorMode) << MF_LAYOUT(SnapshotFieldState, iterateIndex)
+	  << MF_LAYOUT(SnapshotFieldState, reactiveMode) << MF_LAYOUT(SnapshotFieldState, rngSeed)
+	  << MF_LAYOUT(SnapshotFieldState, spawnCounter) << MF_LAYOUT(SnapshotFieldState, fieldRng);
+	l << sizeof(OnsetDetector::TrackerState)
+	  << MF_LAYOUT(OnsetDetector::TrackerState, bandMean) << MF_LAYOUT(OnsetDetector::TrackerState, odfMean)
+	  << MF_LAYOUT(OnsetDetector::TrackerState, periodSeconds) << MF_LAYOUT(OnsetDetector::TrackerState, primed);
+	l << sizeof(RngStream);
+	return l.h;
 }
 
-void FlowerField::draw() {
-	float w = ofGetWidth();
-	float h = ofGetHeight();
+#undef MF_LAYOUT
+
+// Every integer and enum in a genome within what respawnFlower() can roll;
+// these index tables and size layouts, so anything else can't be drawn
+bool genomeInRange(const FlowerGenome& g) {
+	auto within = [](int v, int lo, int hi) { return v >= lo && v <= hi; };
+	if (!within((int)g.headType, 0, kNumHeadTypes - 1)) return false;
+	if (!within((int)g.centerType, 0, kNumCenterTypes - 1)) return false;
+	if (!within(g.petalCount, 4, kMaxPetalsPerHead)) return false;
+	if (!within(g.segments, 1, 4)) return false;
+	if (!within(g.tendrils.count, 0, kMaxTendrilsPerFlower)) return false;
+	if (!within(g.whorls.layerCount, 1, kMaxWhorlLayers)) return false;
+	if (!within(g.whorls.petalsPerLayer, 1, kMaxPetalsPerHead)) return false;
+	if (g.headType == HeadType::LAYERED_WHORLS
+	    && (!within(g.whorls.layerCount, 3, 4) || !within(g.whorls.petalsPerLayer, 5, 8)
+	        || g.petalCount != g.whorls.layerCount * g.whorls.petalsPerLayer)) {
+		return false;
+	}
+	// Sets the centre's element count, so it sizes a cached mesh
+	return g.centerDetail >= 1.0f && g.centerDetail <= 2.5f;
+}
 
-	for (auto& fi : instances) {
-		if (fi.currentAlpha <= 0.01f) continue;
+// Section s if it holds at least n elements of T, else nullptr
+template <class T>
+const T* sectionOf(const FieldSnapshot& snapshot, SnapshotSection s, size_t n) {
+	size_t count = 0;
+	const T* data = snapshot.array<T>(s, count);
+	return (data && count >= n) ? data : nullptr;
+}
+}
 
-		float screenX = fi.normPos.x * w;
-		float screenY = fi.normPos.y * h;
-		unsigned char a = (unsigned char)(fi.currentAlpha * 255.0f);
+void FlowerField::saveSnapshot(SnapshotBuilder& out) const {
+	const size_t n = state.size();
+	out.begin((uint32_t)n);
+	out.add(SnapshotSection::LIFE_PHASE, state.lifePhase.data(), n);
+	out.add(SnapshotSection::LIFE_SPEED, state.lifeSpeedMult.data(), n);
+	out.add(SnapshotSection::ROTATION, state.rotationAccum.data(), n);
+	out.add(SnapshotSection::ROTATION_SPEED, state.rotationSpeed.data(), n);
+	out.add(SnapshotSection::ROTATION_DIR, state.rotationDir.data(), n);
+	out.add(SnapshotSection::FAST_DEATH, state.fastDeath.data(), n);
+	out.add(SnapshotSection::FAST_DEATH_TIMER, state.fastDeathTimer.data(), n);
+	out.add(SnapshotSection::RIPPLE, state.ripple.data(), n);
+	out.add(SnapshotSection::LAST_VISIBLE_PETALS, state.lastVisiblePetals.data(), n);
+	out.add(SnapshotSection::FLOWER_RNG, state.rng.data(), n);
+
+	// Genomes and tendrils live by handle; gather them into slot order so a
+	// restore can hand out handles 0..n-1 and copy each array once
+	std::vector<FlowerGenome> slotGenomes(n);
+	std::vector<TendrilDef> slotTendrils(n * kMaxTendrilsPerFlower);
+	for (size_t i = 0; i < n; i++) {
+		uint32_t h = state.handle[i];
+		slotGenomes[i] = genomes[h];
+		slotGenomes[i].tendrils.data = nullptr;
+		std::copy_n(&tendrilSlab[(size_t)h * kMaxTendrilsPerFlower], kMaxTendrilsPerFlower,
+			&slotTendrils[i * kMaxTendrilsPerFlower]);
+	}
+	out.add(SnapshotSection::GENOMES, slotGenomes.data(), n);
+	out.add(SnapshotSection::TENDRILS, slotTendrils.data(), slotTendrils.size());
+
+	std::vector<FallingPetal> petals;
+	fallingPetals.exportLive(petals);
+	out.add(SnapshotSection::FALLING_PETALS, petals.data(), petals.size());
+
+	std::vector<float> beatAges;
+	beatAges.reserve(beatHistory.size());
+	for (double t : beatHistory) beatAges.push_back((float)(audioClock - t));
+	out.add(SnapshotSection::BEAT_AGES, beatAges.data(), beatAges.size());
+
+	out.header().layoutHash = snapshotLayoutHash();
+	SnapshotFieldState& f = out.header().field;
+	f.smoothedVolume = smoothedVolume;
+	f.smoothedPitch = smoothedPitch;
+	f.smoothedFullness = smoothedFullness;
+	f.slowVolume = slowVolume;
+	f.activityLevel = activityLevel;
+	f.activityVariability = activityVariability;
+	f.noiseClock = noiseClock;
+	f.fallingPetalClock = fallingPetals.getClock();
+	f.baseCount = baseCount;
+	f.colorMode = colorMode;
+	f.iterateIndex = iterateIndex;
+	f.reactiveMode = reactiveMode ? 1 : 0;
+	f.rngSeed = rngSeed;
+	f.spawnCounter = spawnCounter;
+	f.fieldRng = fieldRng;
+}
 
-		// Apply lifecycle alpha to colors
-		auto& ip = fi.flower.getInflorescence().getParams();
-		ofColor pc = fi.basePetalColor;  pc.a = a;
-		ofColor cc = fi.baseCenterColor; cc.a = a;
-		ip.petalColor = pc;
-		ip.centerColor = cc;
-		fi.flower.getInflorescence().setParams(ip);
+bool FlowerField::restoreSnapshot(const FieldSnapshot& snapshot) {
+	if (!snapshot.isOpen() || genomes.empty()) return false;
+	const SnapshotHeader& head = snapshot.header();
+	if (head.layoutHash != snapshotLayoutHash()) {
+		ofLogWarning("FlowerField") << "Snapshot struct layout doesn't match this build; not restored";
+		return false;
+	}
+	const size_t cap = genomes.size();
+	const size_t n = std::min<size_t>(head.flowerCount, cap);
+	const size_t nTendrils = n * kMaxTendrilsPerFlower;
+
+	const float* lifePhase = sectionOf<float>(snapshot, SnapshotSection::LIFE_PHASE, n);
+	const float* lifeSpeed = sectionOf<float>(snapshot, SnapshotSection::LIFE_SPEED, n);
+	const float* rotation = sectionOf<float>(snapshot, SnapshotSection::ROTATION, n);
+	const float* rotationSpeed = sectionOf<float>(snapshot, SnapshotSection::ROTATION_SPEED, n);
+	const float* rotationDir = sectionOf<float>(snapshot, SnapshotSection::ROTATION_DIR, n);
+	const uint8_t* fastDeath = sectionOf<uint8_t>(snapshot, SnapshotSection::FAST_DEATH, n);
+	const float* fastDeathTimer = sectionOf<float>(snapshot, SnapshotSection::FAST_DEATH_TIMER, n);
+	const float* ripple = sectionOf<float>(snapshot, SnapshotSection::RIPPLE, n);
+	const int* lastVisible = sectionOf<int>(snapshot, SnapshotSection::LAST_VISIBLE_PETALS, n);
+	const RngStream* rng = sectionOf<RngStream>(snapshot, SnapshotSection::FLOWER_RNG, n);
+	const FlowerGenome* genome = sectionOf<FlowerGenome>(snapshot, SnapshotSection::GENOMES, n);
+	const TendrilDef* tendrils = sectionOf<TendrilDef>(snapshot, SnapshotSection::TENDRILS, nTendrils);
+	size_t numPetals = 0, numBeats = 0;
+	const FallingPetal* petals = snapshot.array<FallingPetal>(SnapshotSection::FALLING_PETALS, numPetals);
+	const float* beatAges = snapshot.array<float>(SnapshotSection::BEAT_AGES, numBeats);
+	if (!lifePhase || !lifeSpeed || !rotation || !rotationSpeed || !rotationDir || !fastDeath
+	    || !fastDeathTimer || !ripple || !lastVisible || !rng || !genome || !tendrils
+	    || !petals || !beatAges) {
+		ofLogWarning("FlowerField") << "Snapshot layout doesn't match this build; not restored";
+		return false;
+	}
+	// One genome out of range means the file can't be trusted
+	for (size_t i = 0; i < n; i++) {
+		if (!genomeInRange(genome[i])) {
+			ofLogWarning("FlowerField") << "Snapshot flower " << i << " has out-of-range genome fields; not restored";
+			return false;
+		}
+	}
+	if (head.flowerCount > cap) {
+		ofLogWarning("FlowerField") << "Snapshot has " << head.flowerCount
+			<< " flowers, capacity is " << cap << "; dropping the rest";
+	}
 
-		auto& sp = fi.flower.getStem().getParams();
-		ofColor sc = fi.baseStemColor; sc.a = a;
-		sp.color = sc;
-		fi.flower.getStem().setParams(sp);
+	// Handles 0..n-1 in slot order, the rest free as after setup()
+	state.clear();
+	drawOrder.clear();
+	grid.clear();
+	std::fill(slotOfHandle.begin(), slotOfHandle.end(), kNoSlot);
+	freeHandles.clear();
+	for (size_t h = cap; h-- > n;) freeHandles.push_back((uint32_t)h);
+	for (size_t i = 0; i < n; i++) {
+		state.push((uint32_t)i);
+		slotOfHandle[i] = (uint32_t)i;
+	}
 
-		fi.flower.draw(screenX, screenY);
+	std::copy_n(lifePhase, n, state.lifePhase.begin());
+	std::copy_n(lifeSpeed, n, state.lifeSpeedMult.begin());
+	std::copy_n(rotation, n, state.rotationAccum.begin());
+	std::copy_n(rotationSpeed, n, state.rotationSpeed.begin());
+	std::copy_n(rotationDir, n, state.rotationDir.begin());
+	std::copy_n(fastDeath, n, state.fastDeath.begin());
+	std::copy_n(fastDeathTimer, n, state.fastDeathTimer.begin());
+	std::copy_n(ripple, n, state.ripple.begin());
+	std::copy_n(rng, n, state.rng.begin());
+	std::copy_n(genome, n, genomes.begin());
+	std::copy_n(tendrils, nTendrils, tendrilSlab.begin());
+
+	for (size_t i = 0; i < n; i++) {
+		FlowerGenome& g = genomes[i];
+		g.tendrils = {&tendrilSlab[i * kMaxTendrilsPerFlower],
+		              std::max(0, std::min(g.tendrils.count, kMaxTendrilsPerFlower))};
+		grid.insert((uint32_t)i, g.normPos);
+		buildFlower(i);
+		drawOrder.push_back((uint32_t)i);
 	}
+	std::copy_n(lastVisible, n, state.lastVisiblePetals.begin());
+	state.snapshot(0, n);
+	std::sort(drawOrder.begin(), drawOrder.end(),
+		[this](uint32_t a, uint32_t b) {
+			return genomes[a].normPos.y < genomes[b].normPos.y;
+		});
 
-	// Draw falling petals on top of flowers
-	fallingPetals.draw();
+	const SnapshotFieldState& f = head.field;
+	smoothedVolume = f.smoothedVolume;
+	smoothedPitch = f.smoothedPitch;
+	smoothedFullness = f.smoothedFullness;
+	slowVolume = f.slowVolume;
+	activityLevel = f.activityLevel;
+	activityVariability = f.activityVariability;
+	noiseClock = f.noiseClock;
+	baseCount = std::max(1, std::min<int>(f.baseCount, (int)cap));
+	colorMode = ofClamp(f.colorMode, 0, 9);
+	iterateIndex = std::max(0, std::min<int>(f.iterateIndex, kNumSchemes - 1));
+	reactiveMode = f.reactiveMode != 0;
+	rngSeed = f.rngSeed;
+	spawnCounter = f.spawnCounter;
+	fieldRng = f.fieldRng;
+
+	// The new audio clock starts near zero: beats become negative times,
+	// and analysis counters start over
+	beatHistory.clear();
+	for (size_t i = 0; i < numBeats; i++) beatHistory.push_back(-(double)beatAges[i]);
+	audioClock = 0.0;
+	lastFeatureSequence = 0;
+	lastBeatCount = 0;
+	lastFiredBeat = -1.0;
+	tickAccumulator = 0.0f;
+	numRipples = 0;
+
+	fallingPetals.restore(petals, numPetals, f.fallingPetalClock);
+	return true;
 }
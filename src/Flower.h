@@ -1,6 +1,17 @@
 #pragma once
 #include "ofMain.h"
+#include "AudioFeatures.h"
+#include "PetalBatchRenderer.h"
+#include "FallingPetalRenderer.h"
+#include "HeadSpriteAtlas.h"
+#include "StemRenderer.h"
+#include "WorkerPool.h"
+#include "SpatialGrid.h"
+#include "Rng.h"
+#include "FieldSnapshot.h"
+#include <array>
 #include <deque>
+#include <unordered_map>
 
 // --- Petal shape parameters ---
 
@@ -16,6 +27,42 @@ struct PetalParams {
 // Build a single petal shape into the given path (shared by Inflorescence and FallingPetalSystem)
 void buildPetalPath(ofPath& path, const PetalParams& params, ofColor color);
 
+// --- Quantised petal geometry cache ---
+// The petal outline is linear in length, so every petal is a scaled copy of a
+// unit-length mesh. Meshes are keyed on the quantised shape parameters and
+// tessellated once; length, color and rotation are applied at draw time.
+// Flower centers are cached the same way, at unit radius.
+
+enum class CenterType;
+
+class PetalMeshCache {
+public:
+	static PetalMeshCache& shared();
+
+	static uint32_t keyFor(const PetalParams& params);
+	static PetalParams paramsFor(uint32_t key);   // bucket center, length = 1
+
+	const ofVboMesh& get(uint32_t key);
+	const ofVboMesh& get(const PetalParams& params);
+	const ofVboMesh& getCoarse(uint32_t key);   // fewer bezier samples, for small heads
+	const ofVboMesh& getDisc();                 // unit disc, for head impostors
+
+	// Center shapes as plain triangles at unit radius, keyed on the type and
+	// the element count its detail gives, so they batch like petals
+	static uint32_t centerKeyFor(CenterType type, float detail);
+	const ofVboMesh& getCenter(uint32_t key);
+	size_t size() const;
+	int getBuildCount() const;
+
+private:
+	std::unordered_map<uint32_t, ofVboMesh> meshes;
+	std::unordered_map<uint32_t, ofVboMesh> coarseMeshes;
+	std::unordered_map<uint32_t, ofVboMesh> centerMeshes;
+	ofVboMesh disc;
+	bool discBuilt = false;
+	int buildCount = 0;
+};
+
 // --- Head type enum and type-specific params ---
 
 enum class HeadType {
@@ -25,6 +72,7 @@ enum class HeadType {
 	SUPERFORMULA,
 	LAYERED_WHORLS
 };
+const int kNumHeadTypes = 5;
 
 enum class CenterType {
     SIMPLE_DISC,    // The original circle
@@ -32,6 +80,7 @@ enum class CenterType {
     POLLEN_GRID,    // Dense clusters of small dots
     GEOMETRIC_STAR  // A small star-like shape
 };
+const int kNumCenterTypes = 4;
 
 struct PhyllotaxisParams {
 	float spiralSpacing = 4.0f;     // 'c' in r = c*sqrt(n)
@@ -68,6 +117,49 @@ struct NoiseModParams {
 	float timeSpeed = 0.3f;         // noise animation speed
 };
 
+// --- Periodic noise table ---
+// ofSignedNoise sampled once on a grid that wraps in both position and time
+// (4-D noise on two circles) and looked up bilinearly, so layouts do no
+// Perlin evaluation. Time comes from a simulation clock set once per frame.
+
+class NoiseTable {
+public:
+	static NoiseTable& shared();
+
+	void setTime(double seconds);  // FlowerField::update, once per frame
+	double getTime() const;
+
+	// One time row pair, shared by every petal of a head
+	struct Sampler {
+		const float* row0;
+		const float* row1;
+		float ft;
+		float operator()(float x) const;  // signed noise, roughly [-1, 1]
+	};
+	Sampler sampler(float t) const;
+
+	static const int kSamplesPerUnit = 4;
+	static const int kColumns = 256;   // 64 noise units before x wraps
+	static const int kRows = 128;      // 32 noise units before t wraps
+
+private:
+	NoiseTable();
+
+	std::vector<float> values;     // kRows x kColumns
+	double time = 0.0;
+};
+
+inline float NoiseTable::Sampler::operator()(float x) const {
+	float u = x * kSamplesPerUnit;
+	float fu = std::floor(u);
+	float fx = u - fu;
+	int c0 = (int)fu & (kColumns - 1);
+	int c1 = (c0 + 1) & (kColumns - 1);
+	float a = row0[c0] + (row0[c1] - row0[c0]) * fx;
+	float b = row1[c0] + (row1[c1] - row1[c0]) * fx;
+	return a + (b - a) * ft;
+}
+
 // --- Petal position helper (for falling petal spawn) ---
 
 struct PetalPosition {
@@ -98,30 +190,87 @@ struct InflorescenceParams {
     float centerDetail = 1.0f; // Controls density/points
 };
 
+// Detail tier for one flower, chosen from its projected size
+enum class LodTier {
+	FULL,       // full petal meshes, detailed centres, tendrils
+	SIMPLE,     // coarse petal meshes, centres as plain discs
+	SPRITE,     // pre-rendered atlas sprite (drawn as SIMPLE where unavailable)
+	IMPOSTOR    // whole head as one disc in the petal color
+};
+
+// One petal of a head in head-local space (before the head rotation)
+struct PetalPlacement {
+	const ofVboMesh* mesh;    // cached unit-length petal
+	glm::vec2 offset;         // translation from head center
+	float angleDeg;           // petal orientation
+	glm::vec2 scale;          // x = width scale, y = length scale (pixels)
+	int layer;                // 0 = back layer (drawn first)
+};
+
 class Inflorescence {
 public:
 	void setup(const InflorescenceParams& params);
-	void draw();
+	void draw(std::vector<PetalPlacement>& placements, LodTier lod = LodTier::FULL);   // placements: caller scratch
+	void drawCenter(LodTier lod = LodTier::FULL);  // center only, with head rotation and color
+
+	// Unit-radius center mesh for this tier (a plain disc below FULL), to be
+	// scaled by centerRadius; nullptr for impostors, whose disc covers it
+	const ofVboMesh* getCenterMesh(LodTier lod);
 	void setParams(const InflorescenceParams& params);
 	InflorescenceParams& getParams();
 
+	// Petal placement for the current params, in draw order (no GL calls)
+	void layoutPetals(std::vector<PetalPlacement>& out, LodTier lod = LodTier::FULL);
+
+	// Same, for a caller that already knows the head type (defined in
+	// Flower.cpp; lets batches of one type skip the per-head dispatch)
+	template <HeadType T>
+	void layoutPetalsAs(std::vector<PetalPlacement>& out, LodTier lod);
+
+	// Approximate head radius in screen units (petal tips), for LOD
+	float getRadius() const;
+
+	// Preallocate per-petal and per-whorl storage so later layouts of any
+	// head up to these sizes never allocate
+	void reserve(int maxPetals, int maxWhorlLayers);
+
+	// Quantised shape identity for the sprite atlas: size, rotation, colors
+	// and noise are left out since sprites are scaled, spun and tinted
+	uint64_t spriteKey() const;
+
 private:
 	void rebuild();
 
-	void drawRadial();
-	void drawPhyllotaxis();
-	void drawRoseCurve();
-	void drawSuperformula();
-	void drawLayeredWhorls();
-	void drawCenter();
+	// Per-petal base layout for the current count and type params. Rebuilt
+	// only when those change; per frame only length and noise are applied.
+	struct PetalBase {
+		float angleDeg;
+		glm::vec2 offset;     // from head center (phyllotaxis spiral)
+		glm::vec2 scaleMod;   // width/length multipliers (rose, superformula, whorls)
+		int petalIdx;         // noise index
+		int layer;            // 0 = back layer
+	};
+	template <HeadType T> void buildPetalTable();
+	void useCoarseMeshes(std::vector<PetalPlacement>& out);
 
 	struct NoiseResult { float lengthScale; float angleDeg; float scaleVal; };
-	NoiseResult computeNoise(int petalIdx) const;
+	NoiseResult computeNoise(int petalIdx) const;   // uses noiseSampler
 
 	InflorescenceParams params;
-	ofPath petalPath;
-	std::vector<ofPath> whorlPaths;
+	const ofVboMesh* petalMesh = nullptr;
+	std::vector<const ofVboMesh*> whorlMeshes;
+	std::vector<float> whorlLengthScales;
+	std::vector<uint32_t> whorlKeys;
+	const ofVboMesh* coarsePetalMesh = nullptr;   // fetched on first SIMPLE draw
+	std::vector<const ofVboMesh*> coarseWhorlMeshes;
+	bool coarseReady = false;
+	uint32_t shapeKey = 0;
+	const ofVboMesh* centerMesh = nullptr;
+	uint32_t centerKey = 0;
 	bool dirty = true;
+	std::vector<PetalBase> petalTable;
+	bool tableDirty = true;
+	NoiseTable::Sampler noiseSampler{};   // set by layoutPetals for this frame
 };
 
 // --- Stem ---
@@ -145,33 +294,77 @@ struct TendrilDef {
 	float thickness;          // line width
 };
 
+const int kMaxTendrilsPerFlower = 4;
+
+// Non-owning view of a flower's tendrils (the field keeps them in a slab)
+struct TendrilSpan {
+	const TendrilDef* data = nullptr;
+	int count = 0;
+
+	const TendrilDef* begin() const { return data; }
+	const TendrilDef* end() const { return data + count; }
+	size_t size() const { return (size_t)count; }
+	bool empty() const { return count == 0; }
+};
+
 class Stem {
 public:
 	void setup(const StemParams& params);
-	void draw();
+	void draw(StemStrip& scratch, bool withTendrils = true);   // scratch: used when the strip needs baking
 	void setParams(const StemParams& params);
 	StemParams& getParams();
 	glm::vec2 getTopPosition() const;
-	void setTendrils(const std::vector<TendrilDef>& tendrils);
+	void setTendrils(TendrilSpan tendrils);   // storage must outlive the stem's use of it
 
 private:
+	// Baked path: stem and tendrils in one strip, bent by the stem shader
+	void bake(StemStrip& strip);
+	static uint64_t bakeKeyFor(const StemParams& p);
+
+	// Tessellated fallback when the stem shader is unavailable
+	void drawTessellated(bool withTendrils);
 	void rebuild();
 	void drawTendrils();
+	static uint64_t shapeKeyFor(const StemParams& p);
+	glm::mat4 builtToLive() const;   // built mesh space -> live height and curvature
 	glm::vec2 stemPointAt(float t) const;
 	glm::vec2 stemTangentAt(float t) const;
 
 	StemParams params;
-	std::vector<TendrilDef> tendrils;
-	ofPath stemPath;
+	TendrilSpan tendrils;
+
+	// Baked only depends on thickness, taper and nodes, so it is built once
+	// per respawn; height and curvature are shader uniforms.
+	ofVbo bakedStrip;
+	int bakedVertices = 0;
+	int bakedBodyVertices = 0;   // strip prefix without tendrils
+	uint64_t bakedKey = 0;
+	bool bakeDirty = true;
+
+	ofVboMesh stemMesh;
+	// Geometry is built at quantised height/curvature; the residual height
+	// is applied as a vertical scale and the residual bend as a shear that
+	// lands the tip on getTopPosition(), so growth and wilt rarely rebuild.
+	uint64_t shapeKey = 0;
+	float builtHeight = 0.0f;
+	float builtCurvature = 0.0f;
 	bool dirty = true;
 };
 
+// Caller-owned scratch for drawing, reused from flower to flower
+struct FlowerDrawScratch {
+	std::vector<PetalPlacement> placements;
+	StemStrip strip;
+};
+
 // --- Complete Flower ---
 
 class Flower {
 public:
 	void setup(const InflorescenceParams& inflorescence, const StemParams& stem);
-	void draw(float x, float y);  // (x, y) = ground position (stem base)
+	// (x, y) = ground position (stem base)
+	void draw(float x, float y, FlowerDrawScratch& scratch, LodTier lod = LodTier::FULL,
+	          bool withTendrils = true);
 
 	Inflorescence& getInflorescence();
 	Stem& getStem();
@@ -181,61 +374,82 @@ private:
 	Stem stem;
 };
 
-// --- A single flower instance in the field with random personality ---
 
-struct FlowerInstance {
-	Flower flower;
+// --- Per-flower storage: genome (cold) + state arrays (hot) ---
+// Cold per-flower data: rolled once at respawn, read-only while the flower lives
+struct FlowerGenome {
 	glm::vec2 normPos;          // 0-1 normalized screen position (ground point)
+	float depthScale = 1.0f;    // computed from y position (perspective)
 
 	// Head type
-	HeadType baseHeadType = HeadType::RADIAL;
-	PhyllotaxisParams basePhyllotaxis;
-	RoseCurveParams baseRoseCurve;
-	SuperformulaParams baseSuperformula;
-	LayeredWhorlsParams baseWhorls;
-	NoiseModParams baseNoise;
-
-	//center type
-
-	CenterType baseCenterType = CenterType::SIMPLE_DISC;
-	float baseCenterDetail = 1.0f;
-
-	// Random base properties (set once at creation)
-	int basePetalCount;
-	float baseLength;
-	float baseWidth;
-	float basePointiness;
-	float baseBulge;
-	float baseEdgeCurvature;
-	float baseCenterRadius;
-	float baseStemHeight;
-	float baseStemCurvature;
-	float baseTaperRatio;
-	int baseSegments;
-	float baseNodeWidth;
-	std::vector<TendrilDef> baseTendrils;
-	ofColor basePetalColor;
-	ofColor baseCenterColor;
-	ofColor baseStemColor;
+	HeadType headType = HeadType::RADIAL;
+	PhyllotaxisParams phyllotaxis;
+	RoseCurveParams roseCurve;
+	SuperformulaParams superformula;
+	LayeredWhorlsParams whorls;
+	NoiseModParams noise;
 
-	// Per-flower music reactivity
-	float pitchDirection;       // +1 or -1: how pitch modulates pointiness
-	float depthScale;           // computed from y position (perspective)
+	// Center type
+	CenterType centerType = CenterType::SIMPLE_DISC;
+	float centerDetail = 1.0f;
+
+	// Petal / stem shape
+	int petalCount = 5;
+	float length = 50.0f;
+	float width = 0.4f;
+	float pointiness = 0.5f;
+	float bulge = 0.5f;
+	float edgeCurvature = 0.0f;
+	float centerRadius = 8.0f;
+	float stemHeight = 100.0f;
+	float stemCurvature = 0.0f;
+	float taperRatio = 0.3f;
+	int segments = 1;
+	float nodeWidth = 1.6f;
+	TendrilSpan tendrils;          // points into FlowerField's tendril slab
+	ofColor petalColor;
+	ofColor centerColor;
+	ofColor stemColor;
 
-	// Rotation (beat-driven)
-	float rotationAccum = 0.0f;   // accumulated rotation degrees
-	float rotationSpeed = 0.0f;   // base speed deg/s (0 = no rotation)
-	float rotationDir = 1.0f;     // +1 or -1, flipped on beat
+	// Per-flower music reactivity
+	float pitchDirection = 1.0f; // +1 or -1: how pitch modulates pointiness
+};
 
+// Hot simulated state, one dense array per field so the per-frame loops
+// stream contiguous floats. Slot i of every array belongs to the same flower;
+// handle[i] indexes its genome and Flower in the field's stable pools.
+struct FlowerStateArrays {
 	// Lifecycle
-	float lifePhase = 0.0f;    // 0-1 progress through bloom→decay cycle
-	float lifeSpeedMult = 1.0f; // slight per-flower speed variation
-	float currentAlpha = 1.0f;  // computed per frame for draw
-	int lastVisiblePetals = -1; // tracks petal count for detecting drops
+	std::vector<float> lifePhase;          // 0-1 progress through bloom→decay cycle
+	std::vector<float> lifeSpeedMult;      // slight per-flower speed variation
+	std::vector<float> currentAlpha;       // computed per frame for draw
+	std::vector<int> lastVisiblePetals;    // tracks petal count for detecting drops
+
+	// Rotation (beat-driven)
+	std::vector<float> rotationAccum;      // accumulated rotation degrees
+	std::vector<float> rotationSpeed;      // base speed deg/s (0 = no rotation)
+	std::vector<float> rotationDir;        // +1 or -1, flipped on beat
 
 	// Fast death: dramatic rapid wilt triggered when flower count needs to shrink
-	bool fastDeath = false;
-	float fastDeathTimer = 0.0f;  // 0-1 progress of fast death animation
+	std::vector<uint8_t> fastDeath;
+	std::vector<float> fastDeathTimer;     // 0-1 progress of fast death animation
+
+	std::vector<RngStream> rng;            // the flower's own stream, from its spawn
+	std::vector<uint32_t> handle;
+
+	// Previous tick, so draws can pose flowers between the last two ticks
+	std::vector<float> prevLifePhase;
+	std::vector<float> prevRotationAccum;
+	std::vector<float> prevFastDeathTimer;
+
+	std::vector<float> ripple;             // 0-1 swell left by passing beat ripples
+
+	size_t size() const { return handle.size(); }
+	void clear();
+	void reserve(size_t n);
+	void push(uint32_t h);                 // append a slot with default state
+	void swapRemove(size_t slot);          // move the last slot into slot
+	void snapshot(size_t begin, size_t end);   // current -> previous tick
 };
 
 // --- Falling petal animation ---
@@ -249,25 +463,28 @@ struct FallingPetalConfig {
 	float fadeSpeed = 0.6f;          // alpha reduction per second
 	float initialUpPop = 10.0f;      // px/s initial upward velocity
 	float maxLifetime = 4.0f;        // seconds before auto-remove
+	int capacity = 4096;             // pool size; spawns beyond it are dropped
 };
 
+// Launch state only: motion is closed-form in age, so nothing is integrated
 struct FallingPetal {
-	glm::vec2 basePosition;          // center of oscillation (moves with velocity)
-	glm::vec2 velocity;              // px/s
-	float rotation = 0.0f;           // current orientation degrees
+	glm::vec2 origin;                // spawn position of the oscillation center
+	glm::vec2 velocity;              // initial px/s
+	float rotation = 0.0f;           // orientation degrees at spawn
 	float rotationSpeed = 0.0f;      // degrees/s tumble
-	float alpha = 1.0f;
-	float age = 0.0f;                // seconds since detach
 	float waverPhase = 0.0f;
 	float waverAmp = 0.0f;
 	float waverFreq = 0.0f;
+	float spawnTime = 0.0f;          // system clock at detach
+	float deathTime = 0.0f;          // system clock when it falls off-screen or fades out
 
-	PetalParams shape;                // visual shape at final pixel size
+	uint32_t shapeKey = 0;           // PetalMeshCache key of the unit outline
+	const ofVboMesh* mesh = nullptr;
+	float length = 0.0f;             // px, scale applied to the unit mesh
 	ofColor color;
 
-	bool alive = true;
-
-	glm::vec2 drawPosition() const;
+	glm::vec2 positionAt(float age, float gravity) const;
+	float rotationAt(float age) const;
 };
 
 class FallingPetalSystem {
@@ -276,55 +493,350 @@ public:
 	FallingPetalConfig& getConfig();
 
 	void spawn(glm::vec2 headPos, float detachAngleDeg,
-	           const PetalParams& shape, ofColor color);
+	           uint32_t shapeKey, float length, ofColor color, RngStream rng);
 	void update(float dt);
 	void draw();
 	void clear();
+
+	// Draw this far (seconds) behind the clock, matching the field's pose
+	void setDrawLag(float seconds);
 	int activeCount() const;
 
+	// Petals retire once they fall below this height (px, spawn-time)
+	void setFloor(float y);
+
+	// Evaluate motion in the vertex shader instead of per petal on the CPU
+	void setGpuSimulation(bool enabled);
+	bool isGpuSimulation() const;
+
+	// Live petals in spawn order and the clock they are timed against, for
+	// snapshots; restore() replaces the live set (beyond capacity is dropped)
+	void exportLive(std::vector<FallingPetal>& out) const;
+	float getClock() const;
+	void restore(const FallingPetal* petals, size_t n, float clock);
+
 private:
+	void allocatePool();
+	void rebaseClock();
+	float alphaAt(float age) const;
+	void drawCpu();
+	void drawGpu();
+
 	FallingPetalConfig config;
-	std::vector<FallingPetal> petals;
+	std::vector<FallingPetal> pool;  // fixed capacity, addressed by index
+	std::vector<uint32_t> freeList;
+	std::vector<uint32_t> live;      // dense list of active pool indices
+	float clock = 0.0f;              // rebased to 0 when the pool drains or every few minutes
+	float drawLag = 0.0f;
+	float floorY = 768.0f;
+
+	bool gpuSimulation = false;
+	bool gpuInitialized = false;
+	bool gpuDirty = true;            // live set changed since the last upload
+	FallingPetalRenderer gpuRenderer;
 };
 
 // --- Field of flowers driven by audio ---
 
+enum class FieldRenderMode {
+	IMMEDIATE,    // per-petal matrix push + mesh draw
+	INSTANCED     // petals batched per mesh bucket, one instanced draw each
+};
+
+// Level-of-detail thresholds on projected size (framebuffer pixels)
+struct LodSettings {
+	bool enabled = true;
+	float simpleHeadPx = 14.0f;    // head radius below which petals go coarse, centres plain
+	float impostorHeadPx = 5.0f;   // head radius below which the head is one disc
+	float tendrilStemPx = 40.0f;   // stem height below which tendrils are skipped
+	bool spriteAtlas = false;      // instanced mode: small heads from the sprite atlas
+	float spriteHeadPx = 24.0f;    // head radius below which the atlas is used
+	float pixelScale = 1.0f;       // framebuffer pixels per screen unit
+	float thresholdScale = 1.0f;   // multiplies every px threshold; the frame governor raises it
+};
+
+// Flower count range and how fast the field moves towards its target
+struct FieldScaling {
+	int reactiveMin = 30;          // reactive-mode target at silence
+	int reactiveMax = 800;         // reactive-mode target at full activity
+	int countLimit = 0;            // cap on every target, 0 = capacity
+	int spawnsPerTick = 5;         // 600/s at 120 Hz, as 10 per 60 Hz frame
+	int deathMarksPerTick = 3;     // fast deaths started per tick when over target
+};
+
 class FlowerField {
 public:
 	void setup(int count);
-	void update(float volume, float pitch, float confidence, float fullness, float bass);
+	// Runs the simulation in fixed ticks for the elapsed frame time, then
+	// poses every flower between the last two ticks for drawing
+	void update(const AudioFeatures& features, float frameDt);
+	// Offline (render, bench): as update(), but the whole frameDt is simulated
+	// however long it is, so frames at any fps stay locked to the audio
+	void advance(const AudioFeatures& features, float frameDt);
 	void draw();
 	void setReactiveMode(bool enabled);
 	bool isReactiveMode() const;
 	void setColorMode(int mode);    // 0=iterate, 1-8=scheme, 9=random
 	int getColorMode() const;
 	std::string getColorSchemeName() const;
+	void setRenderMode(FieldRenderMode mode);
+	FieldRenderMode getRenderMode() const;
+	void setLodSettings(const LodSettings& settings);
+	const LodSettings& getLodSettings() const;
+
+	void setParallelUpdate(bool enabled);
+	bool isParallelUpdate() const;
+
+	// Seed for every random stream in the field (applies at the next setup);
+	// without one each setup draws a fresh seed. getSeed() is the one in use.
+	void setSeed(uint64_t seed);
+	uint64_t getSeed() const;
+
+	// Fire predicted beats this far (seconds) ahead of the analyzed audio
+	// clock to cancel pipeline latency; 0 = react when the beat is analyzed
+	void setBeatLookahead(float seconds);
+	float getBeatLookahead() const;
+
+	// Simulation tick rate (Hz), independent of the render rate
+	void setTickRate(float hz);
+	float getTickRate() const;
+
+	// Group delay of the volume smoothing (seconds)
+	static float getVolumeSmoothingLag();
+
+	// Flower pool size, preallocated by setup() (applies at the next setup);
+	// spawning and killing within it never touches the heap
+	void setCapacity(int maxFlowers);
+	int getCapacity() const;
+
+	// Count targets and per-tick spawn/death budgets; targets beyond the
+	// capacity are clipped to it
+	void setScaling(const FieldScaling& scaling);
+	const FieldScaling& getScaling() const;
+	void setBaseCount(int count);   // normal-mode target, initially setup()'s count
+	int getBaseCount() const;
+	int getFlowerCount() const;     // live flowers
+
+	// Relative spawn weights indexed by HeadType (applies to new spawns)
+	void setHeadTypeWeights(const std::array<float, kNumHeadTypes>& weights);
+	const std::array<float, kNumHeadTypes>& getHeadTypeWeights() const;
+
+	// Field size in px that normPos maps onto; 0 follows the window
+	void setCanvasSize(float width, float height);
+	glm::vec2 getCanvasSize() const;
+
+	// draw() maps this region of the canvas (normalized) onto the current
+	// viewport and skips flowers that cannot reach it; the default full
+	// region turns culling off. One simulation can feed several tiles.
+	void setViewRegion(const ofRectangle& normalized);
+	const ofRectangle& getViewRegion() const;
+
+	// Beats send a ripple out from a random flower; flowers swell as the
+	// front passes them
+	void setRipples(bool enabled);
+	bool getRipples() const;
+
+	const SpatialGrid& getSpatialGrid() const;
+
+	// Snapshots (see FieldSnapshot.h). saveSnapshot() captures everything the
+	// simulation evolves; restoreSnapshot(), after setup(), replaces the live
+	// field with it and returns false, leaving the field as it was, if the
+	// file was written by an incompatible build.
+	void saveSnapshot(SnapshotBuilder& out) const;
+	bool restoreSnapshot(const FieldSnapshot& snapshot);
 
 private:
-	void respawnFlower(FlowerInstance& fi);
+	// Read-only per-frame inputs shared by all per-flower updates
+	struct FrameState {
+		float dt = 0.0f;
+		float lifeStep = 0.0f;      // lifecycle advance before per-flower speed
+		float pitchNorm = 0.0f;
+		float volume = 0.0f;        // smoothed 0-1
+		bool beatThisFrame = false;
+		bool overTarget = false;    // more flowers than the target count
+		float width = 0.0f;
+		float height = 0.0f;
+		float rippleDecay = 1.0f;   // per-tick multiplier on the ripple swell
+	};
+
+	struct PetalSpawn {
+		glm::vec2 position;
+		float angleDeg;
+		uint32_t shapeKey;
+		float length;
+		ofColor color;
+		uint64_t order;     // slot, then sequence: merge key
+		RngStream rng;      // forked from the flower's stream
+	};
+
+	// Per-thread output of the parallel update, merged serially: respawns
+	// draw the next spawn stream from spawnCounter, petals fork their own
+	struct ThreadScratch {
+		std::vector<PetalSpawn> spawns;
+		std::vector<size_t> respawns;
+	};
+
+	static const size_t kUpdateGrain = 32;
+
+	static const uint32_t kNoSlot = 0xFFFFFFFFu;
+	static const int kReactiveMaxCount = 800;
+
+	size_t addFlower();
+	void removeFlower(size_t slot);
+	void insertDrawOrder(uint32_t h);
+	void eraseDrawOrder(uint32_t h);
+	void respawnFlower(size_t slot);
+	void buildFlower(size_t slot);    // Flower geometry from its genome
+	void streamHotState(size_t begin, size_t end, const FrameState& frame);
+	// Lifecycle outputs for a phase, shared by ticks and draw poses
+	struct FlowerPose {
+		float scale = 1.0f;         // flower head scale
+		float stemScale = 1.0f;     // stem height scale
+		float stemCurveMod = 0.0f;  // additional bend during wilt
+		float alpha = 1.0f;
+		float volumePulse = 1.0f;
+		float pointiness = 0.0f;
+		int visiblePetals = 0;
+	};
+	static FlowerPose poseFor(const FlowerGenome& g, float phase, bool fastDeath,
+	                          float fastDeathTimer, float volume, float pitchNorm);
+	void tick(const AudioFeatures& features, float dt);
+	void pose(float blend);
+	void stepInstance(size_t slot, const FrameState& frame,
+	                  std::vector<PetalSpawn>& spawns);
+	void poseInstance(size_t slot, float blend, const FrameState& frame);
+	LodTier headLodFor(uint32_t h);
+	bool tendrilsFor(uint32_t h);
+	void prepareSprites();
+	template <HeadType T>
+	void layoutHeads(const std::vector<uint32_t>& drawIndices, float w, float h,
+	                 float slot, float rankStep);
+	void renderSprite(Inflorescence& head, int cell);
+	void drawImmediate();
+	void drawInstanced();
+	void drawTranslucentHeads(float maxDepth);
+	ofRectangle viewRect() const;     // view region in canvas px
+	void beginView();
+	void cullToView();
+	bool isCulled(uint32_t h) const { return cullActive && !inView[h]; }
+	void spawnRipple(float strength);
+	void advanceRipples(float dt, float aspect);
+
+	// Flower storage: dense hot state by slot, genomes and rendering resources
+	// by stable handle. drawOrder lists live handles back to front.
+	FlowerStateArrays state;
+	std::vector<FlowerGenome> genomes;
+	std::vector<Flower> flowers;
+	std::vector<uint32_t> slotOfHandle;
+	std::vector<uint32_t> freeHandles;
+	std::vector<uint32_t> drawOrder;
+	std::vector<TendrilDef> tendrilSlab;   // kMaxTendrilsPerFlower entries per handle
+	int capacity = kReactiveMaxCount;
 
-	std::vector<FlowerInstance> instances;
 	float smoothedVolume = 0.0f;
 	float smoothedPitch = 0.0f;
 	float smoothedFullness = 0.0f;
 
-	// Beat/onset detection (bass-driven)
-	float fastBass = 0.0f;        // fast EMA of bass energy (tracks transients)
-	float slowBass = 0.0f;        // slow EMA baseline for comparison
-	float beatCooldown = 0.0f;    // seconds until next beat can trigger
+	// Smoothing time constants (seconds); the old per-frame weights at 60 fps
+	static constexpr float kVolumeTau = 0.20f;
+	static constexpr float kFullnessTau = 0.16f;
+	static constexpr float kPitchTau = 0.13f;
+	static constexpr float kSlowVolumeTau = 0.83f;
+	static constexpr float kVariabilityTau = 0.83f;
+	static constexpr float kActivityTau = 0.55f;
+
+	// Fixed-step simulation
+	static constexpr float kMaxFrameTime = 0.1f;      // longer hitches are dropped, not replayed
+	void runTicks(const AudioFeatures& features, float elapsed);
+	float tickDt = 1.0f / 120.0f;
+	float tickAccumulator = 0.0f;     // simulated time owed, < tickDt after update()
+	FrameState prevTick;              // frame-level inputs of the last two ticks
+	FrameState lastTick;
+	uint64_t lastFeatureSequence = 0;
+	double audioClock = 0.0;          // features.time advanced per tick between analysis frames
+
+	// Beats arrive from the analysis thread (detected per hop)
+	static constexpr double kBeatMergeWindow = 0.12;   // seconds; onset vs predicted beat
+	static constexpr float kBeatLockConfidence = 0.3f; // tempo confidence to fire on prediction
+	static constexpr float kMaxBeatLookahead = 0.25f;  // seconds; stays below one beat at 240 BPM
+	float beatLookahead = 0.0f;
+	uint64_t lastBeatCount = 0;
+	double lastFiredBeat = -1.0;  // audio-clock time of the last beat reacted to
 	float slowVolume = 0.0f;      // slow EMA for overall volume baseline
+	double noiseClock = 0.0;      // simulation time driving petal noise (at the last tick)
 
 	// Reactive mode: dynamic flower count driven by musical activity
 	bool reactiveMode = false;
 	int baseCount = 300;              // normal-mode count (from setup)
+	FieldScaling scaling;
 	float activityLevel = 0.0f;       // smoothed 0-1 composite activity score
 	float activityVariability = 0.0f; // smoothed rate of change — how much music is shifting
-	std::deque<float> beatHistory;    // timestamps of recent beats (for density)
-	float elapsedTime = 0.0f;         // running clock
+	std::deque<double> beatHistory;   // audio-clock timestamps of recent beats (for density)
 
 	// Color schemes: 0=iterate, 1-8=locked scheme, 9=random
 	int colorMode = 0;
 	int iterateIndex = 0;
 
+	// radial, phyllotaxis, rose curve, superformula, layered whorls
+	std::array<float, kNumHeadTypes> headTypeWeights = {0.25f, 0.20f, 0.20f, 0.15f, 0.20f};
+
 	FallingPetalSystem fallingPetals;
+	LodSettings lod;
+
+	// Parallel update
+	std::unique_ptr<WorkerPool> pool;
+	std::vector<ThreadScratch> threadScratch;
+	std::vector<PetalSpawn> spawnMerge;    // per-thread output in slot order
+	std::vector<size_t> respawnMerge;
+	bool parallelUpdate = true;
+	// Random streams: field-level picks, then one per spawn (see Rng.h)
+	static const size_t kGenomeRolls = 64;   // uniforms pre-drawn per respawn
+	uint64_t seed = 0;
+	bool seedSet = false;
+	uint64_t rngSeed = 0;
+	uint64_t spawnCounter = 0;
+	RngStream fieldRng;
+
+	// Rendering
+	FieldRenderMode renderMode = FieldRenderMode::INSTANCED;
+	PetalBatchRenderer petalBatches;
+	bool batchesInitialized = false;
+	FlowerDrawScratch drawScratch;    // petal layout and stem bakes, main thread only
+	std::array<std::vector<uint32_t>, kNumHeadTypes> headBatches;  // drawOrder indices per head type
+	std::vector<uint32_t> translucentStemScratch;                  // drawOrder indices, back to front
+
+	// Sprite atlas: tiers and cells per drawOrder entry, filled by prepareSprites()
+	HeadSpriteAtlas headSprites;
+	bool spritesInitialized = false;
+	Inflorescence spriteHead;         // scratch head rendered into atlas cells
+	std::vector<LodTier> tierScratch;
+	std::vector<int> spriteCellScratch;
+	uint64_t drawFrame = 0;
+
+	// Live handles bucketed by normPos, kept current by respawn and removal
+	SpatialGrid grid;
+
+	glm::vec2 canvas{0.0f, 0.0f};
+
+	// View culling: inView is per handle, inViewList the handles set this frame
+	static constexpr float kMaxFlowerReachPx = 400.0f;   // stem + swollen head, from the base
+	ofRectangle viewRegion{0.0f, 0.0f, 1.0f, 1.0f};
+	bool cullActive = false;
+	std::vector<uint8_t> inView;
+	std::vector<uint32_t> inViewList;
+
+	// Beat ripples: radius in field heights, screen-round via the aspect
+	struct Ripple {
+		glm::vec2 origin;
+		float radius = 0.0f;
+		float strength = 0.0f;
+	};
+	static const int kMaxRipples = 4;
+	static constexpr float kRippleSpeed = 0.6f;      // field heights per second
+	static constexpr float kRippleFalloff = 1.5f;    // strength lost per field height travelled
+	static constexpr float kRippleTau = 0.25f;       // swell decay (seconds)
+	static constexpr float kRippleSwell = 0.35f;     // petal length gain at full swell
+	bool ripplesEnabled = false;
+	std::array<Ripple, kMaxRipples> ripples;
+	int numRipples = 0;
 };
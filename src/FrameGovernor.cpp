@@ -0,0 +1,147 @@
+#include "FrameGovernor.h"
+#include <algorithm>
+#include <cmath>
+
+void FrameGovernor::setup(const Settings& s, int cap) {
+	settings = s;
+	settings.window = std::max(settings.window, 1);
+	capacity = std::max(cap, 0);
+	workMs.assign(settings.window, 0.0f);
+	intervalMs.assign(settings.window, 0.0f);
+	scratch.reserve(settings.window);
+	head = filled = 0;
+	sinceChange = 0.0f;
+	countLimit = capacity;
+	spawns = (float)settings.baseSpawnsPerTick;
+	deaths = (float)settings.baseDeathMarksPerTick;
+	lodLevel = 0;
+	ceiling = 0;
+	workP99 = intervalP99 = 0.0f;
+}
+
+const FrameGovernor::Settings& FrameGovernor::getSettings() const {
+	return settings;
+}
+
+void FrameGovernor::setStress(bool enabled) {
+	if (enabled == stress) return;
+	stress = enabled;
+	// Start every search from the top; the first over-budget window sets the level
+	countLimit = capacity;
+	ceiling = 0;
+	head = filled = 0;
+	sinceChange = 0.0f;
+}
+
+bool FrameGovernor::isStress() const {
+	return stress;
+}
+
+void FrameGovernor::frame(float interval, float work, int liveCount) {
+	if (workMs.empty()) return;
+	workMs[head] = work;
+	intervalMs[head] = interval;
+	head = (head + 1) % settings.window;
+	filled = std::min(filled + 1, settings.window);
+	sinceChange += interval / 1000.0f;
+
+	// Per-frame budgets: a heavy frame halves spawning and speeds up deaths,
+	// a light one grows spawning by a quarter and lets deaths relax
+	const float budget = settings.budgetMs;
+	bool heavy = work > budget || interval > budget * settings.missFactor;
+	if (heavy) {
+		spawns = std::max(1.0f, spawns * 0.5f);
+		deaths = std::min((float)settings.maxDeathMarksPerTick, deaths * 2.0f);
+	} else if (work < budget * settings.headroom) {
+		spawns = std::min((float)settings.maxSpawnsPerTick, spawns + std::max(1.0f, spawns * 0.25f));
+		deaths = std::max((float)settings.baseDeathMarksPerTick, deaths * 0.9f);
+	}
+
+	if (filled == settings.window && sinceChange >= settings.holdSeconds) judge(liveCount);
+}
+
+void FrameGovernor::judge(int liveCount) {
+	workP99 = percentileOf(workMs, 0.99f);
+	intervalP99 = percentileOf(intervalMs, 0.99f);
+	const float budget = settings.budgetMs;
+	bool over = workP99 > budget || intervalP99 > budget * settings.missFactor;
+	bool spare = workP99 < budget * settings.headroom && !over;
+
+	bool changed = false;
+	if (over) {
+		if (!stress && lodLevel < settings.maxLodLevel) {
+			lodLevel++;
+		} else {
+			countLimit = std::min(countLimit, (int)(liveCount * settings.countCut));
+		}
+		changed = true;
+	} else {
+		if (stress) ceiling = liveCount;
+		if (spare) {
+			// Undo in reverse: count first, then detail. A limit the field has
+			// grown into is probed upwards; one it sits well under (its target
+			// is lower) is not what keeps the frame cheap, so it goes straight
+			// back to capacity and detail can recover on the same window.
+			bool binding = liveCount >= countLimit * 0.98f;
+			if (countLimit < capacity && binding) {
+				countLimit = std::min(capacity, (int)std::ceil(countLimit * settings.countProbe) + 1);
+				changed = true;
+			} else {
+				if (countLimit < capacity) {
+					countLimit = capacity;
+					changed = true;
+				}
+				if (lodLevel > 0) {
+					lodLevel--;
+					changed = true;
+				}
+			}
+		}
+	}
+
+	// Judge the next window on frames after the change only
+	if (changed) {
+		head = filled = 0;
+		sinceChange = 0.0f;
+	}
+}
+
+float FrameGovernor::percentileOf(const std::vector<float>& values, float p) const {
+	scratch.assign(values.begin(), values.begin() + filled);
+	if (scratch.empty()) return 0.0f;
+	size_t k = std::min(scratch.size() - 1, (size_t)(p * (scratch.size() - 1) + 0.5f));
+	std::nth_element(scratch.begin(), scratch.begin() + k, scratch.end());
+	return scratch[k];
+}
+
+int FrameGovernor::getCountLimit() const {
+	return countLimit;
+}
+
+int FrameGovernor::getSpawnsPerTick() const {
+	return (int)spawns;
+}
+
+int FrameGovernor::getDeathMarksPerTick() const {
+	return (int)deaths;
+}
+
+int FrameGovernor::getLodLevel() const {
+	return lodLevel;
+}
+
+float FrameGovernor::getLodScale() const {
+	return std::pow(settings.lodStep, (float)lodLevel);
+}
+
+int FrameGovernor::getCeiling() const {
+	return ceiling;
+}
+
+float FrameGovernor::getWorkP99() const {
+	return workP99;
+}
+
+float FrameGovernor::getIntervalP99() const {
+	return intervalP99;
+}
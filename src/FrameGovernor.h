@@ -0,0 +1,73 @@
+#pragma once
+#include <vector>
+
+// --- Frame-time governor ---
+// Main thread only. Fed one sample per frame: the frame interval and the CPU
+// time spent in update + draw. Spawn and death budgets follow each frame
+// (additive increase while there is headroom, halved on an over-budget
+// frame), so the field fills as fast as the budget allows without stutter.
+// The flower count limit and LOD follow the p99 of a sliding window: over
+// budget coarsens LOD first and then lowers the count limit; in stress mode
+// it goes straight to the count, which climbs from the first frame until p99
+// hits the budget and is then held at that ceiling, probing upwards again
+// while p99 keeps headroom.
+
+class FrameGovernor {
+public:
+	struct Settings {
+		float budgetMs = 1000.0f / 60.0f;
+		float headroom = 0.75f;        // work p99 below budget * headroom counts as spare
+		float missFactor = 1.5f;       // intervals above budget * missFactor are dropped frames
+		int window = 120;              // frames in the p99 window
+		float holdSeconds = 3.0f;      // settle time after a change before judging again
+		float countCut = 0.9f;         // count limit after an over-budget window, x live count
+		float countProbe = 1.05f;      // count limit growth per window with headroom
+		int baseSpawnsPerTick = 5;
+		int maxSpawnsPerTick = 256;
+		int baseDeathMarksPerTick = 3;
+		int maxDeathMarksPerTick = 256;
+		int maxLodLevel = 3;
+		float lodStep = 1.5f;          // LOD threshold scale per level
+	};
+
+	void setup(const Settings& settings, int capacity);
+	const Settings& getSettings() const;
+
+	// Stress mode: the count limit searches for this machine's ceiling
+	void setStress(bool enabled);
+	bool isStress() const;
+
+	void frame(float intervalMs, float workMs, int liveCount);
+
+	int getCountLimit() const;          // capacity while nothing has been cut
+	int getSpawnsPerTick() const;
+	int getDeathMarksPerTick() const;
+	int getLodLevel() const;
+	float getLodScale() const;          // multiplies the LOD thresholds, 1 at level 0
+	int getCeiling() const;             // stress: highest count that held the budget, 0 until known
+	float getWorkP99() const;
+	float getIntervalP99() const;
+
+private:
+	void judge(int liveCount);
+	float percentileOf(const std::vector<float>& values, float p) const;
+
+	Settings settings;
+	int capacity = 0;
+	bool stress = false;
+
+	std::vector<float> workMs;          // p99 window rings
+	std::vector<float> intervalMs;
+	int head = 0;
+	int filled = 0;
+	float sinceChange = 0.0f;           // seconds since the last limit / LOD change
+
+	int countLimit = 0;
+	float spawns = 0.0f;                // fractional so small budgets still grow
+	float deaths = 0.0f;
+	int lodLevel = 0;
+	int ceiling = 0;
+	float workP99 = 0.0f;
+	float intervalP99 = 0.0f;
+	mutable std::vector<float> scratch;
+};
@@ -0,0 +1,288 @@
+#include "HeadSpriteAtlas.h"
+
+namespace {
+// Attribute locations after oF's defaults (position, color, normal, texcoord)
+const int kOriginLocation = 4;
+const int kSpinLocation = 5;
+const int kUvLocation = 6;
+const int kPetalLocation = 7;
+const int kCenterLocation = 8;
+
+// Heads are drawn into 90% of the cell so mip levels do not bleed
+const float kCellFill = 0.9f;
+
+const char* kSpriteVertexShader = R"(
+#version 330
+uniform mat4 modelViewProjectionMatrix;
+in vec4 position;
+in vec4 spriteOrigin;
+in vec4 spriteSpin;
+in vec4 spriteUv;
+in vec4 spritePetal;
+in vec4 spriteCenter;
+out vec2 vUv;
+out vec4 vPetal;
+out vec4 vCenter;
+void main() {
+	vec2 local = position.xy * spriteOrigin.w;
+	vec2 p = vec2(spriteSpin.x * local.x - spriteSpin.y * local.y,
+	              spriteSpin.y * local.x + spriteSpin.x * local.y) + spriteOrigin.xy;
+	gl_Position = modelViewProjectionMatrix * vec4(p, spriteOrigin.z, 1.0);
+	// oF draws into FBOs flipped, so texture rows follow screen y
+	vUv = spriteUv.xy + (position.xy + 1.0) * 0.5 * spriteUv.zw;
+	vPetal = spritePetal;
+	vCenter = spriteCenter;
+}
+)";
+
+const char* kSpriteFragmentShader = R"(
+#version 330
+uniform sampler2D atlas;
+in vec2 vUv;
+in vec4 vPetal;
+in vec4 vCenter;
+out vec4 outputColor;
+void main() {
+	vec4 mask = texture(atlas, vUv);
+	if (mask.a < 0.5) discard;
+	vec3 rgb = (vPetal.rgb * mask.r + vCenter.rgb * mask.g) / max(mask.r + mask.g, 1e-4);
+	outputColor = vec4(rgb, vPetal.a);
+}
+)";
+
+glm::vec4 toVec4(const ofColor& c) {
+	return glm::vec4(c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f);
+}
+}
+
+bool HeadSpriteAtlas::setup(int size, int cell) {
+	atlasSize = size;
+	cellSize = cell;
+	cellsPerRow = std::max(1, atlasSize / cellSize);
+	cells.assign(cellsPerRow * cellsPerRow, Cell());
+	cellOfKey.clear();
+	occupiedCells = 0;
+
+	ofFboSettings fboSettings;
+	fboSettings.width = atlasSize;
+	fboSettings.height = atlasSize;
+	fboSettings.internalformat = GL_RGBA;
+	fboSettings.textureTarget = GL_TEXTURE_2D;
+	fboSettings.useDepth = false;
+	fbo.allocate(fboSettings);
+	fbo.getTexture().setTextureMinMagFilter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+	fbo.begin();
+	ofClear(0, 0, 0, 0);
+	fbo.end();
+
+	ofMesh corners;
+	corners.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+	corners.addVertex(glm::vec3(-1.0f, -1.0f, 0.0f));
+	corners.addVertex(glm::vec3(1.0f, -1.0f, 0.0f));
+	corners.addVertex(glm::vec3(-1.0f, 1.0f, 0.0f));
+	corners.addVertex(glm::vec3(1.0f, 1.0f, 0.0f));
+	quad.setup(ofVboMesh(corners));
+
+	shader.setupShaderFromSource(GL_VERTEX_SHADER, kSpriteVertexShader);
+	shader.setupShaderFromSource(GL_FRAGMENT_SHADER, kSpriteFragmentShader);
+	shader.bindDefaults();
+	shader.bindAttribute(kOriginLocation, "spriteOrigin");
+	shader.bindAttribute(kSpinLocation, "spriteSpin");
+	shader.bindAttribute(kUvLocation, "spriteUv");
+	shader.bindAttribute(kPetalLocation, "spritePetal");
+	shader.bindAttribute(kCenterLocation, "spriteCenter");
+	ready = shader.linkProgram() && fbo.isAllocated();
+	if (!ready) {
+		ofLogWarning("HeadSpriteAtlas") << "Sprite atlas unavailable, small heads use meshes";
+	}
+	return ready;
+}
+
+bool HeadSpriteAtlas::isReady() const {
+	return ready;
+}
+
+int HeadSpriteAtlas::acquire(uint64_t key, uint64_t frame, bool& needsRender) {
+	needsRender = false;
+	auto it = cellOfKey.find(key);
+	if (it != cellOfKey.end()) {
+		cells[it->second].lastUsed = frame;
+		return it->second;
+	}
+
+	// Free cell first, otherwise the least recently used one not needed this frame
+	int victim = -1;
+	for (int i = 0; i < (int)cells.size(); i++) {
+		if (!cells[i].occupied) {
+			victim = i;
+			break;
+		}
+		if (cells[i].lastUsed < frame
+		    && (victim < 0 || cells[i].lastUsed < cells[victim].lastUsed)) {
+			victim = i;
+		}
+	}
+	if (victim < 0) return -1;
+
+	Cell& cell = cells[victim];
+	if (cell.occupied) {
+		cellOfKey.erase(cell.key);
+	} else {
+		occupiedCells++;
+	}
+	cell.key = key;
+	cell.lastUsed = frame;
+	cell.occupied = true;
+	cellOfKey[key] = victim;
+	needsRender = true;
+	return victim;
+}
+
+void HeadSpriteAtlas::beginRender() {
+	if (rendering) return;
+	fbo.begin();
+	rendering = true;
+}
+
+void HeadSpriteAtlas::clearCell(int cell) {
+	int cs = cellSize;
+	glEnable(GL_SCISSOR_TEST);
+	glScissor((cell % cellsPerRow) * cs, (cell / cellsPerRow) * cs, cs, cs);
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glDisable(GL_SCISSOR_TEST);
+}
+
+glm::vec2 HeadSpriteAtlas::cellCenter(int cell) const {
+	// Inside the FBO oF's y runs along GL rows, so no flip is needed
+	float cs = cellSize;
+	return glm::vec2((cell % cellsPerRow + 0.5f) * cs, (cell / cellsPerRow + 0.5f) * cs);
+}
+
+float HeadSpriteAtlas::cellRadius() const {
+	return 0.5f * cellSize * kCellFill;
+}
+
+void HeadSpriteAtlas::endRender() {
+	if (!rendering) return;
+	fbo.end();
+	fbo.getTexture().generateMipmap();
+	rendering = false;
+	renderCount++;
+}
+
+float HeadSpriteAtlas::quadHalfSize(float headRadius) const {
+	return headRadius / kCellFill;
+}
+
+void HeadSpriteAtlas::begin() {
+	opaque.clear();
+	translucent.clear();
+}
+
+void HeadSpriteAtlas::add(int cell, glm::vec2 center, float headRadius, float rotationDeg, float z,
+                          const ofColor& petal, const ofColor& centerColor) {
+	float rad = ofDegToRad(rotationDeg);
+	float uvSize = (float)cellSize / atlasSize;
+
+	HeadSpriteInstance inst;
+	inst.origin = glm::vec4(center.x, center.y, z, quadHalfSize(headRadius));
+	inst.spin = glm::vec4(std::cos(rad), std::sin(rad), 0.0f, 0.0f);
+	inst.uv = glm::vec4((cell % cellsPerRow) * uvSize, (cell / cellsPerRow) * uvSize, uvSize, uvSize);
+	inst.petal = toVec4(petal);
+	inst.center = toVec4(centerColor);
+	if (petal.a < 255) {
+		translucent.push_back(inst);
+	} else {
+		opaque.push_back(inst);
+	}
+}
+
+void HeadSpriteAtlas::bindInstances(size_t firstInstance) {
+	int stride = sizeof(HeadSpriteInstance);
+	int base = (int)(firstInstance * sizeof(HeadSpriteInstance));
+	ofVbo& vbo = quad.vbo;
+	vbo.setAttributeBuffer(kOriginLocation, instanceBuffer, 4, stride, base + offsetof(HeadSpriteInstance, origin));
+	vbo.setAttributeBuffer(kSpinLocation, instanceBuffer, 4, stride, base + offsetof(HeadSpriteInstance, spin));
+	vbo.setAttributeBuffer(kUvLocation, instanceBuffer, 4, stride, base + offsetof(HeadSpriteInstance, uv));
+	vbo.setAttributeBuffer(kPetalLocation, instanceBuffer, 4, stride, base + offsetof(HeadSpriteInstance, petal));
+	vbo.setAttributeBuffer(kCenterLocation, instanceBuffer, 4, stride, base + offsetof(HeadSpriteInstance, center));
+	vbo.setAttributeDivisor(kOriginLocation, 1);
+	vbo.setAttributeDivisor(kSpinLocation, 1);
+	vbo.setAttributeDivisor(kUvLocation, 1);
+	vbo.setAttributeDivisor(kPetalLocation, 1);
+	vbo.setAttributeDivisor(kCenterLocation, 1);
+}
+
+void HeadSpriteAtlas::draw() {
+	drawOpaque();
+	drawTranslucent();
+}
+
+void HeadSpriteAtlas::drawOpaque() {
+	drawCalls = 0;
+	translucentDrawn = 0;
+	size_t total = opaque.size() + translucent.size();
+	if (!ready || total == 0) return;
+
+	// Back to front (nearer = larger z); one sprite per flower, so no ties
+	// worth keeping stable
+	std::sort(translucent.begin(), translucent.end(),
+		[](const HeadSpriteInstance& a, const HeadSpriteInstance& b) {
+			return a.origin.z < b.origin.z;
+		});
+
+	if (total > capacity) {
+		capacity = std::max(total, capacity * 2);
+		instanceBuffer.allocate(capacity * sizeof(HeadSpriteInstance), GL_STREAM_DRAW);
+	}
+	size_t opaqueBytes = opaque.size() * sizeof(HeadSpriteInstance);
+	if (!opaque.empty()) instanceBuffer.updateData(0, opaqueBytes, opaque.data());
+	if (!translucent.empty()) {
+		instanceBuffer.updateData(opaqueBytes,
+			translucent.size() * sizeof(HeadSpriteInstance), translucent.data());
+	}
+
+	if (opaque.empty()) return;
+	shader.begin();
+	shader.setUniformTexture("atlas", fbo.getTexture(), 0);
+	bindInstances(0);
+	quad.draw((int)opaque.size());
+	drawCalls++;
+	shader.end();
+}
+
+float HeadSpriteAtlas::nextTranslucentDepth() const {
+	if (translucentDrawn >= translucent.size()) return std::numeric_limits<float>::infinity();
+	return translucent[translucentDrawn].origin.z;
+}
+
+void HeadSpriteAtlas::drawTranslucent(float maxDepth) {
+	if (!ready || nextTranslucentDepth() >= maxDepth) return;
+
+	// Sorted, so everything behind maxDepth is one contiguous run
+	size_t end = translucentDrawn + 1;
+	while (end < translucent.size() && translucent[end].origin.z < maxDepth) end++;
+
+	shader.begin();
+	shader.setUniformTexture("atlas", fbo.getTexture(), 0);
+	glDepthMask(GL_FALSE);
+	bindInstances(opaque.size() + translucentDrawn);
+	quad.draw((int)(end - translucentDrawn));
+	glDepthMask(GL_TRUE);
+	shader.end();
+	drawCalls++;
+	translucentDrawn = end;
+}
+
+int HeadSpriteAtlas::getDrawCalls() const {
+	return drawCalls;
+}
+
+int HeadSpriteAtlas::getRenderCount() const {
+	return renderCount;
+}
+
+size_t HeadSpriteAtlas::size() const {
+	return occupiedCells;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "ofMain.h"
+#include "PetalBatchRenderer.h"
+#include <unordered_map>
+
+// --- One sprite instance, packed for the sprite shader ---
+
+struct HeadSpriteInstance {
+	glm::vec4 origin;   // xy = head center, z = depth, w = quad half-size (px)
+	glm::vec4 spin;     // xy = cos/sin of the head rotation
+	glm::vec4 uv;       // xy = cell origin, zw = cell size (normalized)
+	glm::vec4 petal;    // petal tint
+	glm::vec4 center;   // center tint
+};
+
+// --- Pre-rendered head sprites ---
+// Unique (quantised) head configurations are rendered once into cells of an
+// FBO atlas as two-channel masks (red = petals, green = center) and drawn as
+// instanced textured quads tinted per flower. Cells are recycled least
+// recently used first; cells used in the current frame are never evicted.
+
+class HeadSpriteAtlas {
+public:
+	// 256 cells at the defaults
+	bool setup(int atlasSize = 2048, int cellSize = 128);
+	bool isReady() const;
+
+	// Cell for a head key; -1 if every cell is in use this frame. Sets
+	// needsRender when the cell was (re)assigned and must be drawn.
+	int acquire(uint64_t key, uint64_t frame, bool& needsRender);
+
+	// Render misses: between beginRender/endRender, clear a cell and draw
+	// the head in oF coordinates centered on cellCenter(), radius cellRadius()
+	void beginRender();
+	void clearCell(int cell);
+	glm::vec2 cellCenter(int cell) const;
+	float cellRadius() const;
+	void endRender();
+
+	// Quad half-size for a head of the given radius (cells have a margin)
+	float quadHalfSize(float headRadius) const;
+
+	void begin();                 // drop all instances
+	void add(int cell, glm::vec2 center, float headRadius, float rotationDeg, float z,
+	         const ofColor& petal, const ofColor& centerColor);
+	void draw();                  // drawOpaque() + drawTranslucent()
+
+	// Same split as PetalBatchRenderer: drawOpaque() uploads, sorts the
+	// translucent sprites back to front and draws the opaque ones;
+	// drawTranslucent() draws the translucent sprites behind maxDepth not yet
+	// drawn, without writing depth. Both expect depth test enabled.
+	void drawOpaque();
+	void drawTranslucent(float maxDepth = std::numeric_limits<float>::infinity());
+	float nextTranslucentDepth() const;   // infinity once all are drawn
+
+	int getDrawCalls() const;
+	int getRenderCount() const;   // cells rendered since setup
+	size_t size() const;          // cells holding a head
+
+private:
+	struct Cell {
+		uint64_t key = 0;
+		uint64_t lastUsed = 0;
+		bool occupied = false;
+	};
+
+	int atlasSize = 0;
+	int cellSize = 0;
+	int cellsPerRow = 0;
+	std::vector<Cell> cells;
+	std::unordered_map<uint64_t, int> cellOfKey;
+
+	ofFbo fbo;
+	ofShader shader;
+	InstancedMeshVbo quad;
+	void bindInstances(size_t firstInstance);
+	std::vector<HeadSpriteInstance> opaque;
+	std::vector<HeadSpriteInstance> translucent;
+	size_t translucentDrawn = 0;
+	ofBufferObject instanceBuffer;
+	size_t capacity = 0;
+	bool ready = false;
+	bool rendering = false;
+	int drawCalls = 0;
+	int renderCount = 0;
+	size_t occupiedCells = 0;
+};
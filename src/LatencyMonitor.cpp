@@ -0,0 +1,56 @@
+#include "LatencyMonitor.h"
+#include <algorithm>
+
+namespace {
+float toMs(int64_t ns) {
+	return std::max(0.0f, ns / 1e6f);
+}
+}
+
+void LatencyMonitor::pickup(const AudioFeatures& features, int64_t nowNs) {
+	// Offline replay carries no stamps
+	hasPending = features.captureNs != 0;
+	if (!hasPending) return;
+	pending.captureNs = features.captureNs;
+	pending.arrivalNs = features.arrivalNs;
+	pending.publishNs = features.publishNs;
+	pending.pickupNs = nowNs;
+}
+
+void LatencyMonitor::present(int64_t nowNs) {
+	if (!hasPending) return;
+	hasPending = false;
+
+	auto& sample = history[head];
+	sample[(int)LatencyStage::DEVICE] = toMs(pending.arrivalNs - pending.captureNs);
+	sample[(int)LatencyStage::ANALYSIS] = toMs(pending.publishNs - pending.arrivalNs);
+	sample[(int)LatencyStage::PICKUP] = toMs(pending.pickupNs - pending.publishNs);
+	sample[(int)LatencyStage::PRESENT] = toMs(nowNs - pending.pickupNs);
+	sample[(int)LatencyStage::TOTAL] = toMs(nowNs - pending.captureNs);
+	head = (head + 1) % kHistory;
+	filled = std::min(filled + 1, kHistory);
+}
+
+int LatencyMonitor::getSampleCount() const {
+	return filled;
+}
+
+float LatencyMonitor::getPercentile(LatencyStage stage, float p) const {
+	if (filled == 0) return 0.0f;
+	scratch.clear();
+	for (int i = 0; i < filled; i++) scratch.push_back(history[i][(int)stage]);
+	size_t k = std::min(scratch.size() - 1, (size_t)(p * (scratch.size() - 1) + 0.5f));
+	std::nth_element(scratch.begin(), scratch.begin() + k, scratch.end());
+	return scratch[k];
+}
+
+const char* LatencyMonitor::stageName(LatencyStage stage) {
+	switch (stage) {
+		case LatencyStage::DEVICE:   return "device";
+		case LatencyStage::ANALYSIS: return "hop + analysis";
+		case LatencyStage::PICKUP:   return "pickup";
+		case LatencyStage::PRESENT:  return "draw + vsync";
+		case LatencyStage::TOTAL:    return "total";
+		default:                     return "?";
+	}
+}
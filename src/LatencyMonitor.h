@@ -0,0 +1,49 @@
+#pragma once
+#include "AudioFeatures.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// --- Audio-to-visual latency stages ---
+
+enum class LatencyStage {
+	DEVICE,         // sound card -> delivered to the app (capture buffering)
+	ANALYSIS,       // delivered -> features published (hop wait + Essentia)
+	PICKUP,         // published -> picked up by update()
+	PRESENT,        // picked up -> frame presented (update, draw, vsync)
+	TOTAL,          // sound card -> presented
+	COUNT
+};
+
+// --- Latency distribution from the features' clock stamps ---
+// Main thread only. A feature frame picked up in update() counts as
+// presented at the start of the next update, after the swap that showed it.
+
+class LatencyMonitor {
+public:
+	static const int kHistory = 240;
+	static const int kNumStages = (int)LatencyStage::COUNT;
+
+	void pickup(const AudioFeatures& features, int64_t nowNs);   // newest frame this update
+	void present(int64_t nowNs);                                 // start of the following update
+
+	int getSampleCount() const;
+	float getPercentile(LatencyStage stage, float p) const;      // ms, 0 if nothing recorded
+
+	static const char* stageName(LatencyStage stage);
+
+private:
+	struct Pending {
+		int64_t captureNs = 0;
+		int64_t arrivalNs = 0;
+		int64_t publishNs = 0;
+		int64_t pickupNs = 0;
+	};
+
+	Pending pending;
+	bool hasPending = false;
+	std::array<std::array<float, kNumStages>, kHistory> history{};
+	int head = 0;
+	int filled = 0;
+	mutable std::vector<float> scratch;
+};
@@ -0,0 +1,89 @@
+#include "OfflineApp.h"
+#include <essentia/algorithmfactory.h>
+
+using namespace essentia;
+using namespace essentia::standard;
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+bool parseSize(const std::string& v, int& w, int& h) {
+	size_t x = v.find('x');
+	if (x == std::string::npos) return false;
+	w = std::stoi(v.substr(0, x));
+	h = std::stoi(v.substr(x + 1));
+	return w > 0 && h > 0;
+}
+
+bool loadMonoAudio(const std::string& path, int sampleRate, size_t minSamples,
+                   std::vector<Real>& out, const std::string& logModule) {
+	// MonoLoader decodes and resamples to the analysis rate
+	Algorithm* loader = nullptr;
+	try {
+		loader = AlgorithmFactory::create("MonoLoader",
+			"filename", path,
+			"sampleRate", (Real)sampleRate);
+		loader->output("audio").set(out);
+		loader->compute();
+	} catch (const std::exception& e) {
+		ofLogError(logModule) << "Could not load " << path << ": " << e.what();
+		out.clear();
+	}
+	if (loader) AlgorithmFactory::free(loader);
+
+	if (out.size() < std::max<size_t>(minSamples, 1)) {
+		ofLogError(logModule) << path << ": no usable audio";
+		return false;
+	}
+	return true;
+}
+
+// ============================================================
+// CommandLine
+// ============================================================
+
+CommandLine::CommandLine(int argc, char** argv) : argc(argc), argv(argv) {
+}
+
+bool CommandLine::next() {
+	if (++index >= argc) return false;
+	current = argv[index];
+	return true;
+}
+
+const std::string& CommandLine::arg() const {
+	return current;
+}
+
+bool CommandLine::value(std::string& v, std::string& error) {
+	if (index + 1 >= argc) {
+		error = "missing value for " + current;
+		return false;
+	}
+	v = argv[++index];
+	return true;
+}
+
+// ============================================================
+// OfflineApp
+// ============================================================
+
+void OfflineApp::setup() {
+	ofSetFrameRate(0);
+	ofSetVerticalSync(false);
+}
+
+void OfflineApp::update() {
+	if (finished) return;
+	finished = true;
+
+	essentia::init();
+	run();
+	essentia::shutdown();
+	ofExit(exitCode);
+}
+
+int OfflineApp::getExitCode() const {
+	return exitCode;
+}
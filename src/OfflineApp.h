@@ -0,0 +1,59 @@
+#pragma once
+#include "ofMain.h"
+#include <essentia/essentia.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// --- Shared scaffolding for the offline tools (bench/, render/) ---
+
+// Seconds of steady clock since t0
+double secondsSince(std::chrono::steady_clock::time_point t0);
+
+// "WxH" with both sides positive
+bool parseSize(const std::string& v, int& w, int& h);
+
+// Decodes a file to mono at sampleRate with Essentia's MonoLoader. Fails
+// (logged under logModule) if it can't be read or holds fewer than
+// minSamples samples (or none at all). Needs essentia::init().
+bool loadMonoAudio(const std::string& path, int sampleRate, size_t minSamples,
+                   std::vector<essentia::Real>& out, const std::string& logModule);
+
+// Walks argv for an option parser: next() steps to each argument in turn,
+// value() consumes the one after it as the current option's value
+class CommandLine {
+public:
+	CommandLine(int argc, char** argv);
+
+	bool next();
+	const std::string& arg() const;
+	// False with error set when the current option is the last argument
+	bool value(std::string& v, std::string& error);
+
+private:
+	int argc;
+	char** argv;
+	int index = 0;
+	std::string current;
+};
+
+// --- Run-once offline app ---
+// Unthrottled and without vsync; the whole job runs in run() on the first
+// update, once the GL context is fully set up, between essentia::init() and
+// shutdown(), and the app exits with exitCode afterwards.
+
+class OfflineApp : public ofBaseApp {
+public:
+	void setup() override;
+	void update() override;
+
+	int getExitCode() const;
+
+protected:
+	virtual void run() = 0;
+
+	int exitCode = 0;
+
+private:
+	bool finished = false;
+};
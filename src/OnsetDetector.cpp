@@ -0,0 +1,226 @@
+#include "OnsetDetector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Bass is weighted up so kicks still dominate, but snares and hats count
+const float kBandWeights[kNumSpectralBands] = {1.5f, 1.0f, 1.0f, 0.75f};
+const float kBandMeanTau = 2.0f;        // seconds, per-band flux normalisation
+const float kFluxFloor = 1e-3f;         // keeps near-silent bands from amplifying noise
+const float kSilenceRms = 0.002f;       // no onsets below this level
+
+// Adaptive threshold: mean + deviations * mean absolute deviation + offset
+const float kThresholdTau = 1.0f;
+const float kThresholdDeviations = 1.5f;
+const float kThresholdOffset = 0.15f;
+const float kMinOnsetInterval = 0.10f;  // seconds
+
+// Tempo search
+const float kHistorySeconds = 4.0f;
+const float kTempoInterval = 0.5f;      // seconds between estimates
+const float kMinBpm = 60.0f;
+const float kMaxBpm = 180.0f;
+const float kPreferredBpm = 120.0f;
+const float kBpmOctaveSpread = 0.9f;    // log2 std-dev of the tempo prior
+const float kTempoJump = 0.08f;         // log2 distance treated as a new tempo
+const float kPeriodAlpha = 0.2f;
+const float kConfidenceAlpha = 0.3f;
+
+// Phase following
+const float kPhaseWindow = 0.25f;       // fraction of a period an onset may deviate
+const float kPhaseGain = 0.3f;
+const float kLockConfidence = 0.2f;
+
+float emaAlpha(float dt, float tau) {
+	return 1.0f - std::exp(-dt / tau);
+}
+}
+
+void OnsetDetector::setup(float hop) {
+	hopSeconds = hop;
+	history.assign(std::max<size_t>(8, (size_t)std::ceil(kHistorySeconds / hop)), 0.0f);
+	linear.assign(history.size(), 0.0f);
+	tempoIntervalHops = std::max(1, (int)std::round(kTempoInterval / hop));
+	reset();
+}
+
+void OnsetDetector::reset() {
+	bandMean.fill(0.0f);
+	primed = false;
+	odfMean = 1.0f;
+	odfDeviation = odfPrev = odfPrev2 = 0.0f;
+	prevTime = 0.0;
+	onsetTime = -1.0;
+	std::fill(history.begin(), history.end(), 0.0f);
+	historyHead = historyFilled = 0;
+	hopsSinceTempo = 0;
+	periodSeconds = 0.0f;
+	tempoConfidence = 0.0f;
+	beatAnchor = -1.0;
+}
+
+bool OnsetDetector::process(const std::array<float, kNumSpectralBands>& bandFlux, float rms, double time) {
+	// Seed the band means with the first hop so startup is not one big onset
+	if (!primed) {
+		bandMean = bandFlux;
+		primed = true;
+	}
+
+	// Onset detection function: weighted mean of self-normalised band flux
+	float odf = 0.0f;
+	float weightSum = 0.0f;
+	const float meanAlpha = emaAlpha(hopSeconds, kBandMeanTau);
+	for (int b = 0; b < kNumSpectralBands; b++) {
+		odf += kBandWeights[b] * bandFlux[b] / (bandMean[b] + kFluxFloor);
+		weightSum += kBandWeights[b];
+		bandMean[b] += (bandFlux[b] - bandMean[b]) * meanAlpha;
+	}
+	odf /= weightSum;
+
+	// Peak picking on the previous hop: local maximum above the threshold
+	float threshold = odfMean + kThresholdDeviations * odfDeviation + kThresholdOffset;
+	bool onset = odfPrev > odfPrev2 && odfPrev >= odf && odfPrev > threshold
+		&& rms > kSilenceRms
+		&& (onsetTime < 0.0 || prevTime - onsetTime >= kMinOnsetInterval);
+	if (onset) {
+		onsetTime = prevTime;
+		followPhase(onsetTime);
+	}
+
+	const float thresholdAlpha = emaAlpha(hopSeconds, kThresholdTau);
+	odfMean += (odf - odfMean) * thresholdAlpha;
+	odfDeviation += (std::abs(odf - odfMean) - odfDeviation) * thresholdAlpha;
+	odfPrev2 = odfPrev;
+	odfPrev = odf;
+	prevTime = time;
+
+	// Mean-removed, half-wave rectified ODF feeds the tempo autocorrelation
+	history[historyHead] = std::max(0.0f, odf - odfMean);
+	historyHead = (historyHead + 1) % history.size();
+	historyFilled = std::min(historyFilled + 1, history.size());
+	if (++hopsSinceTempo >= tempoIntervalHops) {
+		hopsSinceTempo = 0;
+		estimateTempo();
+	}
+
+	return onset;
+}
+
+void OnsetDetector::estimateTempo() {
+	const size_t n = historyFilled;
+	int minLag = std::max(1, (int)std::floor(60.0f / kMaxBpm / hopSeconds));
+	int maxLag = std::min((int)(n / 2), (int)std::ceil(60.0f / kMinBpm / hopSeconds));
+	if (maxLag <= minLag + 1) return;
+
+	// Unroll the ring oldest-first so the lag loop is contiguous
+	size_t start = (historyHead + history.size() - n) % history.size();
+	for (size_t i = 0; i < n; i++) {
+		linear[i] = history[(start + i) % history.size()];
+	}
+
+	auto autocorrelation = [&](int lag) {
+		float sum = 0.0f;
+		for (size_t i = lag; i < n; i++) sum += linear[i] * linear[i - lag];
+		return sum / (float)(n - lag);
+	};
+
+	float energy = autocorrelation(0);
+	if (energy <= 1e-9f) return;
+
+	// Best lag under a log-normal tempo prior, then parabolic refinement
+	int bestLag = minLag;
+	float bestScore = -1.0f;
+	for (int lag = minLag; lag <= maxLag; lag++) {
+		float bpm = 60.0f / (lag * hopSeconds);
+		float octaves = std::log2(bpm / kPreferredBpm) / kBpmOctaveSpread;
+		float score = autocorrelation(lag) * std::exp(-0.5f * octaves * octaves);
+		if (score > bestScore) {
+			bestScore = score;
+			bestLag = lag;
+		}
+	}
+
+	float peak = autocorrelation(bestLag);
+	float lag = (float)bestLag;
+	if (bestLag > minLag && bestLag < maxLag) {
+		float left = autocorrelation(bestLag - 1);
+		float right = autocorrelation(bestLag + 1);
+		float denom = left - 2.0f * peak + right;
+		if (denom < 0.0f) lag += std::max(-0.5f, std::min(0.5f, 0.5f * (left - right) / denom));
+	}
+
+	float period = lag * hopSeconds;
+	float strength = std::min(1.0f, peak / energy);
+
+	// Small drift: follow smoothly. A different tempo replaces the current
+	// one only if its periodicity is stronger than what we are locked to.
+	if (periodSeconds <= 0.0f) {
+		periodSeconds = period;
+	} else if (std::abs(std::log2(period / periodSeconds)) < kTempoJump) {
+		periodSeconds += (period - periodSeconds) * kPeriodAlpha;
+	} else if (strength > tempoConfidence) {
+		periodSeconds = period;
+	}
+	tempoConfidence += (strength - tempoConfidence) * kConfidenceAlpha;
+}
+
+void OnsetDetector::followPhase(double t) {
+	if (periodSeconds <= 0.0f || beatAnchor < 0.0) {
+		beatAnchor = t;
+		return;
+	}
+
+	// Pull the beat grid toward onsets that land near it; re-seed on
+	// off-grid onsets only while the tracker is not locked
+	double k = std::round((t - beatAnchor) / periodSeconds);
+	double predicted = beatAnchor + k * periodSeconds;
+	double error = t - predicted;
+	if (std::abs(error) < kPhaseWindow * periodSeconds) {
+		beatAnchor = predicted + error * kPhaseGain;
+	} else if (tempoConfidence < kLockConfidence) {
+		beatAnchor = t;
+	}
+}
+
+double OnsetDetector::getOnsetTime() const {
+	return onsetTime;
+}
+
+float OnsetDetector::getOdf() const {
+	return odfPrev;
+}
+
+float OnsetDetector::getTempo() const {
+	return periodSeconds > 0.0f ? 60.0f / periodSeconds : 0.0f;
+}
+
+float OnsetDetector::getTempoConfidence() const {
+	return tempoConfidence;
+}
+
+double OnsetDetector::getNextBeatTime(double now) const {
+	if (periodSeconds <= 0.0f || beatAnchor < 0.0) return 0.0;
+	double beats = std::floor((now - beatAnchor) / periodSeconds) + 1.0;
+	return beatAnchor + std::max(beats, 0.0) * periodSeconds;
+}
+
+OnsetDetector::TrackerState OnsetDetector::getTrackerState() const {
+	TrackerState s;
+	s.bandMean = bandMean;
+	s.odfMean = odfMean;
+	s.odfDeviation = odfDeviation;
+	s.periodSeconds = periodSeconds;
+	s.tempoConfidence = tempoConfidence;
+	s.primed = primed ? 1 : 0;
+	return s;
+}
+
+void OnsetDetector::setTrackerState(const TrackerState& s) {
+	reset();
+	bandMean = s.bandMean;
+	primed = s.primed != 0;
+	odfMean = s.odfMean;
+	odfDeviation = s.odfDeviation;
+	periodSeconds = s.periodSeconds;
+	tempoConfidence = s.tempoConfidence;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "AudioFeatures.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// --- Multi-band onset detection and tempo tracking (analysis thread) ---
+// Each hop, the per-band spectral flux is normalised by its own running mean
+// and combined into an onset detection function (ODF). Onsets are local ODF
+// peaks above an adaptive threshold (running mean + deviation). The tempo is
+// the best-weighted autocorrelation lag of the ODF history, and the beat
+// phase follows detected onsets, giving a predicted next-beat time.
+
+class OnsetDetector {
+public:
+	// The slowly adapting part of the detector, enough to resume warm in a
+	// new session. The ODF history and beat phase are tied to the old audio
+	// clock and rebuild within a few seconds.
+	struct TrackerState {
+		std::array<float, kNumSpectralBands> bandMean{};
+		float odfMean = 1.0f;
+		float odfDeviation = 0.0f;
+		float periodSeconds = 0.0f;
+		float tempoConfidence = 0.0f;
+		uint8_t primed = 0;
+	};
+
+	void setup(float hopSeconds);
+	void reset();
+
+	// Feed one hop; time is the audio-clock time of that hop. Returns true
+	// if an onset was confirmed (timestamped at getOnsetTime())
+	bool process(const std::array<float, kNumSpectralBands>& bandFlux, float rms, double time);
+
+	double getOnsetTime() const;
+	float getOdf() const;             // newest ODF value (normalised, ~1 = average)
+	float getTempo() const;           // BPM, 0 until a tempo is found
+	float getTempoConfidence() const; // 0-1
+	double getNextBeatTime(double now) const; // 0 without a tempo
+
+	TrackerState getTrackerState() const;
+	void setTrackerState(const TrackerState& state);   // after setup()
+
+private:
+	void estimateTempo();
+	void followPhase(double onsetTime);
+
+	float hopSeconds = 0.0f;
+
+	// Per-band running mean flux used for normalisation
+	std::array<float, kNumSpectralBands> bandMean{};
+	bool primed = false;
+
+	// Adaptive threshold state and the two previous ODF values for peak picking
+	float odfMean = 0.0f;
+	float odfDeviation = 0.0f;
+	float odfPrev = 0.0f;
+	float odfPrev2 = 0.0f;
+	double prevTime = 0.0;
+	double onsetTime = -1.0;
+
+	// ODF history ring for the tempo autocorrelation
+	std::vector<float> history;
+	size_t historyHead = 0;
+	size_t historyFilled = 0;
+	std::vector<float> linear;        // history unrolled oldest-first
+	int hopsSinceTempo = 0;
+	int tempoIntervalHops = 1;
+
+	float periodSeconds = 0.0f;
+	float tempoConfidence = 0.0f;
+	double beatAnchor = -1.0;         // time of a beat on the tracked grid
+};
@@ -0,0 +1,215 @@
+#include "PetalBatchRenderer.h"
+#include <algorithm>
+
+namespace {
+// Attribute locations after oF's defaults (position, color, normal, texcoord)
+const int kBasisLocation = 4;
+const int kOriginLocation = 5;
+const int kColorLocation = 6;
+
+const char* kPetalVertexShader = R"(
+#version 330
+uniform mat4 modelViewProjectionMatrix;
+in vec4 position;
+in vec4 instanceBasis;
+in vec4 instanceOrigin;
+in vec4 instanceColor;
+out vec4 vColor;
+void main() {
+	vec2 p = instanceBasis.xy * position.x + instanceBasis.zw * position.y
+	       + instanceOrigin.xy;
+	gl_Position = modelViewProjectionMatrix * vec4(p, instanceOrigin.z, 1.0);
+	vColor = instanceColor;
+}
+)";
+
+const char* kPetalFragmentShader = R"(
+#version 330
+in vec4 vColor;
+out vec4 outputColor;
+void main() {
+	outputColor = vColor;
+}
+)";
+}
+
+void InstancedMeshVbo::setup(const ofVboMesh& mesh) {
+	const auto& verts = mesh.getVertices();
+	vbo.setVertexData(verts.data(), (int)verts.size(), GL_STATIC_DRAW);
+	primitive = ofGetGLPrimitiveMode(mesh.getMode());
+	indexed = mesh.hasIndices();
+	if (indexed) {
+		const auto& idx = mesh.getIndices();
+		vbo.setIndexData(idx.data(), (int)idx.size(), GL_STATIC_DRAW);
+		numElements = (int)idx.size();
+	} else {
+		numElements = (int)verts.size();
+	}
+}
+
+void InstancedMeshVbo::draw(int instances) {
+	if (indexed) {
+		vbo.drawElementsInstanced(primitive, numElements, instances);
+	} else {
+		vbo.drawInstanced(primitive, 0, numElements, instances);
+	}
+}
+
+bool PetalBatchRenderer::setup() {
+	shader.setupShaderFromSource(GL_VERTEX_SHADER, kPetalVertexShader);
+	shader.setupShaderFromSource(GL_FRAGMENT_SHADER, kPetalFragmentShader);
+	shader.bindDefaults();
+	shader.bindAttribute(kBasisLocation, "instanceBasis");
+	shader.bindAttribute(kOriginLocation, "instanceOrigin");
+	shader.bindAttribute(kColorLocation, "instanceColor");
+	ready = shader.linkProgram();
+	if (!ready) {
+		ofLogWarning("PetalBatchRenderer") << "Instanced petal shader failed to link";
+	}
+	return ready;
+}
+
+bool PetalBatchRenderer::isReady() const {
+	return ready;
+}
+
+void PetalBatchRenderer::begin() {
+	for (auto& entry : batches) {
+		entry.second.opaque.clear();
+		entry.second.translucent.clear();
+	}
+	translucent.clear();
+	translucentDrawn = 0;
+	drawCalls = 0;
+	instanceCount = 0;
+}
+
+PetalBatchRenderer::Batch& PetalBatchRenderer::batchFor(const ofVboMesh& mesh) {
+	auto it = batches.find(&mesh);
+	if (it != batches.end()) return it->second;
+
+	// Cached meshes live for the whole run, so their address is a stable key
+	Batch& batch = batches[&mesh];
+	batch.mesh.setup(mesh);
+	return batch;
+}
+
+void PetalBatchRenderer::add(const ofVboMesh& mesh, const PetalInstance& instance) {
+	Batch& batch = batchFor(mesh);
+	if (instance.color.w < 0.999f) {
+		translucent.push_back({&batch, instance, 0});
+	} else {
+		batch.opaque.push_back(instance);
+	}
+}
+
+void PetalBatchRenderer::upload(Batch& batch) {
+	size_t total = batch.opaque.size() + batch.translucent.size();
+	if (total > batch.capacity) {
+		batch.capacity = std::max(total, batch.capacity * 2);
+		batch.instanceBuffer.allocate(batch.capacity * sizeof(PetalInstance), GL_STREAM_DRAW);
+	}
+	size_t opaqueBytes = batch.opaque.size() * sizeof(PetalInstance);
+	if (!batch.opaque.empty()) {
+		batch.instanceBuffer.updateData(0, opaqueBytes, batch.opaque.data());
+	}
+	if (!batch.translucent.empty()) {
+		batch.instanceBuffer.updateData(opaqueBytes,
+			batch.translucent.size() * sizeof(PetalInstance), batch.translucent.data());
+	}
+}
+
+void PetalBatchRenderer::bindInstances(Batch& batch, size_t firstInstance) {
+	int stride = sizeof(PetalInstance);
+	int base = (int)(firstInstance * sizeof(PetalInstance));
+	batch.mesh.vbo.setAttributeBuffer(kBasisLocation, batch.instanceBuffer, 4, stride,
+		base + offsetof(PetalInstance, basis));
+	batch.mesh.vbo.setAttributeBuffer(kOriginLocation, batch.instanceBuffer, 4, stride,
+		base + offsetof(PetalInstance, origin));
+	batch.mesh.vbo.setAttributeBuffer(kColorLocation, batch.instanceBuffer, 4, stride,
+		base + offsetof(PetalInstance, color));
+	batch.mesh.vbo.setAttributeDivisor(kBasisLocation, 1);
+	batch.mesh.vbo.setAttributeDivisor(kOriginLocation, 1);
+	batch.mesh.vbo.setAttributeDivisor(kColorLocation, 1);
+}
+
+void PetalBatchRenderer::drawInstances(Batch& batch, int count) {
+	batch.mesh.draw(count);
+	drawCalls++;
+	instanceCount += count;
+}
+
+void PetalBatchRenderer::draw() {
+	drawOpaque();
+	drawTranslucent();
+}
+
+void PetalBatchRenderer::drawOpaque() {
+	if (!ready) return;
+
+	// Back to front (nearer = larger z); stable keeps each flower's own
+	// layer order for instances on the same rank
+	std::stable_sort(translucent.begin(), translucent.end(),
+		[](const TranslucentEntry& a, const TranslucentEntry& b) {
+			return a.instance.origin.z < b.instance.origin.z;
+		});
+	for (auto& entry : translucent) {
+		entry.index = (uint32_t)entry.batch->translucent.size();
+		entry.batch->translucent.push_back(entry.instance);
+	}
+	translucentDrawn = 0;
+
+	for (auto& entry : batches) {
+		Batch& batch = entry.second;
+		if (!batch.opaque.empty() || !batch.translucent.empty()) upload(batch);
+	}
+
+	// Opaque petals, depth-tested and depth-writing
+	shader.begin();
+	for (auto& entry : batches) {
+		Batch& batch = entry.second;
+		if (batch.opaque.empty()) continue;
+		bindInstances(batch, 0);
+		drawInstances(batch, (int)batch.opaque.size());
+	}
+	shader.end();
+}
+
+bool PetalBatchRenderer::hasTranslucentBehind(float maxDepth) const {
+	return nextTranslucentDepth() < maxDepth;
+}
+
+float PetalBatchRenderer::nextTranslucentDepth() const {
+	if (translucentDrawn >= translucent.size()) return std::numeric_limits<float>::infinity();
+	return translucent[translucentDrawn].instance.origin.z;
+}
+
+void PetalBatchRenderer::drawTranslucent(float maxDepth) {
+	if (!ready || !hasTranslucentBehind(maxDepth)) return;
+
+	// Translucent petals blend over without writing depth, one call per run
+	// of consecutive instances sharing a mesh
+	shader.begin();
+	glDepthMask(GL_FALSE);
+	while (hasTranslucentBehind(maxDepth)) {
+		const TranslucentEntry& first = translucent[translucentDrawn];
+		size_t end = translucentDrawn + 1;
+		while (end < translucent.size() && translucent[end].batch == first.batch
+			&& translucent[end].instance.origin.z < maxDepth) {
+			end++;
+		}
+		bindInstances(*first.batch, first.batch->opaque.size() + first.index);
+		drawInstances(*first.batch, (int)(end - translucentDrawn));
+		translucentDrawn = end;
+	}
+	glDepthMask(GL_TRUE);
+	shader.end();
+}
+
+int PetalBatchRenderer::getDrawCalls() const {
+	return drawCalls;
+}
+
+int PetalBatchRenderer::getInstanceCount() const {
+	return instanceCount;
+}
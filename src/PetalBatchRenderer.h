@@ -0,0 +1,85 @@
+#pragma once
+#include "ofMain.h"
+#include <limits>
+#include <unordered_map>
+
+// --- Per-petal instance data, packed for the instanced petal shader ---
+
+struct PetalInstance {
+	glm::vec4 basis;    // 2x2 linear part: (col0.x, col0.y, col1.x, col1.y)
+	glm::vec4 origin;   // xy = screen position, z = depth (nearer = larger)
+	glm::vec4 color;    // normalized RGBA
+};
+
+// --- A cached mesh copied into its own VBO for instanced drawing ---
+// The VBO carries the mesh's static attributes; callers bind their own
+// per-instance attribute buffers before drawing.
+
+struct InstancedMeshVbo {
+	ofVbo vbo;
+	GLenum primitive = GL_TRIANGLES;
+	int numElements = 0;
+	bool indexed = false;
+
+	void setup(const ofVboMesh& mesh);
+	void draw(int instances);
+};
+
+// --- Instanced petal renderer ---
+// Petals are bucketed by their cached unit mesh and each bucket is drawn with
+// one glDrawElementsInstanced call. Opaque petals write depth; translucent
+// ones (growing/dying flowers) are drawn afterwards with depth writes off so
+// they blend instead of occluding whatever happens to be drawn later. Blending
+// needs painter's order, so translucent instances are sorted back to front by
+// depth across all buckets and drawn in runs of consecutive same-mesh
+// instances; drawTranslucent(maxDepth) lets the caller interleave other
+// translucent geometry (stems) at the right depth.
+
+class PetalBatchRenderer {
+public:
+	bool setup();
+	bool isReady() const;
+
+	void begin();                                         // clear all buckets
+	void add(const ofVboMesh& mesh, const PetalInstance& instance);
+	void draw();                                          // drawOpaque() + drawTranslucent()
+
+	// Both expect depth test enabled. drawOpaque() uploads and sorts all
+	// instances; drawTranslucent() then draws the translucent instances behind
+	// maxDepth that have not been drawn yet.
+	void drawOpaque();
+	void drawTranslucent(float maxDepth = std::numeric_limits<float>::infinity());
+	bool hasTranslucentBehind(float maxDepth) const;
+	float nextTranslucentDepth() const;                   // infinity once all are drawn
+
+	int getDrawCalls() const;
+	int getInstanceCount() const;
+
+private:
+	struct Batch {
+		InstancedMeshVbo mesh;
+		std::vector<PetalInstance> opaque;
+		std::vector<PetalInstance> translucent;
+		ofBufferObject instanceBuffer;
+		size_t capacity = 0;               // instances the buffer can hold
+	};
+
+	struct TranslucentEntry {
+		Batch* batch;                      // map nodes are stable
+		PetalInstance instance;
+		uint32_t index;                    // within the batch's translucent region, set when sorted
+	};
+
+	Batch& batchFor(const ofVboMesh& mesh);
+	void upload(Batch& batch);
+	void bindInstances(Batch& batch, size_t firstInstance);
+	void drawInstances(Batch& batch, int count);
+
+	std::unordered_map<const ofVboMesh*, Batch> batches;
+	std::vector<TranslucentEntry> translucent;   // all buckets, back to front once sorted
+	size_t translucentDrawn = 0;
+	ofShader shader;
+	bool ready = false;
+	int drawCalls = 0;
+	int instanceCount = 0;
+};
@@ -0,0 +1,119 @@
+#include "Profiler.h"
+
+Profiler& Profiler::shared() {
+	static Profiler profiler;
+	return profiler;
+}
+
+void Profiler::setEnabled(bool e) {
+	enabled.store(e, std::memory_order_relaxed);
+}
+
+bool Profiler::isEnabled() const {
+	return enabled.load(std::memory_order_relaxed);
+}
+
+void Profiler::addTime(ProfileStage stage, int64_t ns) {
+	auto& totals = workerThread ? workerNs : stageNs;
+	totals[(int)stage].fetch_add(ns, std::memory_order_relaxed);
+}
+
+void Profiler::markWorkerThread() {
+	workerThread = true;
+}
+
+void Profiler::addCount(ProfileCounter counter, int64_t n) {
+	counters[(int)counter].fetch_add(n, std::memory_order_relaxed);
+}
+
+void Profiler::setCount(ProfileCounter counter, int64_t n) {
+	counters[(int)counter].store(n, std::memory_order_relaxed);
+}
+
+void Profiler::endFrame(float frameSeconds) {
+	// Work from other threads lands in whichever frame is open when it
+	// finishes, so analysis time reads as "per display frame"
+	Frame& f = history[head];
+	for (int i = 0; i < kNumStages; i++) {
+		f.stageMs[i] = stageNs[i].exchange(0, std::memory_order_relaxed) * 1e-6f;
+		f.workerMs[i] = workerNs[i].exchange(0, std::memory_order_relaxed) * 1e-6f;
+	}
+	f.frameMs = frameSeconds * 1000.0f;
+	for (int i = 0; i < kNumCounters; i++) {
+		lastCounts[i] = counters[i].exchange(0, std::memory_order_relaxed);
+	}
+	head = (head + 1) % kHistory;
+	filled = std::min(filled + 1, kHistory);
+}
+
+int Profiler::getFrameCount() const {
+	return filled;
+}
+
+int Profiler::indexOf(int framesAgo) const {
+	return (head - 1 - framesAgo + 2 * kHistory) % kHistory;
+}
+
+float Profiler::getStageMs(int framesAgo, ProfileStage stage) const {
+	if (framesAgo >= filled) return 0.0f;
+	return history[indexOf(framesAgo)].stageMs[(int)stage];
+}
+
+float Profiler::getWorkerStageMs(int framesAgo, ProfileStage stage) const {
+	if (framesAgo >= filled) return 0.0f;
+	return history[indexOf(framesAgo)].workerMs[(int)stage];
+}
+
+float Profiler::getFrameMs(int framesAgo) const {
+	if (framesAgo >= filled) return 0.0f;
+	return history[indexOf(framesAgo)].frameMs;
+}
+
+float Profiler::percentileOf(std::vector<float>& values, float p) const {
+	if (values.empty()) return 0.0f;
+	size_t k = std::min(values.size() - 1, (size_t)(p * (values.size() - 1) + 0.5f));
+	std::nth_element(values.begin(), values.begin() + k, values.end());
+	return values[k];
+}
+
+float Profiler::getStagePercentile(ProfileStage stage, float p) const {
+	scratch.clear();
+	for (int i = 0; i < filled; i++) scratch.push_back(history[i].stageMs[(int)stage]);
+	return percentileOf(scratch, p);
+}
+
+float Profiler::getWorkerStagePercentile(ProfileStage stage, float p) const {
+	scratch.clear();
+	for (int i = 0; i < filled; i++) scratch.push_back(history[i].workerMs[(int)stage]);
+	return percentileOf(scratch, p);
+}
+
+float Profiler::getFramePercentile(float p) const {
+	scratch.clear();
+	for (int i = 0; i < filled; i++) scratch.push_back(history[i].frameMs);
+	return percentileOf(scratch, p);
+}
+
+int64_t Profiler::getCount(ProfileCounter counter) const {
+	return lastCounts[(int)counter];
+}
+
+const char* Profiler::stageName(ProfileStage stage) {
+	switch (stage) {
+		case ProfileStage::AUDIO_HANDOFF:   return "audio handoff";
+		case ProfileStage::ANALYSIS:        return "analysis (bg)";
+		case ProfileStage::FIELD_LIFECYCLE: return "lifecycle";
+		case ProfileStage::FIELD_SPAWNS:    return "spawns";
+		case ProfileStage::FIELD_ORDER:     return "draw order";
+		case ProfileStage::FIELD_ERASE:     return "erase";
+		case ProfileStage::GEOMETRY:        return "geometry";
+		case ProfileStage::FIELD_DRAW:      return "field draw";
+		case ProfileStage::FALLING_PETALS:  return "falling petals";
+		default:                            return "?";
+	}
+}
+
+bool Profiler::isMainThreadStage(ProfileStage stage) {
+	// Audio handoff is mostly the main-thread pickup; the ring push is tiny
+	return stage != ProfileStage::ANALYSIS;
+}
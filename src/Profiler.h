@@ -0,0 +1,130 @@
+#pragma once
+#include "ofMain.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+// --- Profiled stages ---
+// Timers are exclusive: a nested timer's time is subtracted from its parent,
+// so stages can be stacked without double counting. Nesting is per thread, so
+// time on worker-pool threads can't be subtracted from the main-thread stage
+// that dispatched it; it is kept in separate worker totals instead. A stage's
+// main-thread time is wall time on that thread (a parallel loop counts its
+// whole span), its worker time is summed across workers and can exceed it.
+
+enum class ProfileStage {
+	AUDIO_HANDOFF,      // ring push (audio thread) + feature pickup (main)
+	ANALYSIS,           // Essentia compute calls (analysis thread)
+	FIELD_LIFECYCLE,    // parallel per-flower update
+	FIELD_SPAWNS,       // new flowers, respawns, falling-petal spawns
+	FIELD_ORDER,        // draw-order insert/erase
+	FIELD_ERASE,        // removal of dead flowers
+	GEOMETRY,           // Inflorescence / Stem rebuilds
+	FIELD_DRAW,         // flower field draw submission
+	FALLING_PETALS,     // falling petal update + draw
+	COUNT
+};
+
+enum class ProfileCounter {
+	DRAW_CALLS,         // mesh draw submissions this frame
+	REBUILDS,           // Inflorescence / Stem rebuild() calls this frame
+	MESH_BUILDS,        // petal meshes tessellated into the cache this frame
+	FALLING_PETALS,     // active falling petals
+	INSTANCES,          // live flowers
+	COUNT
+};
+
+// --- Frame profiler ---
+// Any thread adds into atomic per-stage accumulators; once per frame the main
+// thread swaps them out into a fixed history ring that the overlay reads.
+
+class Profiler {
+public:
+	static const int kHistory = 240;
+	static const int kNumStages = (int)ProfileStage::COUNT;
+	static const int kNumCounters = (int)ProfileCounter::COUNT;
+
+	static Profiler& shared();
+
+	void setEnabled(bool enabled);
+	bool isEnabled() const;
+
+	// Any thread, lock-free; worker-pool threads land in the worker totals
+	void addTime(ProfileStage stage, int64_t ns);
+	static void markWorkerThread();       // called once by each pool worker
+	void addCount(ProfileCounter counter, int64_t n = 1);
+	void setCount(ProfileCounter counter, int64_t n);
+
+	// Main thread, once per frame: closes the frame into the history ring
+	void endFrame(float frameSeconds);
+
+	// Main thread readers; framesAgo = 0 is the newest complete frame
+	int getFrameCount() const;
+	float getStageMs(int framesAgo, ProfileStage stage) const;
+	float getWorkerStageMs(int framesAgo, ProfileStage stage) const;   // summed over workers
+	float getFrameMs(int framesAgo) const;
+	float getStagePercentile(ProfileStage stage, float p) const;
+	float getWorkerStagePercentile(ProfileStage stage, float p) const;
+	float getFramePercentile(float p) const;
+	int64_t getCount(ProfileCounter counter) const;
+
+	static const char* stageName(ProfileStage stage);
+	static bool isMainThreadStage(ProfileStage stage);
+
+private:
+	struct Frame {
+		std::array<float, kNumStages> stageMs;
+		std::array<float, kNumStages> workerMs;
+		float frameMs = 0.0f;
+	};
+
+	int indexOf(int framesAgo) const;
+	float percentileOf(std::vector<float>& values, float p) const;
+
+	std::array<std::atomic<int64_t>, kNumStages> stageNs{};
+	std::array<std::atomic<int64_t>, kNumStages> workerNs{};
+	std::array<std::atomic<int64_t>, kNumCounters> counters{};
+	std::array<int64_t, kNumCounters> lastCounts{};
+	std::array<Frame, kHistory> history{};
+	int head = 0;                     // next slot to write
+	int filled = 0;
+	std::atomic<bool> enabled{true};
+	mutable std::vector<float> scratch;
+
+	static inline thread_local bool workerThread = false;
+};
+
+// --- Scoped stage timer ---
+
+class ScopedTimer {
+public:
+	explicit ScopedTimer(ProfileStage s)
+		: stage(s), active(Profiler::shared().isEnabled()) {
+		if (!active) return;
+		parent = current;
+		current = this;
+		start = std::chrono::steady_clock::now();
+	}
+
+	~ScopedTimer() {
+		if (!active) return;
+		int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - start).count();
+		Profiler::shared().addTime(stage, ns - childNs);
+		if (parent) parent->childNs += ns;
+		current = parent;
+	}
+
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+	static inline thread_local ScopedTimer* current = nullptr;
+
+	ProfileStage stage;
+	bool active;
+	ScopedTimer* parent = nullptr;
+	int64_t childNs = 0;
+	std::chrono::steady_clock::time_point start;
+};
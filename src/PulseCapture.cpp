@@ -0,0 +1,380 @@
+#include "PulseCapture.h"
+#include "Profiler.h"
+
+namespace {
+const char* kClientName = "musicalFlower";
+const char* kStreamName = "musicalFlower capture";
+const pa_usec_t kReconnectDelay = 2 * PA_USEC_PER_SEC;
+
+void dropOperation(pa_operation* op) {
+	if (op) pa_operation_unref(op);
+}
+}
+
+PulseCapture::~PulseCapture() {
+	stop();
+}
+
+bool PulseCapture::start(AudioRingBuffer& r, int rate, int frames) {
+	if (mainloop) return isRunning();
+	ring = &r;
+	sampleRate = rate;
+	quantum = frames;
+
+	mainloop = pa_threaded_mainloop_new();
+	if (!mainloop) return false;
+	everReady = false;
+
+	pa_threaded_mainloop_lock(mainloop);
+	bool ok = connectContext() && pa_threaded_mainloop_start(mainloop) >= 0;
+	// The state callback signals on every change; wait for a final one
+	while (ok) {
+		pa_context_state_t state = pa_context_get_state(context);
+		if (state == PA_CONTEXT_READY) break;
+		if (state == PA_CONTEXT_FAILED || state == PA_CONTEXT_TERMINATED) {
+			ok = false;
+			break;
+		}
+		pa_threaded_mainloop_wait(mainloop);
+	}
+	if (!ok) {
+		ofLogWarning("PulseCapture") << "No PulseAudio/PipeWire server: "
+			<< pa_strerror(pa_context_errno(context));
+	}
+	pa_threaded_mainloop_unlock(mainloop);
+
+	if (!ok) stop();
+	return ok;
+}
+
+void PulseCapture::stop() {
+	if (!mainloop) return;
+	pa_threaded_mainloop_lock(mainloop);
+	ready = false;
+	everReady = false;
+	if (reconnectEvent) pa_threaded_mainloop_get_api(mainloop)->time_free(reconnectEvent);
+	reconnectEvent = nullptr;
+	// Detach the callbacks first so our own disconnect isn't mistaken for a failure
+	if (stream) {
+		pa_stream_set_state_callback(stream, nullptr, nullptr);
+		pa_stream_set_read_callback(stream, nullptr, nullptr);
+		pa_stream_disconnect(stream);
+	}
+	if (context) {
+		pa_context_set_state_callback(context, nullptr, nullptr);
+		pa_context_set_subscribe_callback(context, nullptr, nullptr);
+		pa_context_disconnect(context);
+	}
+	pa_threaded_mainloop_unlock(mainloop);
+	pa_threaded_mainloop_stop(mainloop);
+
+	if (stream) pa_stream_unref(stream);
+	if (context) pa_context_unref(context);
+	pa_threaded_mainloop_free(mainloop);
+	stream = nullptr;
+	context = nullptr;
+	mainloop = nullptr;
+	sourceName.clear();
+	sinkIndex = candidateSink = PA_INVALID_INDEX;
+	refreshing = refreshAgain = false;
+}
+
+bool PulseCapture::isStarted() const {
+	return mainloop != nullptr;
+}
+
+bool PulseCapture::isRunning() const {
+	return ready.load(std::memory_order_acquire);
+}
+
+void PulseCapture::setQuantum(int frames) {
+	quantum = frames;
+	if (!mainloop) return;
+	pa_threaded_mainloop_lock(mainloop);
+	if (stream && pa_stream_get_state(stream) == PA_STREAM_READY) {
+		pa_buffer_attr attr = bufferAttr();
+		dropOperation(pa_stream_set_buffer_attr(stream, &attr, nullptr, nullptr));
+	}
+	pa_threaded_mainloop_unlock(mainloop);
+}
+
+int PulseCapture::getQuantum() const {
+	return quantum;
+}
+
+std::string PulseCapture::getSourceName() const {
+	if (!mainloop) return "";
+	pa_threaded_mainloop_lock(mainloop);
+	std::string name = sourceName;
+	pa_threaded_mainloop_unlock(mainloop);
+	return name;
+}
+
+pa_buffer_attr PulseCapture::bufferAttr() const {
+	// Only fragsize matters for recording; -1 lets the server pick the rest
+	pa_buffer_attr attr;
+	attr.maxlength = (uint32_t)-1;
+	attr.tlength = (uint32_t)-1;
+	attr.prebuf = (uint32_t)-1;
+	attr.minreq = (uint32_t)-1;
+	attr.fragsize = (uint32_t)(quantum * sizeof(float));
+	return attr;
+}
+
+// ============================================================
+// Connection and recovery (mainloop thread, or before it starts)
+// ============================================================
+
+// Drops any previous context and its stream, then connects a fresh one
+bool PulseCapture::connectContext() {
+	releaseStream();
+	if (context) {
+		pa_context_set_state_callback(context, nullptr, nullptr);
+		pa_context_set_subscribe_callback(context, nullptr, nullptr);
+		pa_context_disconnect(context);
+		pa_context_unref(context);
+	}
+	sinkIndex = candidateSink = PA_INVALID_INDEX;
+	refreshing = refreshAgain = false;
+
+	context = pa_context_new(pa_threaded_mainloop_get_api(mainloop), kClientName);
+	if (!context) return false;
+	pa_context_set_state_callback(context, &PulseCapture::onContextState, this);
+	if (pa_context_connect(context, nullptr, PA_CONTEXT_NOAUTOSPAWN, nullptr) < 0) {
+		if (everReady) scheduleReconnect();
+		return false;
+	}
+	return true;
+}
+
+void PulseCapture::scheduleReconnect() {
+	if (reconnectEvent || !context) return;
+	reconnectEvent = pa_context_rttime_new(context, pa_rtclock_now() + kReconnectDelay,
+		&PulseCapture::onReconnectTimer, this);
+}
+
+void PulseCapture::releaseStream() {
+	if (stream) {
+		pa_stream_set_state_callback(stream, nullptr, nullptr);
+		pa_stream_set_read_callback(stream, nullptr, nullptr);
+		// A stream still connecting must be disconnected too, or it lingers on the server
+		if (PA_STREAM_IS_GOOD(pa_stream_get_state(stream))) pa_stream_disconnect(stream);
+		pa_stream_unref(stream);
+		stream = nullptr;
+	}
+	// An empty name makes the next useSource() connect a new stream
+	sourceName.clear();
+}
+
+// ============================================================
+// Target selection (mainloop thread)
+// ============================================================
+
+// Prefer the sink already being recorded while it still plays, otherwise the
+// first sink with uncorked playback, otherwise the default sink
+void PulseCapture::refreshTarget() {
+	if (refreshing) {
+		refreshAgain = true;
+		return;
+	}
+	refreshing = true;
+	candidateSink = PA_INVALID_INDEX;
+	dropOperation(pa_context_get_sink_input_info_list(context, &PulseCapture::onSinkInput, this));
+}
+
+void PulseCapture::finishRefresh() {
+	refreshing = false;
+	if (refreshAgain) {
+		refreshAgain = false;
+		refreshTarget();
+	}
+}
+
+void PulseCapture::useSource(const std::string& monitor, uint32_t sink) {
+	sinkIndex = sink;
+	if (monitor == sourceName) return;
+	sourceName = monitor;
+	ofLogNotice("PulseCapture") << "Recording from " << monitor;
+
+	if (!stream) {
+		connectStream();
+	} else {
+		// Moving keeps the stream, so the ring never sees a gap
+		dropOperation(pa_context_move_source_output_by_name(context,
+			pa_stream_get_index(stream), monitor.c_str(), nullptr, nullptr));
+	}
+}
+
+void PulseCapture::connectStream() {
+	pa_sample_spec spec;
+	spec.format = PA_SAMPLE_FLOAT32LE;
+	spec.rate = (uint32_t)sampleRate;
+	spec.channels = 1;
+	stream = pa_stream_new(context, kStreamName, &spec, nullptr);
+	if (!stream) {
+		ofLogError("PulseCapture") << "Could not create stream: " << pa_strerror(pa_context_errno(context));
+		return;
+	}
+	pa_stream_set_state_callback(stream, &PulseCapture::onStreamState, this);
+	pa_stream_set_read_callback(stream, &PulseCapture::onRead, this);
+
+	pa_buffer_attr attr = bufferAttr();
+	pa_stream_flags_t flags = (pa_stream_flags_t)(PA_STREAM_ADJUST_LATENCY
+		| PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE);
+	if (pa_stream_connect_record(stream, sourceName.c_str(), &attr, flags) < 0) {
+		ofLogError("PulseCapture") << "Could not record from " << sourceName << ": "
+			<< pa_strerror(pa_context_errno(context));
+		releaseStream();
+	}
+}
+
+// ============================================================
+// libpulse callbacks (mainloop thread, lock held)
+// ============================================================
+
+void PulseCapture::onContextState(pa_context* c, void* self) {
+	PulseCapture* capture = (PulseCapture*)self;
+	switch (pa_context_get_state(c)) {
+	case PA_CONTEXT_READY:
+		if (capture->everReady) ofLogNotice("PulseCapture") << "Reconnected to the sound server";
+		capture->ready = true;
+		capture->everReady = true;
+		pa_context_set_subscribe_callback(c, &PulseCapture::onSubscribe, self);
+		dropOperation(pa_context_subscribe(c, (pa_subscription_mask_t)(PA_SUBSCRIPTION_MASK_SINK_INPUT
+			| PA_SUBSCRIPTION_MASK_SINK | PA_SUBSCRIPTION_MASK_SERVER), nullptr, nullptr));
+		capture->refreshTarget();
+		break;
+	case PA_CONTEXT_FAILED:
+	case PA_CONTEXT_TERMINATED:
+		if (capture->ready) ofLogWarning("PulseCapture") << "Disconnected from the sound server, reconnecting";
+		capture->ready = false;
+		capture->releaseStream();
+		// The context can't come back by itself; a timer builds a new one
+		if (capture->everReady) capture->scheduleReconnect();
+		break;
+	default:
+		break;
+	}
+	pa_threaded_mainloop_signal(capture->mainloop, 0);
+}
+
+void PulseCapture::onSubscribe(pa_context* c, pa_subscription_event_type_t type, uint32_t index, void* self) {
+	int facility = type & PA_SUBSCRIPTION_EVENT_FACILITY_MASK;
+	int kind = type & PA_SUBSCRIPTION_EVENT_TYPE_MASK;
+	// Playback starting/stopping/moving (sink inputs), sinks going away, or
+	// a new default sink can all change the monitor worth recording
+	bool relevant = facility == PA_SUBSCRIPTION_EVENT_SINK_INPUT
+		|| facility == PA_SUBSCRIPTION_EVENT_SERVER
+		|| (facility == PA_SUBSCRIPTION_EVENT_SINK && kind == PA_SUBSCRIPTION_EVENT_REMOVE);
+	if (relevant) ((PulseCapture*)self)->refreshTarget();
+}
+
+void PulseCapture::onSinkInput(pa_context* c, const pa_sink_input_info* info, int eol, void* self) {
+	PulseCapture* capture = (PulseCapture*)self;
+	if (eol < 0) {
+		capture->finishRefresh();
+		return;
+	}
+	if (!eol) {
+		if (!info->corked) {
+			if (info->sink == capture->sinkIndex || capture->candidateSink == PA_INVALID_INDEX) {
+				capture->candidateSink = info->sink;
+			}
+		}
+		return;
+	}
+
+	if (capture->candidateSink != PA_INVALID_INDEX) {
+		dropOperation(pa_context_get_sink_info_by_index(c, capture->candidateSink, &PulseCapture::onSinkInfo, self));
+	} else if (capture->sourceName.empty()) {
+		dropOperation(pa_context_get_server_info(c, &PulseCapture::onServerInfo, self));
+	} else {
+		// Nothing playing: keep recording the last monitor until something starts
+		capture->finishRefresh();
+	}
+}
+
+void PulseCapture::onServerInfo(pa_context* c, const pa_server_info* info, void* self) {
+	if (!info || !info->default_sink_name) {
+		((PulseCapture*)self)->finishRefresh();
+		return;
+	}
+	dropOperation(pa_context_get_sink_info_by_name(c, info->default_sink_name, &PulseCapture::onSinkInfo, self));
+}
+
+void PulseCapture::onSinkInfo(pa_context* c, const pa_sink_info* info, int eol, void* self) {
+	PulseCapture* capture = (PulseCapture*)self;
+	if (!eol && info && info->monitor_source_name) {
+		capture->useSource(info->monitor_source_name, info->index);
+		return;
+	}
+	capture->finishRefresh();
+}
+
+void PulseCapture::onStreamState(pa_stream* s, void* self) {
+	PulseCapture* capture = (PulseCapture*)self;
+	switch (pa_stream_get_state(s)) {
+	case PA_STREAM_READY: {
+		const pa_buffer_attr* attr = pa_stream_get_buffer_attr(s);
+		ofLogNotice("PulseCapture") << "Capturing " << (attr ? attr->fragsize / sizeof(float) : 0)
+			<< "-frame fragments (requested " << capture->quantum << ")";
+		break;
+	}
+	case PA_STREAM_FAILED:
+	case PA_STREAM_TERMINATED:
+		// The source went away (device unplugged, sink removed): drop the
+		// dead stream and let a refresh pick a monitor and connect anew.
+		// libpulse holds its own reference while this callback runs.
+		ofLogWarning("PulseCapture") << "Capture stream ended: "
+			<< pa_strerror(pa_context_errno(capture->context));
+		capture->releaseStream();
+		capture->sinkIndex = PA_INVALID_INDEX;
+		if (pa_context_get_state(capture->context) == PA_CONTEXT_READY) capture->refreshTarget();
+		break;
+	default:
+		break;
+	}
+}
+
+void PulseCapture::onReconnectTimer(pa_mainloop_api* api, pa_time_event* e, const struct timeval* tv, void* self) {
+	PulseCapture* capture = (PulseCapture*)self;
+	api->time_free(e);
+	capture->reconnectEvent = nullptr;
+	capture->connectContext();
+}
+
+void PulseCapture::onRead(pa_stream* s, size_t bytes, void* self) {
+	// Same contract as ofApp::audioIn: no locks beyond libpulse's, no allocation
+	PulseCapture* capture = (PulseCapture*)self;
+	ScopedTimer timer(ProfileStage::AUDIO_HANDOFF);
+
+	// Record latency is the age of the oldest queued sample, so a fragment's
+	// newest sample was captured (latency - frames read up to it) ago
+	int64_t now = audioClockNs();
+	int64_t latencyNs = 0;
+	pa_usec_t usec;
+	int negative = 0;
+	if (pa_stream_get_latency(s, &usec, &negative) == 0 && !negative) latencyNs = (int64_t)usec * 1000;
+	const double nsPerFrame = 1e9 / capture->sampleRate;
+	size_t consumed = 0;
+
+	const void* data;
+	size_t n;
+	while (pa_stream_readable_size(s) > 0) {
+		if (pa_stream_peek(s, &data, &n) < 0 || n == 0) return;
+		size_t frames = n / sizeof(float);
+		consumed += frames;
+		int64_t captureNs = std::min(now, now - latencyNs + (int64_t)(consumed * nsPerFrame));
+		if (data) {
+			capture->ring->push((const float*)data, frames, now, captureNs);
+		} else {
+			// Hole in the server buffer: keep sample time continuous
+			while (frames > 0) {
+				size_t chunk = std::min(frames, capture->silence.size());
+				capture->ring->push(capture->silence.data(), chunk, now, captureNs);
+				frames -= chunk;
+			}
+		}
+		pa_stream_drop(s);
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "ofMain.h"
+#include "AudioRingBuffer.h"
+#include <pulse/pulseaudio.h>
+#include <array>
+#include <atomic>
+
+// --- Native PulseAudio / PipeWire capture ---
+// Records mono float32 straight from the monitor of the sink that is
+// currently playing, on libpulse's threaded mainloop (pipewire-pulse serves
+// the same API). Sink-input, sink and server events are subscribed to, so
+// playback that starts, stops or moves after launch re-targets the stream
+// in place. Fragments are pushed into the analysis ring as they arrive;
+// the quantum sets the fragment size and so the capture latency. A stream
+// that fails (its device went away) is dropped and recreated on the next
+// target refresh; a context lost after connecting (server restart) is
+// rebuilt every couple of seconds until the server answers again.
+
+class PulseCapture {
+public:
+	~PulseCapture();
+
+	// Blocks until the server answers; false if none is reachable
+	bool start(AudioRingBuffer& ring, int sampleRate, int quantum);
+	void stop();
+	bool isStarted() const;              // started, even while reconnecting
+	bool isRunning() const;              // connected to the server
+
+	// Main thread: request a new fragment size (frames) without reconnecting
+	void setQuantum(int frames);
+	int getQuantum() const;
+
+	std::string getSourceName() const;   // monitor being recorded, empty until connected
+
+private:
+	static void onContextState(pa_context* c, void* self);
+	static void onSubscribe(pa_context* c, pa_subscription_event_type_t type, uint32_t index, void* self);
+	static void onSinkInput(pa_context* c, const pa_sink_input_info* info, int eol, void* self);
+	static void onServerInfo(pa_context* c, const pa_server_info* info, void* self);
+	static void onSinkInfo(pa_context* c, const pa_sink_info* info, int eol, void* self);
+	static void onStreamState(pa_stream* s, void* self);
+	static void onRead(pa_stream* s, size_t bytes, void* self);
+	static void onReconnectTimer(pa_mainloop_api* api, pa_time_event* e, const struct timeval* tv, void* self);
+
+	// Mainloop thread (lock held)
+	bool connectContext();
+	void scheduleReconnect();
+	void releaseStream();
+	void refreshTarget();
+	void finishRefresh();
+	void useSource(const std::string& monitor, uint32_t sink);
+	void connectStream();
+	pa_buffer_attr bufferAttr() const;
+
+	AudioRingBuffer* ring = nullptr;
+	int sampleRate = 44100;
+	std::atomic<int> quantum{512};
+
+	pa_threaded_mainloop* mainloop = nullptr;
+	pa_context* context = nullptr;
+	pa_stream* stream = nullptr;
+	std::atomic<bool> ready{false};             // context connected
+	bool everReady = false;                     // reconnect only after a first success
+	pa_time_event* reconnectEvent = nullptr;
+
+	// Guarded by the mainloop lock
+	std::string sourceName;
+	uint32_t sinkIndex = PA_INVALID_INDEX;      // sink whose monitor we record
+	uint32_t candidateSink = PA_INVALID_INDEX;  // sink chosen by the running refresh
+	bool refreshing = false;
+	bool refreshAgain = false;
+
+	std::array<float, 1024> silence{};          // pushed for holes so the audio clock keeps time
+};
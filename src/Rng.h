@@ -0,0 +1,166 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// --- Counter-based random streams (Philox4x32-10) ---
+// Output is a pure function of (key, counter): a stream needs no shared
+// state, any number of independent streams can be derived from one seed,
+// and blocks can be generated in any order or in parallel with the same
+// result. Used instead of oF's global RNG so parallel updates, the bench
+// and offline renders reproduce exactly from a seed.
+
+namespace philox {
+
+const uint32_t kM0 = 0xD2511F53u;
+const uint32_t kM1 = 0xCD9E8D57u;
+const uint32_t kW0 = 0x9E3779B9u;
+const uint32_t kW1 = 0xBB67AE85u;
+const int kRounds = 10;
+const size_t kLanes = 8;   // blocks computed side by side in blocks()
+
+inline uint64_t mix64(uint64_t z) {
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+// One 128-bit block for a 64-bit counter
+inline std::array<uint32_t, 4> block(uint64_t counter, uint64_t key) {
+	uint32_t c0 = (uint32_t)counter, c1 = (uint32_t)(counter >> 32), c2 = 0, c3 = 0;
+	uint32_t k0 = (uint32_t)key, k1 = (uint32_t)(key >> 32);
+	for (int r = 0; r < kRounds; r++) {
+		uint64_t p0 = (uint64_t)kM0 * c0;
+		uint64_t p1 = (uint64_t)kM1 * c2;
+		uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+		uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+		c1 = (uint32_t)p1;
+		c3 = (uint32_t)p0;
+		c0 = n0;
+		c2 = n2;
+		k0 += kW0;
+		k1 += kW1;
+	}
+	return {c0, c1, c2, c3};
+}
+
+// nBlocks consecutive blocks from counter, 4 words each, equal to calling
+// block() per counter. Lanes are independent so the rounds vectorise.
+inline void blocks(uint64_t counter, uint64_t key, uint32_t* out, size_t nBlocks) {
+	size_t b = 0;
+	for (; b + kLanes <= nBlocks; b += kLanes) {
+		uint32_t c0[kLanes], c1[kLanes], c2[kLanes], c3[kLanes];
+		for (size_t l = 0; l < kLanes; l++) {
+			uint64_t ctr = counter + b + l;
+			c0[l] = (uint32_t)ctr;
+			c1[l] = (uint32_t)(ctr >> 32);
+			c2[l] = 0;
+			c3[l] = 0;
+		}
+		uint32_t k0 = (uint32_t)key, k1 = (uint32_t)(key >> 32);
+		for (int r = 0; r < kRounds; r++) {
+			for (size_t l = 0; l < kLanes; l++) {
+				uint64_t p0 = (uint64_t)kM0 * c0[l];
+				uint64_t p1 = (uint64_t)kM1 * c2[l];
+				uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1[l] ^ k0;
+				uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3[l] ^ k1;
+				c1[l] = (uint32_t)p1;
+				c3[l] = (uint32_t)p0;
+				c0[l] = n0;
+				c2[l] = n2;
+			}
+			k0 += kW0;
+			k1 += kW1;
+		}
+		for (size_t l = 0; l < kLanes; l++) {
+			uint32_t* o = out + 4 * (b + l);
+			o[0] = c0[l];
+			o[1] = c1[l];
+			o[2] = c2[l];
+			o[3] = c3[l];
+		}
+	}
+	for (; b < nBlocks; b++) {
+		auto r = block(counter + b, key);
+		for (int w = 0; w < 4; w++) out[4 * b + w] = r[w];
+	}
+}
+
+inline float toUnit(uint32_t v) {
+	return (v >> 8) * (1.0f / 16777216.0f);   // [0, 1)
+}
+
+}
+
+class RngStream {
+public:
+	RngStream() = default;
+	// Stream `id` of `seed`; distinct ids give independent sequences
+	RngStream(uint64_t seed, uint64_t id) : key(philox::mix64(seed ^ philox::mix64(id + 1))) {}
+
+	// Child stream keyed off this stream's next output; advances this one
+	RngStream fork() {
+		uint64_t id = ((uint64_t)nextU32() << 32) | nextU32();
+		return RngStream(key, id);
+	}
+
+	uint32_t nextU32() {
+		if (used == 4) {
+			buffer = philox::block(counter++, key);
+			used = 0;
+		}
+		return buffer[used++];
+	}
+
+	float uniform() { return philox::toUnit(nextU32()); }
+	float uniform(float hi) { return uniform() * hi; }
+	float uniform(float lo, float hi) { return lo + uniform() * (hi - lo); }   // as ofRandom(lo, hi)
+	int range(int lo, int hi) { return lo + (int)(uniform() * (hi - lo)); }    // [lo, hi)
+	bool chance(float p) { return uniform() < p; }
+
+	// n values in [0, 1), the same ones n calls to uniform() would return;
+	// whole blocks go through the lane-parallel generator
+	void fill(float* out, size_t n) {
+		size_t i = 0;
+		while (i < n && used < 4) out[i++] = philox::toUnit(buffer[used++]);
+		uint32_t words[4 * philox::kLanes];
+		while (n - i >= 4 * philox::kLanes) {
+			philox::blocks(counter, key, words, philox::kLanes);
+			counter += philox::kLanes;
+			for (uint32_t w : words) out[i++] = philox::toUnit(w);
+		}
+		while (i < n) out[i++] = uniform();
+	}
+
+private:
+	uint64_t key = 0;
+	uint64_t counter = 0;
+	std::array<uint32_t, 4> buffer{};
+	int used = 4;
+};
+
+// Pre-drawn uniforms handed out in order, for code that rolls many values
+// at once (a whole genome); refills from the stream if it runs out
+template <size_t N>
+class RngBatch {
+public:
+	explicit RngBatch(RngStream& stream) : stream(stream) { stream.fill(values.data(), N); }
+
+	float operator()(float lo, float hi) { return lo + next() * (hi - lo); }
+	float operator()(float hi) { return next() * hi; }
+	int range(int lo, int hi) { return lo + (int)(next() * (hi - lo)); }
+	bool chance(float p) { return next() < p; }
+
+private:
+	float next() {
+		if (pos == N) {
+			stream.fill(values.data(), N);
+			pos = 0;
+		}
+		return values[pos++];
+	}
+
+	RngStream& stream;
+	std::array<float, N> values;
+	size_t pos = 0;
+};
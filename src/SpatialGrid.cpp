@@ -0,0 +1,59 @@
+#include "SpatialGrid.h"
+
+void SpatialGrid::setup(int cx, int cy, size_t maxHandles) {
+	cellsX = std::max(cx, 1);
+	cellsY = std::max(cy, 1);
+	heads.assign((size_t)cellsX * cellsY, kNone);
+	next.assign(maxHandles, kNone);
+	prev.assign(maxHandles, kNone);
+	cellOf.assign(maxHandles, kNone);
+	count = 0;
+}
+
+void SpatialGrid::clear() {
+	std::fill(heads.begin(), heads.end(), kNone);
+	std::fill(cellOf.begin(), cellOf.end(), kNone);
+	count = 0;
+}
+
+void SpatialGrid::insert(uint32_t h, glm::vec2 normPos) {
+	uint32_t cell = (uint32_t)(cellY(normPos.y) * cellsX + cellX(normPos.x));
+	if (cellOf[h] == cell) return;
+	if (cellOf[h] != kNone) remove(h);
+
+	next[h] = heads[cell];
+	prev[h] = kNone;
+	if (heads[cell] != kNone) prev[heads[cell]] = h;
+	heads[cell] = h;
+	cellOf[h] = cell;
+	count++;
+}
+
+void SpatialGrid::remove(uint32_t h) {
+	uint32_t cell = cellOf[h];
+	if (cell == kNone) return;
+	if (prev[h] != kNone) {
+		next[prev[h]] = next[h];
+	} else {
+		heads[cell] = next[h];
+	}
+	if (next[h] != kNone) prev[next[h]] = prev[h];
+	cellOf[h] = kNone;
+	count--;
+}
+
+bool SpatialGrid::contains(uint32_t h) const {
+	return h < cellOf.size() && cellOf[h] != kNone;
+}
+
+size_t SpatialGrid::size() const {
+	return count;
+}
+
+int SpatialGrid::getCellsX() const {
+	return cellsX;
+}
+
+int SpatialGrid::getCellsY() const {
+	return cellsY;
+}
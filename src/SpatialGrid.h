@@ -0,0 +1,81 @@
+#pragma once
+#include "ofMain.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// --- Uniform grid over normalized field positions ---
+// Every handle sits in one cell's intrusive list, so insert, move and remove
+// are O(1) and never allocate after setup(). Queries visit the handles of
+// every cell overlapping a rectangle; callers do the exact test.
+
+class SpatialGrid {
+public:
+	static const uint32_t kNone = 0xFFFFFFFFu;
+
+	// Cells cover [0,1]^2; handles must be < maxHandles
+	void setup(int cellsX, int cellsY, size_t maxHandles);
+	void clear();
+
+	void insert(uint32_t h, glm::vec2 normPos);   // moves it if already present
+	void remove(uint32_t h);
+	bool contains(uint32_t h) const;
+	size_t size() const;
+
+	int getCellsX() const;
+	int getCellsY() const;
+
+	// Calls visit(handle) for the handles in every cell overlapping the
+	// normalized rectangle [x0,x1] x [y0,y1]
+	template <class Visit>
+	void query(float x0, float y0, float x1, float y1, Visit&& visit) const {
+		if (cellsX == 0) return;
+		int cx0 = cellX(x0), cx1 = cellX(x1);
+		int cy0 = cellY(y0), cy1 = cellY(y1);
+		for (int cy = cy0; cy <= cy1; cy++) {
+			for (int cx = cx0; cx <= cx1; cx++) {
+				for (uint32_t h = heads[cy * cellsX + cx]; h != kNone; h = next[h]) visit(h);
+			}
+		}
+	}
+
+	// Calls visit(handle) for the handles in cells that can hold a point at
+	// r0 <= d < r1 from center, with d = length((dx * aspect, dy)) so the ring
+	// is round on screen. Cells wholly inside r0 or beyond r1 are skipped,
+	// so a ripple front only touches the cells it is crossing.
+	template <class Visit>
+	void queryRing(glm::vec2 center, float aspect, float r0, float r1, Visit&& visit) const {
+		if (cellsX == 0 || r1 <= 0.0f) return;
+		const float cw = aspect / cellsX;
+		const float ch = 1.0f / cellsY;
+		const float px = center.x * aspect;
+		const float py = center.y;
+		int cx0 = cellX(center.x - r1 / aspect), cx1 = cellX(center.x + r1 / aspect);
+		int cy0 = cellY(center.y - r1), cy1 = cellY(center.y + r1);
+		for (int cy = cy0; cy <= cy1; cy++) {
+			float y0 = cy * ch, y1 = y0 + ch;
+			float nearY = std::max({y0 - py, 0.0f, py - y1});
+			float farY = std::max(std::abs(py - y0), std::abs(py - y1));
+			for (int cx = cx0; cx <= cx1; cx++) {
+				float x0 = cx * cw, x1 = x0 + cw;
+				float nearX = std::max({x0 - px, 0.0f, px - x1});
+				float farX = std::max(std::abs(px - x0), std::abs(px - x1));
+				if (nearX * nearX + nearY * nearY >= r1 * r1) continue;
+				if (farX * farX + farY * farY < r0 * r0) continue;
+				for (uint32_t h = heads[cy * cellsX + cx]; h != kNone; h = next[h]) visit(h);
+			}
+		}
+	}
+
+private:
+	int cellX(float x) const { return std::min(std::max((int)(x * cellsX), 0), cellsX - 1); }
+	int cellY(float y) const { return std::min(std::max((int)(y * cellsY), 0), cellsY - 1); }
+
+	int cellsX = 0;
+	int cellsY = 0;
+	std::vector<uint32_t> heads;       // first handle per cell
+	std::vector<uint32_t> next;        // per handle
+	std::vector<uint32_t> prev;
+	std::vector<uint32_t> cellOf;      // kNone = not in the grid
+	size_t count = 0;
+};
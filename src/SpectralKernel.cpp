@@ -0,0 +1,249 @@
+#include "SpectralKernel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+// Band edges in Hz; band b spans [kBandEdges[b], kBandEdges[b + 1])
+const float kBandEdges[kNumSpectralBands + 1] = {20.0f, 200.0f, 800.0f, 3200.0f, 1e9f};
+const float kMagnitudeFloor = 1e-10f;   // -200 dB
+const float kDbPerOctave = 6.0205999f;  // 20 * log10(2)
+
+// log2(1 + t) on t in [0, 1), least-squares fit, |error| < 3e-5
+const float kLog2C1 = 1.4418258f;
+const float kLog2C2 = -0.7086821f;
+const float kLog2C3 = 0.4154220f;
+const float kLog2C4 = -0.1944227f;
+const float kLog2C5 = 0.0458855f;
+
+// ====================================================================
+// SIMD wrappers: the same kernel is instantiated per instruction set
+// ====================================================================
+
+struct ScalarOps {
+	typedef float V;
+	static const int W = 1;
+	static V load(const float* p) { return *p; }
+	static void store(float* p, V v) { *p = v; }
+	static V set1(float x) { return x; }
+	static V ramp(float base) { return base; }
+	static V add(V a, V b) { return a + b; }
+	static V sub(V a, V b) { return a - b; }
+	static V mul(V a, V b) { return a * b; }
+	static V max(V a, V b) { return a > b ? a : b; }
+	static V gtOne(V a, V b) { return a > b ? 1.0f : 0.0f; }
+	// x = 2^e * m with m in [1, 2); x must be positive and normal
+	static void split(V x, V& e, V& m) {
+		uint32_t bits;
+		std::memcpy(&bits, &x, sizeof(bits));
+		e = (float)((int)(bits >> 23) - 127);
+		bits = (bits & 0x007FFFFFu) | 0x3F800000u;
+		std::memcpy(&m, &bits, sizeof(m));
+	}
+};
+
+#if defined(__AVX2__)
+struct SimdOps {
+	typedef __m256 V;
+	static const int W = 8;
+	static V load(const float* p) { return _mm256_loadu_ps(p); }
+	static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+	static V set1(float x) { return _mm256_set1_ps(x); }
+	static V ramp(float base) {
+		return _mm256_add_ps(_mm256_set1_ps(base), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7));
+	}
+	static V add(V a, V b) { return _mm256_add_ps(a, b); }
+	static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+	static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+	static V max(V a, V b) { return _mm256_max_ps(a, b); }
+	static V gtOne(V a, V b) {
+		return _mm256_and_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ), _mm256_set1_ps(1.0f));
+	}
+	static void split(V x, V& e, V& m) {
+		__m256i bits = _mm256_castps_si256(x);
+		e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+		m = _mm256_castsi256_ps(_mm256_or_si256(
+			_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F800000)));
+	}
+};
+const char* kSimdName = "avx2";
+#elif defined(__SSE2__) || defined(_M_X64)
+struct SimdOps {
+	typedef __m128 V;
+	static const int W = 4;
+	static V load(const float* p) { return _mm_loadu_ps(p); }
+	static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+	static V set1(float x) { return _mm_set1_ps(x); }
+	static V ramp(float base) { return _mm_add_ps(_mm_set1_ps(base), _mm_setr_ps(0, 1, 2, 3)); }
+	static V add(V a, V b) { return _mm_add_ps(a, b); }
+	static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+	static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+	static V max(V a, V b) { return _mm_max_ps(a, b); }
+	static V gtOne(V a, V b) { return _mm_and_ps(_mm_cmpgt_ps(a, b), _mm_set1_ps(1.0f)); }
+	static void split(V x, V& e, V& m) {
+		__m128i bits = _mm_castps_si128(x);
+		e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+		m = _mm_castsi128_ps(_mm_or_si128(
+			_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+	}
+};
+const char* kSimdName = "sse2";
+#elif defined(__ARM_NEON)
+struct SimdOps {
+	typedef float32x4_t V;
+	static const int W = 4;
+	static V load(const float* p) { return vld1q_f32(p); }
+	static void store(float* p, V v) { vst1q_f32(p, v); }
+	static V set1(float x) { return vdupq_n_f32(x); }
+	static V ramp(float base) {
+		const float lanes[4] = {0, 1, 2, 3};
+		return vaddq_f32(vdupq_n_f32(base), vld1q_f32(lanes));
+	}
+	static V add(V a, V b) { return vaddq_f32(a, b); }
+	static V sub(V a, V b) { return vsubq_f32(a, b); }
+	static V mul(V a, V b) { return vmulq_f32(a, b); }
+	static V max(V a, V b) { return vmaxq_f32(a, b); }
+	static V gtOne(V a, V b) { return vbslq_f32(vcgtq_f32(a, b), vdupq_n_f32(1.0f), vdupq_n_f32(0.0f)); }
+	static void split(V x, V& e, V& m) {
+		uint32x4_t bits = vreinterpretq_u32_f32(x);
+		e = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(127)));
+		m = vreinterpretq_f32_u32(vorrq_u32(
+			vandq_u32(bits, vdupq_n_u32(0x007FFFFF)), vdupq_n_u32(0x3F800000)));
+	}
+};
+const char* kSimdName = "neon";
+#else
+typedef ScalarOps SimdOps;
+const char* kSimdName = "scalar";
+#endif
+
+template <class Ops>
+typename Ops::V fastLog2(typename Ops::V x) {
+	typename Ops::V e, m;
+	Ops::split(x, e, m);
+	typename Ops::V t = Ops::sub(m, Ops::set1(1.0f));
+	typename Ops::V p = Ops::set1(kLog2C5);
+	p = Ops::add(Ops::mul(p, t), Ops::set1(kLog2C4));
+	p = Ops::add(Ops::mul(p, t), Ops::set1(kLog2C3));
+	p = Ops::add(Ops::mul(p, t), Ops::set1(kLog2C2));
+	p = Ops::add(Ops::mul(p, t), Ops::set1(kLog2C1));
+	return Ops::add(e, Ops::mul(p, t));
+}
+
+template <class Ops>
+float horizontalSum(typename Ops::V v) {
+	float lanes[Ops::W];
+	Ops::store(lanes, v);
+	float sum = 0.0f;
+	for (int i = 0; i < Ops::W; i++) sum += lanes[i];
+	return sum;
+}
+
+struct Accumulators {
+	float sumSquares = 0.0f;
+	float sumMagnitude = 0.0f;
+	float sumWeighted = 0.0f;  // magnitude * frequency
+	float flux = 0.0f;
+	float active = 0.0f;
+};
+
+// Fused pass over bins [begin, end) in steps of Ops::W; returns the first
+// bin not processed so the caller can finish the tail with ScalarOps
+template <class Ops>
+int accumulateBins(const float* mag, float* prev, float* db, int begin, int end,
+                   float binHz, float threshold, Accumulators& acc) {
+	typedef typename Ops::V V;
+	const V zero = Ops::set1(0.0f);
+	const V hz = Ops::set1(binHz);
+	const V thresh = Ops::set1(threshold);
+	const V floor = Ops::set1(kMagnitudeFloor);
+	const V dbScale = Ops::set1(kDbPerOctave);
+	V sumSquares = zero, sumMagnitude = zero, sumWeighted = zero, flux = zero, active = zero;
+
+	int i = begin;
+	for (; i + Ops::W <= end; i += Ops::W) {
+		V m = Ops::load(mag + i);
+		V p = Ops::load(prev + i);
+		V f = Ops::mul(Ops::ramp((float)i), hz);
+		sumSquares = Ops::add(sumSquares, Ops::mul(m, m));
+		sumMagnitude = Ops::add(sumMagnitude, m);
+		sumWeighted = Ops::add(sumWeighted, Ops::mul(m, f));
+		flux = Ops::add(flux, Ops::max(Ops::sub(m, p), zero));
+		active = Ops::add(active, Ops::gtOne(m, thresh));
+		Ops::store(prev + i, m);
+		Ops::store(db + i, Ops::mul(fastLog2<Ops>(Ops::max(m, floor)), dbScale));
+	}
+
+	acc.sumSquares += horizontalSum<Ops>(sumSquares);
+	acc.sumMagnitude += horizontalSum<Ops>(sumMagnitude);
+	acc.sumWeighted += horizontalSum<Ops>(sumWeighted);
+	acc.flux += horizontalSum<Ops>(flux);
+	acc.active += horizontalSum<Ops>(active);
+	return i;
+}
+}
+
+// ====================================================================
+// SpectralKernel
+// ====================================================================
+
+void SpectralKernel::setup(int frameSize, float sampleRate, float thresholdDb) {
+	bins = frameSize / 2 + 1;
+	binHz = sampleRate / frameSize;
+	threshold = std::pow(10.0f, thresholdDb / 20.0f);
+	previous.assign(bins, 0.0f);
+
+	// Contiguous segments: DC (no band), then each band up to its upper edge
+	segments.clear();
+	int start = std::min(bins, std::max(1, (int)std::ceil(kBandEdges[0] / binHz)));
+	segments.push_back({0, start, -1});
+	for (int b = 0; b < kNumSpectralBands; b++) {
+		int end = (b == kNumSpectralBands - 1)
+			? bins
+			: std::min(bins, (int)std::floor(kBandEdges[b + 1] / binHz) + 1);
+		end = std::max(end, start);
+		segments.push_back({start, end, b});
+		bandBins[b] = end - start;
+		start = end;
+	}
+}
+
+int SpectralKernel::numBins() const {
+	return bins;
+}
+
+const char* SpectralKernel::simdName() {
+	return kSimdName;
+}
+
+void SpectralKernel::process(const float* spectrum, float* displayDb, SpectralSummary& out) {
+	Accumulators total;
+	for (const Segment& seg : segments) {
+		Accumulators acc;
+		int i = accumulateBins<SimdOps>(spectrum, previous.data(), displayDb,
+		                                seg.begin, seg.end, binHz, threshold, acc);
+		accumulateBins<ScalarOps>(spectrum, previous.data(), displayDb,
+		                          i, seg.end, binHz, threshold, acc);
+
+		if (seg.band >= 0) {
+			out.bandRms[seg.band] = std::sqrt(acc.sumSquares / std::max(bandBins[seg.band], 1));
+			out.bandFlux[seg.band] = acc.flux;
+		}
+		total.sumMagnitude += acc.sumMagnitude;
+		total.sumWeighted += acc.sumWeighted;
+		total.flux += acc.flux;
+		total.active += acc.active;
+	}
+
+	out.activeBins = (int)total.active;
+	out.flux = total.flux;
+	out.centroidHz = (total.sumMagnitude > 1e-9f) ? total.sumWeighted / total.sumMagnitude : 0.0f;
+}
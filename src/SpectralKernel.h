@@ -0,0 +1,49 @@
+#pragma once
+#include "AudioFeatures.h"
+#include <array>
+#include <vector>
+
+// --- Per-hop spectral summary ---
+
+struct SpectralSummary {
+	int activeBins = 0;                             // bins above the fullness threshold
+	std::array<float, kNumSpectralBands> bandRms{}; // RMS magnitude per band
+	std::array<float, kNumSpectralBands> bandFlux{};// positive magnitude change per band
+	float centroidHz = 0.0f;
+	float flux = 0.0f;                              // positive magnitude change, all bins
+};
+
+// --- Fused spectral feature kernel ---
+// One pass over the magnitude spectrum computes everything the analyzer and
+// the debug view need: fullness compares against a precomputed linear
+// threshold (no logs), band energies, centroid and half-wave rectified flux
+// accumulate alongside, and the display dB array uses a polynomial log2.
+// The inner loop is a template over a small SIMD wrapper (AVX2, SSE2 or NEON
+// when the compiler targets them, scalar otherwise).
+
+class SpectralKernel {
+public:
+	void setup(int frameSize, float sampleRate, float thresholdDb = -65.0f);
+
+	// spectrum and displayDb hold numBins() values; keeps the previous
+	// spectrum internally for flux
+	void process(const float* spectrum, float* displayDb, SpectralSummary& out);
+
+	int numBins() const;
+	static const char* simdName();
+
+private:
+	// Contiguous bin range; band < 0 for bins outside every band (DC)
+	struct Segment {
+		int begin;
+		int end;
+		int band;
+	};
+
+	std::vector<Segment> segments;
+	std::vector<float> previous;
+	std::array<int, kNumSpectralBands> bandBins{};
+	int bins = 0;
+	float binHz = 0.0f;
+	float threshold = 0.0f;       // linear magnitude
+};
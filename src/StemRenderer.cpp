@@ -0,0 +1,134 @@
+#include "StemRenderer.h"
+
+namespace {
+// Attribute locations after oF's defaults (position, color, normal, texcoord)
+const int kCurlLocation = 4;
+const int kBaseLocation = 5;
+
+// Same bezier as Stem::rebuild(): P0 = base, P3 = top, bend scales with height
+const char* kStemVertexShader = R"(
+#version 330
+uniform mat4 modelViewProjectionMatrix;
+uniform float height;
+uniform float curvature;
+uniform vec4 stemColor;
+in vec4 position;
+in vec4 stemCurl;
+in vec2 stemBase;
+out vec4 vColor;
+void main() {
+	float xOff = curvature * height * 0.3;
+	vec2 p1 = vec2(xOff * 0.6, -height * 0.5);
+	vec2 p2 = vec2(xOff, -height * 0.9);
+	vec2 p3 = vec2(xOff, -height);
+
+	float t = position.x;
+	float u = 1.0 - t;
+	vec2 p = 3.0*u*u*t*p1 + 3.0*u*t*t*p2 + t*t*t*p3;
+	vec2 tang = 3.0*u*u*p1 + 6.0*u*t*(p2 - p1) + 3.0*t*t*(p3 - p2);
+	float len = length(tang);
+	vec2 up = len > 0.001 ? tang / len : vec2(0.0, -1.0);
+	vec2 normal = vec2(-up.y, up.x);
+
+	if (stemBase.x == 0.0) {
+		p += normal * position.y;
+	} else {
+		// Rotate the baked tendril frame onto its base direction
+		float a = stemBase.y;
+		vec2 dir = normalize(normal * stemBase.x * cos(a) + up * sin(a));
+		vec2 across = vec2(-dir.y, dir.x);
+		p += (dir * stemCurl.x + across * stemCurl.y) * height
+		   + (dir * stemCurl.z + across * stemCurl.w) * position.y;
+	}
+
+	gl_Position = modelViewProjectionMatrix * vec4(p, 0.0, 1.0);
+	vColor = stemColor;
+}
+)";
+
+const char* kStemFragmentShader = R"(
+#version 330
+in vec4 vColor;
+out vec4 outputColor;
+void main() {
+	outputColor = vColor;
+}
+)";
+}
+
+void StemStrip::clear() {
+	coord.clear();
+	curl.clear();
+	base.clear();
+}
+
+void StemStrip::add(const glm::vec2& c, const glm::vec4& cu, const glm::vec2& b) {
+	coord.push_back(c);
+	curl.push_back(cu);
+	base.push_back(b);
+}
+
+void StemStrip::repeatLast() {
+	if (coord.empty()) return;
+	add(coord.back(), curl.back(), base.back());
+}
+
+int StemStrip::size() const {
+	return (int)coord.size();
+}
+
+StemRenderer& StemRenderer::shared() {
+	static StemRenderer renderer;
+	return renderer;
+}
+
+bool StemRenderer::setup() {
+	shader.setupShaderFromSource(GL_VERTEX_SHADER, kStemVertexShader);
+	shader.setupShaderFromSource(GL_FRAGMENT_SHADER, kStemFragmentShader);
+	shader.bindDefaults();
+	shader.bindAttribute(kCurlLocation, "stemCurl");
+	shader.bindAttribute(kBaseLocation, "stemBase");
+	ready = shader.linkProgram();
+	if (!ready) {
+		ofLogWarning("StemRenderer") << "Stem shader failed to link, using tessellated stems";
+	}
+	return ready;
+}
+
+bool StemRenderer::isReady() {
+	if (!initialized) {
+		initialized = true;
+		setup();
+	}
+	return ready;
+}
+
+void StemRenderer::begin() {
+	if (!isReady() || active) return;
+	shader.begin();
+	active = true;
+}
+
+void StemRenderer::end() {
+	if (!active) return;
+	shader.end();
+	active = false;
+}
+
+void StemRenderer::upload(ofVbo& vbo, const StemStrip& strip) {
+	int count = strip.size();
+	vbo.setVertexData(strip.coord.data(), count, GL_STATIC_DRAW);
+	vbo.setAttributeData(kCurlLocation, &strip.curl[0].x, 4, count, GL_STATIC_DRAW);
+	vbo.setAttributeData(kBaseLocation, &strip.base[0].x, 2, count, GL_STATIC_DRAW);
+}
+
+void StemRenderer::draw(const ofVbo& strip, int vertexCount, float height, float curvature,
+                        const ofColor& color) {
+	bool scoped = !active;
+	if (scoped) begin();
+	shader.setUniform1f("height", height);
+	shader.setUniform1f("curvature", curvature);
+	shader.setUniform4f("stemColor", color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f);
+	strip.draw(GL_TRIANGLE_STRIP, 0, vertexCount);
+	if (scoped) end();
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "ofMain.h"
+
+// --- Baked stem strip, in stem-local parametric form ---
+// Body vertices only carry (t, signed half-width); tendril vertices also
+// carry their curl in a tendril frame whose orientation depends on the stem
+// tangent at the anchor. Height and curvature are applied in the shader.
+
+struct StemStrip {
+	std::vector<glm::vec2> coord;  // x = t along the stem (tendril anchor), y = signed half-width px
+	std::vector<glm::vec4> curl;   // xy = tendril centreline (stem-height units), zw = its unit normal
+	std::vector<glm::vec2> base;   // x = tendril side (+1/-1, 0 = stem body), y = start angle (rad)
+
+	void clear();
+	void add(const glm::vec2& coord, const glm::vec4& curl = glm::vec4(0.0f),
+	         const glm::vec2& base = glm::vec2(0.0f));
+	void repeatLast();             // degenerate joint between strips
+	int size() const;
+};
+
+// --- Stem shader ---
+// Evaluates the stem bezier for the current height and curvature per vertex,
+// so a stem and all its tendrils draw as one baked triangle strip with a
+// couple of uniforms, and growth or wilt droop never rebuild geometry.
+
+class StemRenderer {
+public:
+	static StemRenderer& shared();
+
+	bool isReady();           // sets up the shader on first use (needs GL)
+
+	// Optional: keep the shader bound across many stems
+	void begin();
+	void end();
+
+	void draw(const ofVbo& strip, int vertexCount, float height, float curvature,
+	          const ofColor& color);
+
+	static void upload(ofVbo& vbo, const StemStrip& strip);
+
+private:
+	StemRenderer() = default;
+	bool setup();
+
+	ofShader shader;
+	bool initialized = false;
+	bool ready = false;
+	bool active = false;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// --- Lock-free triple buffer (one writer, one reader) ---
+// The writer fills writeBuffer() and publish()es it; the reader calls
+// update() to pick up the newest published value, then reads it with read().
+// Neither side ever blocks, and the reader always sees a complete value.
+
+template<class T>
+class TripleBuffer {
+public:
+	// Not thread-safe; use before the writer starts (e.g. to pre-size vectors)
+	void reset(const T& value) {
+		for (auto& b : buffers) b = value;
+		state.store(kMiddleInit, std::memory_order_relaxed);
+		back = kBackInit;
+		front = kFrontInit;
+	}
+
+	// --- Writer ---
+	T& writeBuffer() { return buffers[back]; }
+
+	void publish() {
+		uint8_t old = state.exchange(back | kFresh, std::memory_order_acq_rel);
+		back = old & kIndexMask;
+	}
+
+	// --- Reader ---
+	// Returns true if a newer value was published since the last call
+	bool update() {
+		if (!(state.load(std::memory_order_relaxed) & kFresh)) return false;
+		uint8_t old = state.exchange(front, std::memory_order_acq_rel);
+		front = old & kIndexMask;
+		return true;
+	}
+
+	const T& read() const { return buffers[front]; }
+
+private:
+	static const uint8_t kFresh = 0x4;
+	static const uint8_t kIndexMask = 0x3;
+	static const uint8_t kFrontInit = 0, kMiddleInit = 1, kBackInit = 2;
+
+	T buffers[3];
+	alignas(64) std::atomic<uint8_t> state{kMiddleInit};   // middle index | fresh bit
+	alignas(64) uint8_t back = kBackInit;                  // writer-owned
+	alignas(64) uint8_t front = kFrontInit;                // reader-owned
+};
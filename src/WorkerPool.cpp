@@ -0,0 +1,77 @@
+#include "WorkerPool.h"
+#include "Profiler.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(int numWorkers) {
+	if (numWorkers < 0) {
+		numWorkers = std::max(0, (int)std::thread::hardware_concurrency() - 1);
+	}
+	for (int i = 0; i < numWorkers; i++) {
+		threads.emplace_back(&WorkerPool::workerLoop, this, i + 1);
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+	for (auto& t : threads) t.join();
+}
+
+int WorkerPool::size() const {
+	return (int)threads.size() + 1;
+}
+
+void WorkerPool::parallelFor(size_t count, size_t grain, const RangeFn& fn) {
+	if (count == 0) return;
+	grain = std::max<size_t>(grain, 1);
+	if (threads.empty() || count <= grain) {
+		fn(0, count, 0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &fn;
+		jobCount = count;
+		jobGrain = grain;
+		nextIndex.store(0, std::memory_order_relaxed);
+		activeWorkers = (int)threads.size();
+		generation++;
+	}
+	wake.notify_all();
+
+	runChunks(0);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this]{ return activeWorkers == 0; });
+	job = nullptr;
+}
+
+void WorkerPool::runChunks(int slot) {
+	for (;;) {
+		size_t begin = nextIndex.fetch_add(jobGrain, std::memory_order_relaxed);
+		if (begin >= jobCount) break;
+		(*job)(begin, std::min(begin + jobGrain, jobCount), slot);
+	}
+}
+
+void WorkerPool::workerLoop(int slot) {
+	Profiler::markWorkerThread();
+	uint64_t seen = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&]{ return quit || generation != seen; });
+			if (quit) return;
+			seen = generation;
+		}
+
+		runChunks(slot);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--activeWorkers == 0) done.notify_one();
+	}
+}
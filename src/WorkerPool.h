@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --- Persistent worker pool for data-parallel loops ---
+// parallelFor() splits [0, count) into grain-sized chunks that idle workers
+// claim from a shared atomic counter, so uneven chunks balance themselves.
+// The calling thread participates; each invocation gets a slot index in
+// [0, size()) for writing to per-thread scratch buffers without locking.
+
+class WorkerPool {
+public:
+	using RangeFn = std::function<void(size_t begin, size_t end, int slot)>;
+
+	explicit WorkerPool(int numWorkers = -1);   // -1 = hardware threads - 1
+	~WorkerPool();
+
+	int size() const;                           // worker threads + caller
+	void parallelFor(size_t count, size_t grain, const RangeFn& fn);
+
+private:
+	void workerLoop(int slot);
+	void runChunks(int slot);
+
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+
+	const RangeFn* job = nullptr;
+	size_t jobCount = 0;
+	size_t jobGrain = 1;
+	std::atomic<size_t> nextIndex{0};
+	int activeWorkers = 0;
+	uint64_t generation = 0;
+	bool quit = false;
+};
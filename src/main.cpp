@@ -2,16 +2,49 @@
 #include "ofApp.h"
 
 //========================================================================
-int main( ){
+// --tiles CxR   draw the field as C x R viewports (one per projector)
+// --span        fullscreen across every monitor, for projector walls
+// --stress N    preallocate N flowers and hold the most the frame budget allows
+int main(int argc, char** argv){
 
-	//Use ofGLFWWindowSettings for more options like multi-monitor fullscreen
-	ofGLWindowSettings settings;
+	int tileCols = 1;
+	int tileRows = 1;
+	bool span = false;
+	int stressCapacity = 0;
+	for(int i = 1; i < argc; i++){
+		std::string arg = argv[i];
+		if(arg == "--tiles" && i + 1 < argc){
+			if(sscanf(argv[++i], "%dx%d", &tileCols, &tileRows) != 2){
+				std::cerr << "error: --tiles expects CxR, e.g. 3x1\n";
+				return 2;
+			}
+		} else if(arg == "--span"){
+			span = true;
+		} else if(arg == "--stress" && i + 1 < argc){
+			stressCapacity = std::atoi(argv[++i]);
+			if(stressCapacity <= 0){
+				std::cerr << "error: --stress expects a flower count, e.g. 20000\n";
+				return 2;
+			}
+		} else {
+			std::cerr << "usage: musicalFlower [--tiles CxR] [--span] [--stress N]\n";
+			return 2;
+		}
+	}
+
+	// One window, one GL context: every tile shares the same buffers
+	ofGLFWWindowSettings settings;
 	settings.setSize(1024, 768);
-	settings.windowMode = OF_WINDOW; //can also be OF_FULLSCREEN
+	settings.setGLVersion(3, 3); // programmable renderer for instanced petals
+	settings.windowMode = span ? OF_FULLSCREEN : OF_WINDOW;
+	settings.multiMonitorFullScreen = span;
 
 	auto window = ofCreateWindow(settings);
 
-	ofRunApp(window, std::make_shared<ofApp>());
+	auto app = std::make_shared<ofApp>();
+	app->setTiles(tileCols, tileRows);
+	app->setStressCapacity(stressCapacity);
+	ofRunApp(window, app);
 	ofRunMainLoop();
 
 }
@@ -1,11 +1,5 @@
 #include "ofApp.h"
 #include <cmath>
-#include <thread>
-#include <sstream>
-#include <array>
-
-using namespace essentia;
-using namespace essentia::standard;
 
 //--------------------------------------------------------------
 void ofApp::setup(){
@@ -13,144 +7,136 @@ void ofApp::setup(){
 	essentia::init();
 	ofLogNotice("Essentia") << "Essentia initialized successfully!";
 
-	// Create Essentia algorithms
-	AlgorithmFactory& factory = AlgorithmFactory::instance();
+	// Ring holds ~0.75 s so the analysis thread can fall behind briefly
+	audioRing.allocate(kSampleRate / 2);
 
-	windowing = factory.create("Windowing",
-		"type", "hann",
-		"zeroPadding", 0);
+	AudioAnalyzer::Settings analysisSettings = AudioAnalyzer::Settings::forProfile(analysisProfile, kSampleRate);
+	analyzer.setup(audioRing, analysisSettings);
+	analyzer.start();
 
-	spectrum = factory.create("Spectrum",
-		"size", kFrameSize);
+	// Setup audio input
+	setupCapture(analysisSettings.bufferSize);
+
+	// Setup flower field, resuming the last saved state if there is one
+	if(stressCapacity > 0) flowerField.setCapacity(stressCapacity);
+	flowerField.setup(kFlowerCount);
+	snapshotPath = ofToDataPath("field.snapshot", true);
+	FieldSnapshot snapshot;
+	if(snapshot.open(snapshotPath) && flowerField.restoreSnapshot(snapshot)){
+		if(snapshot.header().hasTracker) analyzer.restoreTracker(snapshot.header().tracker);
+		ofLogNotice("ofApp") << "Restored " << snapshot.header().flowerCount << " flowers from " << snapshotPath;
+		flowerField.setBaseCount(kFlowerCount);   // a stress-mode save keeps its pool-sized target
+	}
+	snapshotWriter.start(snapshotPath);
 
-	pitchYinFFT = factory.create("PitchYinFFT",
-		"frameSize", kFrameSize,
-		"sampleRate", (Real)kSampleRate);
+	governor.setup(FrameGovernor::Settings(), flowerField.getCapacity());
+	if(stressCapacity > 0) setStress(true);
 
-	// Pre-allocate buffers
-	frame.resize(kFrameSize, 0.0f);
-	windowedFrame.resize(kFrameSize, 0.0f);
-	spectrumValues.resize(kFrameSize / 2 + 1, 0.0f);
-	displaySpectrum.resize(kFrameSize / 2 + 1, 0.0f);
-	audioInputBuffer.reserve(kSampleRate);
+	ofSetFrameRate(60);
+}
 
-	// Setup audio input
+//--------------------------------------------------------------
+void ofApp::setupCapture(int bufferSize){
+	streamBufferSize = bufferSize;
+	// A started capture owns the input, also while it reconnects to the server
+	if(capture.isStarted()){
+		capture.setQuantum(bufferSize);
+		return;
+	}
+	if(capture.start(audioRing, kSampleRate, bufferSize)){
+		return;
+	}
+
+	// No sound server: record the default input through oF instead
+	soundStream.close();
 	ofSoundStreamSettings settings;
 	settings.setInListener(this);
 	settings.sampleRate = kSampleRate;
 	settings.numInputChannels = 1;
 	settings.numOutputChannels = 0;
-	settings.bufferSize = 512;
+	settings.bufferSize = bufferSize;
 	soundStream.setup(settings);
+}
 
-	// Auto-route audio from active playback (runs in background thread)
-	std::thread([this](){
-		std::this_thread::sleep_for(std::chrono::seconds(1));
-		autoRouteAudio();
-	}).detach();
-
-	// Setup flower field
-	flowerField.setup(300);
-
-	ofSetFrameRate(60);
+//--------------------------------------------------------------
+void ofApp::setAnalysisProfile(AnalysisProfile profile){
+	// The analyzer switches between hops; capture only changes its fragment
+	// size (or the fallback device reopens) if the quantum changes
+	analysisProfile = profile;
+	AudioAnalyzer::Settings settings = AudioAnalyzer::Settings::forProfile(profile, kSampleRate);
+	analyzer.configure(settings);
+	if(settings.bufferSize != streamBufferSize){
+		setupCapture(settings.bufferSize);
+	}
+	ofLogNotice("ofApp") << "Analysis profile: " << AudioAnalyzer::profileName(profile)
+		<< " (" << settings.frameSize << " frame, " << settings.hopSize << " hop)";
 }
 
 //--------------------------------------------------------------
 void ofApp::audioIn(ofSoundBuffer& input){
-	float sumSquares = 0.0f;
-	std::lock_guard<std::mutex> lock(audioMutex);
+	// Runs on the audio thread: no locks, no allocation
 	size_t nFrames = input.getNumFrames();
-	for(size_t i = 0; i < nFrames; i++){
-		float sample = input[i];
-		audioInputBuffer.push_back(sample);
-		sumSquares += sample * sample;
-	}
-	rmsVolume = std::sqrt(sumSquares / nFrames);
+	if(nFrames == 0) return;
+	ScopedTimer timer(ProfileStage::AUDIO_HANDOFF);
+	// oF does not expose device latency; assume one buffer of driver
+	// queueing ahead of the callback
+	int64_t now = audioClockNs();
+	int64_t bufferNs = (int64_t)nFrames * 1000000000ll / kSampleRate;
+	audioRing.push(input.getBuffer().data(), nFrames, now, now - bufferNs);
 }
 
 //--------------------------------------------------------------
 void ofApp::update(){
-	// Grab audio samples from the audio thread
-	{
-		std::lock_guard<std::mutex> lock(audioMutex);
-		processingBuffer.insert(processingBuffer.end(),
-			audioInputBuffer.begin(), audioInputBuffer.end());
-		audioInputBuffer.clear();
-	}
-
-	// Process if we have enough samples for a frame
-	if((int)processingBuffer.size() >= kFrameSize){
-		// Take the most recent kFrameSize samples
-		size_t offset = processingBuffer.size() - kFrameSize;
-		for(int i = 0; i < kFrameSize; i++){
-			frame[i] = processingBuffer[offset + i];
-		}
+	// Close the previous frame (update + draw) into the profiler history
+	Profiler::shared().endFrame(ofGetLastFrameTime());
+	Profiler::shared().setEnabled(debugMode || showProfiler);
+
+	// The governor sees the finished frame before this one's spawns are budgeted
+	if(governorEnabled){
+		governor.frame(ofGetLastFrameTime() * 1000.0f, frameWorkMs, flowerField.getFlowerCount());
+		applyGovernor();
+	}
+	frameStart = std::chrono::steady_clock::now();
 
-		// Discard old samples, keep last kFrameSize for overlap
-		if(processingBuffer.size() > (size_t)kFrameSize * 2){
-			processingBuffer.erase(processingBuffer.begin(),
-				processingBuffer.begin() + processingBuffer.size() - kFrameSize);
-		}
+	// The frame picked up last update has just been swapped to the screen
+	int64_t now = audioClockNs();
+	latency.present(now);
 
-		// Essentia pipeline: frame -> Windowing -> Spectrum -> PitchYinFFT
-		windowing->input("frame").set(frame);
-		windowing->output("frame").set(windowedFrame);
-		windowing->compute();
-
-		spectrum->input("frame").set(windowedFrame);
-		spectrum->output("spectrum").set(spectrumValues);
-		spectrum->compute();
-
-		pitchYinFFT->input("spectrum").set(spectrumValues);
-		pitchYinFFT->output("pitch").set(currentPitch);
-		pitchYinFFT->output("pitchConfidence").set(currentPitchConfidence);
-		pitchYinFFT->compute();
-
-		// Copy spectrum for visualization
-		displaySpectrum.assign(spectrumValues.begin(), spectrumValues.end());
-
-		// Smooth pitch and confidence for display
-		// Higher alpha = faster reaction, less smoothing
-		float alpha = 0.6f;
-		if(currentPitchConfidence > 0.15f && currentPitch > 50.0f){
-			smoothedPitch = smoothedPitch * (1.0f - alpha) + currentPitch * alpha;
-			smoothedConfidence = smoothedConfidence * (1.0f - alpha) + currentPitchConfidence * alpha;
-		} else {
-			smoothedConfidence *= 0.95f;
-		}
+	// Pick up the newest analysis frame (analysis runs per hop on its own thread)
+	bool newFeatures;
+	{
+		ScopedTimer timer(ProfileStage::AUDIO_HANDOFF);
+		newFeatures = analyzer.update();
+	}
+	if(newFeatures){
+		const AudioFeatures& features = analyzer.getFeatures();
+		melodyTrail.push(features.pitch, features.confidence);
+		latency.pickup(features, now);
+	}
 
-		// Compute spectral fullness: fraction of bins with significant energy
-		int activeBins = 0;
-		int totalBins = (int)spectrumValues.size();
-
-		// Compute bass energy: RMS of low-frequency bins (20-200 Hz)
-		// Bin width = sampleRate / frameSize = 44100/2048 ≈ 21.5 Hz
-		// Bins 1-9 cover roughly 21-194 Hz
-		{
-			float bassSum = 0.0f;
-			int bassHigh = std::min(9, totalBins - 1);
-			for (int i = 1; i <= bassHigh; i++) {
-				bassSum += spectrumValues[i] * spectrumValues[i];
-			}
-			bassEnergy = std::sqrt(bassSum / std::max(bassHigh, 1));
-		}
-		for(int i = 0; i < totalBins; i++){
-			float db = 20.0f * std::log10(std::max(spectrumValues[i], 1e-10f));
-			if(db > -65.0f) activeBins++;
-		}
-		float rawFullness = (totalBins > 0) ? (float)activeBins / totalBins : 0.0f;
-		// Boost with power curve so typical music lands around 0.4-0.7
-		spectralFullness = std::pow(rawFullness, 0.4f);
-
-		// Add to melody history
-		melodyHistory.push_back({smoothedPitch, smoothedConfidence});
-		if(melodyHistory.size() > 400){
-			melodyHistory.pop_front();
-		}
+	float lookaheadMs = 0.0f;
+	if(latencyCompensation){
+		lookaheadMs = latency.getPercentile(LatencyStage::TOTAL, 0.5f) + lookaheadTrimMs;
 	}
+	flowerField.setBeatLookahead(lookaheadMs / 1000.0f);
 
 	// Update flower field with audio data
-	flowerField.update(rmsVolume, smoothedPitch, smoothedConfidence, spectralFullness, bassEnergy);
+	flowerField.update(analyzer.getFeatures(), ofGetLastFrameTime());
+
+	// Skip a save while the previous one is still being written
+	if(ofGetElapsedTimef() - lastSnapshotTime >= kSnapshotInterval && !snapshotWriter.isBusy()){
+		saveSnapshot();
+	}
+}
+
+//--------------------------------------------------------------
+void ofApp::saveSnapshot(){
+	// Copying the state out is cheap; the file write happens on the writer thread
+	flowerField.saveSnapshot(snapshotBuilder);
+	snapshotBuilder.header().tracker = analyzer.getTrackerState();
+	snapshotBuilder.header().hasTracker = 1;
+	snapshotWriter.submit(std::move(snapshotBuilder.finish()));
+	lastSnapshotTime = ofGetElapsedTimef();
 }
 
 //--------------------------------------------------------------
@@ -160,6 +146,61 @@ void ofApp::draw(){
 	} else {
 		drawMain();
 	}
+	frameWorkMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+}
+
+//--------------------------------------------------------------
+void ofApp::setStressCapacity(int maxFlowers){
+	stressCapacity = std::max(maxFlowers, 0);
+}
+
+//--------------------------------------------------------------
+void ofApp::setGovernor(bool enabled){
+	governorEnabled = enabled;
+	if(enabled) return;
+	// Back to the fixed budgets and full detail
+	if(governor.isStress()) setStress(false);
+	FieldScaling scaling = flowerField.getScaling();
+	FieldScaling defaults;
+	scaling.countLimit = defaults.countLimit;
+	scaling.spawnsPerTick = defaults.spawnsPerTick;
+	scaling.deathMarksPerTick = defaults.deathMarksPerTick;
+	flowerField.setScaling(scaling);
+	LodSettings lod = flowerField.getLodSettings();
+	lod.thresholdScale = 1.0f;
+	flowerField.setLodSettings(lod);
+}
+
+//--------------------------------------------------------------
+void ofApp::setStress(bool enabled){
+	// Stress aims at the whole pool in normal mode and lets the governor's
+	// count limit decide how much of it this machine can hold
+	governor.setStress(enabled);
+	if(enabled){
+		flowerField.setReactiveMode(false);
+		flowerField.setBaseCount(flowerField.getCapacity());
+		setGovernor(true);
+	} else {
+		flowerField.setBaseCount(kFlowerCount);
+	}
+	ofLogNotice("ofApp") << "Stress mode " << (enabled ? "on" : "off")
+		<< " (capacity " << flowerField.getCapacity() << ")";
+}
+
+//--------------------------------------------------------------
+void ofApp::applyGovernor(){
+	FieldScaling scaling = flowerField.getScaling();
+	scaling.countLimit = governor.getCountLimit();
+	scaling.spawnsPerTick = governor.getSpawnsPerTick();
+	scaling.deathMarksPerTick = governor.getDeathMarksPerTick();
+	flowerField.setScaling(scaling);
+
+	float lodScale = governor.getLodScale();
+	if(flowerField.getLodSettings().thresholdScale != lodScale){
+		LodSettings lod = flowerField.getLodSettings();
+		lod.thresholdScale = lodScale;
+		flowerField.setLodSettings(lod);
+	}
 }
 
 //--------------------------------------------------------------
@@ -168,17 +209,21 @@ void ofApp::drawMain(){
 
 	// Draw flower field
 	ofEnableAlphaBlending();
-	flowerField.draw();
+	drawField();
 	ofDisableAlphaBlending();
 
 	// Mode hint
 	ofSetColor(50);
-	std::string hint = "[D] debug  [SPACE] reactive  [0-9] color";
+	std::string hint = "[D] debug  [SPACE] reactive  [0-9] color  [I] instancing  [L] LOD  [A] sprites  [P] profiler  [S] stress";
 	int hintX = 10;
 	if (flowerField.isReactiveMode()) {
 		ofSetColor(0, 180, 120);
 		ofDrawBitmapString("REACTIVE", 10, ofGetHeight() - 10);
 		hintX = 100;
+	} else if (governor.isStress()) {
+		ofSetColor(220, 120, 0);
+		ofDrawBitmapString("STRESS", 10, ofGetHeight() - 10);
+		hintX = 100;
 	}
 	ofSetColor(50);
 	ofDrawBitmapString(hint, hintX, ofGetHeight() - 10);
@@ -187,6 +232,36 @@ void ofApp::drawMain(){
 	std::string schemeName = flowerField.getColorSchemeName();
 	ofSetColor(80);
 	ofDrawBitmapString(schemeName, ofGetWidth() - 8 * schemeName.size() - 10, 20);
+
+	if(showProfiler){
+		drawProfiler(10, 10);
+		drawLatency(10, 190);
+	}
+}
+
+//--------------------------------------------------------------
+void ofApp::setTiles(int cols, int rows){
+	tileCols = std::max(cols, 1);
+	tileRows = std::max(rows, 1);
+}
+
+//--------------------------------------------------------------
+void ofApp::drawField(){
+	// Every tile draws its part of the same posed field into its own
+	// viewport; the spatial grid keeps each one to the flowers it can see
+	float tileW = ofGetWidth() / (float)tileCols;
+	float tileH = ofGetHeight() / (float)tileRows;
+	for(int row = 0; row < tileRows; row++){
+		for(int col = 0; col < tileCols; col++){
+			ofPushView();
+			ofViewport(col * tileW, row * tileH, tileW, tileH);
+			flowerField.setViewRegion(ofRectangle(col / (float)tileCols, row / (float)tileRows,
+				1.0f / tileCols, 1.0f / tileRows));
+			flowerField.draw();
+			ofPopView();
+		}
+	}
+	flowerField.setViewRegion(ofRectangle(0, 0, 1, 1));
 }
 
 //--------------------------------------------------------------
@@ -196,24 +271,14 @@ void ofApp::drawDebug(){
 	float h = ofGetHeight();
 
 	// --- Spectrum visualization (bottom third) ---
+	const AudioFeatures& features = analyzer.getFeatures();
+	const auto& displaySpectrum = features.spectrumDb;
+	float smoothedPitch = features.pitch;
+	float smoothedConfidence = features.confidence;
+
 	float specY = h * 0.65f;
 	float specH = h * 0.30f;
-	int specSize = displaySpectrum.size();
-	if(specSize > 0){
-		int numBars = std::min(specSize, 512);
-		float barW = w / (float)numBars;
-		for(int i = 0; i < numBars; i++){
-			float mag = displaySpectrum[i];
-			float db = 20.0f * std::log10(std::max(mag, 1e-10f));
-			float normalized = ofClamp((db + 80.0f) / 80.0f, 0.0f, 1.0f);
-			float barH = normalized * specH;
-
-			ofColor c;
-			c.setHsb((int)(170 - normalized * 120) % 255, 220, 50 + normalized * 205);
-			ofSetColor(c);
-			ofDrawRectangle(i * barW, specY + specH - barH, barW - 1, barH);
-		}
-	}
+	spectrumBars.draw(displaySpectrum, 0, specY, w, specH);
 
 	ofSetColor(150);
 	ofDrawBitmapString("SPECTRUM", 10, specY - 5);
@@ -237,32 +302,8 @@ void ofApp::drawDebug(){
 		ofSetColor(40);
 	}
 
-	// Draw melody trail — always draw if pitch is valid, use confidence for opacity
-	if(melodyHistory.size() > 1){
-		float stepX = w / 400.0f;
-		for(size_t i = 1; i < melodyHistory.size(); i++){
-			float pitch0 = melodyHistory[i-1].first;
-			float conf0 = melodyHistory[i-1].second;
-			float pitch1 = melodyHistory[i].first;
-			float conf1 = melodyHistory[i].second;
-
-			if(pitch0 > 50.0f && pitch1 > 50.0f && (conf0 > 0.05f || conf1 > 0.05f)){
-				float logP0 = std::log2(pitch0);
-				float logP1 = std::log2(pitch1);
-				float y0 = melodyY + melodyH - ((logP0 - minLog) / (maxLog - minLog)) * melodyH;
-				float y1 = melodyY + melodyH - ((logP1 - minLog) / (maxLog - minLog)) * melodyH;
-				float x0 = (i - 1) * stepX;
-				float x1 = i * stepX;
-				// Confidence drives opacity: low confidence = faded, high = bright
-				float avgConf = (conf0 + conf1) * 0.5f;
-				int opacity = (int)(ofClamp(avgConf * 1.5f, 0.05f, 1.0f) * 255);
-				ofSetColor(0, 255, 180, opacity);
-				ofSetLineWidth(2);
-				ofDrawLine(x0, y0, x1, y1);
-			}
-		}
-		ofSetLineWidth(1);
-	}
+	// Draw melody trail — confidence drives opacity, unvoiced samples fade out
+	melodyTrail.draw(0, melodyY, w, melodyH, 50.0f, 2500.0f);
 
 	ofSetColor(150);
 	ofDrawBitmapString("MELODY", 10, melodyY - 5);
@@ -294,101 +335,203 @@ void ofApp::drawDebug(){
 	ofDrawBitmapString("Vol:", 330, infoY);
 	ofSetColor(60);
 	ofDrawRectangle(370, infoY - 12, 100, 14);
-	float volDisplay = ofClamp(rmsVolume * 5.0f, 0.0f, 1.0f);
+	float volDisplay = ofClamp(features.rms * 5.0f, 0.0f, 1.0f);
 	ofSetColor(255, 180, 0);
 	ofDrawRectangle(370, infoY - 12, volDisplay * 100, 14);
 
 	// FPS and mode hint
 	ofSetColor(80);
 	ofDrawBitmapString("FPS: " + ofToString(ofGetFrameRate(), 0), w - 80, infoY);
-	ofDrawBitmapString("[D] main mode  |  DEBUG", 10, h - 10);
-}
-
-//--------------------------------------------------------------
-std::string ofApp::pitchToNoteName(float freqHz){
-	if(freqHz <= 0.0f) return "--";
-	const char* noteNames[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
-	int midiNote = (int)std::round(69.0f + 12.0f * std::log2(freqHz / 440.0f));
-	if(midiNote < 0 || midiNote > 127) return "--";
-	int noteIndex = midiNote % 12;
-	int octave = (midiNote / 12) - 1;
-	return std::string(noteNames[noteIndex]) + ofToString(octave);
+	std::string source = !capture.isStarted() ? "default input"
+		: !capture.isRunning() ? "reconnecting to sound server"
+		: capture.getSourceName();
+	ofDrawBitmapString("[D] main mode  |  DEBUG  |  [R] analysis: "
+		+ std::string(AudioAnalyzer::profileName(analysisProfile))
+		+ "  |  " + (source.empty() ? "waiting for playback" : source)
+		+ " @ " + ofToString(streamBufferSize), 10, h - 10);
+
+	drawProfiler(w - 540, 40);
+	drawLatency(w - 540, 220);
 }
 
 //--------------------------------------------------------------
-void ofApp::autoRouteAudio(){
-	// Helper to run a command and capture output
-	auto exec = [](const char* cmd) -> std::string {
-		std::array<char, 256> buffer;
-		std::string result;
-		FILE* pipe = popen(cmd, "r");
-		if(!pipe) return "";
-		while(fgets(buffer.data(), buffer.size(), pipe)){
-			result += buffer.data();
-		}
-		pclose(pipe);
-		return result;
+void ofApp::drawProfiler(float x, float y){
+	Profiler& prof = Profiler::shared();
+	const float graphW = 240.0f;      // one column per history frame
+	const float graphH = 100.0f;
+	const float msFull = 33.3f;       // graph top = two 60 Hz frames
+	const int numStages = Profiler::kNumStages;
+
+	static const ofColor stageColors[Profiler::kNumStages] = {
+		ofColor(120, 120, 255),   // audio handoff
+		ofColor(90, 90, 90),      // analysis (not stacked)
+		ofColor(0, 200, 150),     // lifecycle
+		ofColor(255, 180, 0),     // spawns
+		ofColor(255, 90, 60),     // draw order
+		ofColor(200, 60, 200),    // erase
+		ofColor(255, 255, 120),   // geometry
+		ofColor(60, 160, 255),    // field draw
+		ofColor(255, 140, 200),   // falling petals
 	};
 
-	// Find a sink that has active playback (sink-inputs)
-	// Format: "index sink_index ..."
-	std::string sinkInputs = exec("pactl list short sink-inputs 2>/dev/null");
-	if(sinkInputs.empty()){
-		ofLogWarning("AudioRoute") << "No active playback streams found";
-		return;
+	ofPushStyle();
+	ofFill();
+	ofSetColor(0, 0, 0, 180);
+	ofDrawRectangle(x - 6, y - 6, 540, graphH + 74);
+
+	// Stacked main-thread stages per frame, newest on the right
+	ofMesh bars;
+	bars.setMode(OF_PRIMITIVE_TRIANGLES);
+	int frames = prof.getFrameCount();
+	for(int f = 0; f < frames; f++){
+		float colX = x + graphW - 1 - f;
+		float stackMs = 0.0f;
+		for(int s = 0; s < numStages; s++){
+			ProfileStage stage = (ProfileStage)s;
+			if(!Profiler::isMainThreadStage(stage)) continue;
+			float ms = prof.getStageMs(f, stage);
+			if(ms <= 0.0f) continue;
+			float y0 = y + graphH - std::min(stackMs / msFull, 1.0f) * graphH;
+			stackMs += ms;
+			float y1 = y + graphH - std::min(stackMs / msFull, 1.0f) * graphH;
+			ofFloatColor c = stageColors[s];
+			glm::vec3 quad[4] = {{colX, y0, 0}, {colX + 1, y0, 0}, {colX + 1, y1, 0}, {colX, y1, 0}};
+			bars.addVertices({quad[0], quad[1], quad[2], quad[0], quad[2], quad[3]});
+			for(int v = 0; v < 6; v++) bars.addColor(c);
+		}
 	}
+	bars.draw();
 
-	// Parse the first sink-input to get the sink index it plays to
-	std::istringstream iss(sinkInputs);
-	int inputIdx, sinkIdx;
-	if(!(iss >> inputIdx >> sinkIdx)){
-		ofLogWarning("AudioRoute") << "Could not parse sink-inputs";
-		return;
+	// Frame-time trace and 60 Hz budget line
+	ofPolyline trace;
+	for(int f = 0; f < frames; f++){
+		float ms = std::min(prof.getFrameMs(f), msFull);
+		trace.addVertex(x + graphW - 1 - f, y + graphH - ms / msFull * graphH);
 	}
+	ofSetColor(255);
+	trace.draw();
+	ofSetColor(255, 255, 255, 60);
+	float budgetY = y + graphH - (16.7f / msFull) * graphH;
+	ofDrawLine(x, budgetY, x + graphW, budgetY);
+
+	// Per-stage p50 / p99 over the history window, main thread, and p99 of
+	// the time worker threads spent in the stage (summed, not in the graph)
+	float tx = x + graphW + 12;
+	float ty = y + 8;
+	ofSetColor(200);
+	ofDrawBitmapString("stage           p50    p99   wkr ms", tx, ty);
+	for(int s = 0; s < numStages; s++){
+		ProfileStage stage = (ProfileStage)s;
+		ty += 12;
+		ofSetColor(stageColors[s]);
+		ofDrawRectangle(tx, ty - 8, 8, 8);
+		char line[64];
+		snprintf(line, sizeof(line), "%-14s%6.2f %6.2f %5.2f", Profiler::stageName(stage),
+			prof.getStagePercentile(stage, 0.5f), prof.getStagePercentile(stage, 0.99f),
+			prof.getWorkerStagePercentile(stage, 0.99f));
+		ofSetColor(200);
+		ofDrawBitmapString(line, tx + 12, ty);
+	}
+	ty += 14;
+	char frameLine[64];
+	snprintf(frameLine, sizeof(frameLine), "%-14s%6.2f %6.2f", "frame",
+		prof.getFramePercentile(0.5f), prof.getFramePercentile(0.99f));
+	ofSetColor(255);
+	ofDrawBitmapString(frameLine, tx + 12, ty);
+
+	// Counters for the last complete frame
+	char counters[160];
+	snprintf(counters, sizeof(counters),
+		"draws %lld  rebuilds %lld  mesh builds %lld\nflowers %lld  falling %lld  dropped hops %d",
+		(long long)prof.getCount(ProfileCounter::DRAW_CALLS),
+		(long long)prof.getCount(ProfileCounter::REBUILDS),
+		(long long)prof.getCount(ProfileCounter::MESH_BUILDS),
+		(long long)prof.getCount(ProfileCounter::INSTANCES),
+		(long long)prof.getCount(ProfileCounter::FALLING_PETALS),
+		(int)analyzer.getDroppedHops());
+	ofSetColor(200);
+	ofDrawBitmapString(counters, x, y + graphH + 20);
+
+	if(governorEnabled){
+		char gov[160];
+		snprintf(gov, sizeof(gov),
+			"governor%s  limit %d  ceiling %d  spawn %d/tick  death %d/tick  LOD x%.2f  p99 %.2f ms",
+			governor.isStress() ? " (stress)" : "", governor.getCountLimit(), governor.getCeiling(),
+			governor.getSpawnsPerTick(), governor.getDeathMarksPerTick(), governor.getLodScale(),
+			governor.getWorkP99());
+		ofSetColor(255, 180, 80);
+		ofDrawBitmapString(gov, x, y + graphH + 50);
+	}
+	ofPopStyle();
+}
 
-	// Get the sink name for that index
-	std::string cmd = "pactl list short sinks 2>/dev/null | awk '$1 == " + std::to_string(sinkIdx) + " {print $2}'";
-	std::string sinkName = exec(cmd.c_str());
-	// Trim whitespace
-	while(!sinkName.empty() && (sinkName.back() == '\n' || sinkName.back() == '\r'))
-		sinkName.pop_back();
-
-	if(sinkName.empty()){
-		ofLogWarning("AudioRoute") << "Could not find sink name for index " << sinkIdx;
-		return;
+//--------------------------------------------------------------
+void ofApp::drawLatency(float x, float y){
+	ofPushStyle();
+	ofFill();
+	ofSetColor(0, 0, 0, 180);
+	ofDrawRectangle(x - 6, y - 6, 540, 124);
+
+	float ty = y + 8;
+	ofSetColor(200);
+	char title[80];
+	snprintf(title, sizeof(title), "sound -> screen     p50    p95    p99 ms   (%d frames)",
+		latency.getSampleCount());
+	ofDrawBitmapString(title, x, ty);
+	for(int s = 0; s < LatencyMonitor::kNumStages; s++){
+		LatencyStage stage = (LatencyStage)s;
+		ty += 12;
+		char line[80];
+		snprintf(line, sizeof(line), "%-15s %7.1f %6.1f %6.1f", LatencyMonitor::stageName(stage),
+			latency.getPercentile(stage, 0.5f), latency.getPercentile(stage, 0.95f),
+			latency.getPercentile(stage, 0.99f));
+		ofSetColor(stage == LatencyStage::TOTAL ? 255 : 200);
+		ofDrawBitmapString(line, x, ty);
 	}
 
-	std::string monitorName = sinkName + ".monitor";
-	ofLogNotice("AudioRoute") << "Found active playback on: " << sinkName;
-	ofLogNotice("AudioRoute") << "Routing input from: " << monitorName;
-
-	// Find our source-outputs (recording streams from this process)
-	std::string pid = std::to_string(getpid());
-	std::string sourceOutputs = exec("pactl list short source-outputs 2>/dev/null");
-
-	std::istringstream soStream(sourceOutputs);
-	std::string line;
-	while(std::getline(soStream, line)){
-		std::istringstream lineStream(line);
-		int soIdx;
-		if(lineStream >> soIdx){
-			std::string moveCmd = "pactl move-source-output " + std::to_string(soIdx)
-				+ " " + monitorName + " 2>/dev/null";
-			int ret = system(moveCmd.c_str());
-			if(ret == 0){
-				ofLogNotice("AudioRoute") << "Redirected source-output " << soIdx << " to " << monitorName;
-			}
-		}
+	// Not in the stamps: features describe the whole window, and the field
+	// smooths volume per frame
+	AudioAnalyzer::Settings settings = analyzer.getSettings();
+	float windowMs = 500.0f * settings.frameSize / settings.sampleRate;
+	float smoothingMs = 1000.0f * FlowerField::getVolumeSmoothingLag();
+	char model[96];
+	snprintf(model, sizeof(model), "+ window centre %.1f ms, volume smoothing ~%.0f ms (not in total)",
+		windowMs, smoothingMs);
+	ty += 16;
+	ofSetColor(140);
+	ofDrawBitmapString(model, x, ty);
+
+	char comp[96];
+	if(latencyCompensation){
+		snprintf(comp, sizeof(comp), "[C] beat look-ahead %.0f ms (median %+.0f)  [ ] trim",
+			flowerField.getBeatLookahead() * 1000.0f, lookaheadTrimMs);
+	} else {
+		snprintf(comp, sizeof(comp), "[C] beat look-ahead off");
 	}
+	ty += 14;
+	ofSetColor(latencyCompensation ? ofColor(0, 200, 150) : ofColor(140));
+	ofDrawBitmapString(comp, x, ty);
+	ofPopStyle();
+}
+
+//--------------------------------------------------------------
+std::string ofApp::pitchToNoteName(float freqHz){
+	if(freqHz <= 0.0f) return "--";
+	const char* noteNames[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+	int midiNote = (int)std::round(69.0f + 12.0f * std::log2(freqHz / 440.0f));
+	if(midiNote < 0 || midiNote > 127) return "--";
+	int noteIndex = midiNote % 12;
+	int octave = (midiNote / 12) - 1;
+	return std::string(noteNames[noteIndex]) + ofToString(octave);
 }
 
 //--------------------------------------------------------------
 void ofApp::exit(){
+	capture.stop();
 	soundStream.close();
-
-	if(windowing) AlgorithmFactory::free(windowing);
-	if(spectrum) AlgorithmFactory::free(spectrum);
-	if(pitchYinFFT) AlgorithmFactory::free(pitchYinFFT);
+	saveSnapshot();
+	snapshotWriter.stop();   // finishes the final write
+	analyzer.stop();
 
 	essentia::shutdown();
 }
@@ -398,9 +541,44 @@ void ofApp::keyPressed(int key){
 	if(key == 'd' || key == 'D'){
 		debugMode = !debugMode;
 	}
+	if(key == 'p' || key == 'P'){
+		showProfiler = !showProfiler;
+	}
+	if(key == 'l' || key == 'L'){
+		LodSettings lod = flowerField.getLodSettings();
+		lod.enabled = !lod.enabled;
+		flowerField.setLodSettings(lod);
+	}
+	if(key == 'a' || key == 'A'){
+		LodSettings lod = flowerField.getLodSettings();
+		lod.spriteAtlas = !lod.spriteAtlas;
+		flowerField.setLodSettings(lod);
+	}
+	if(key == 'r' || key == 'R'){
+		setAnalysisProfile((AnalysisProfile)(((int)analysisProfile + 1) % kNumAnalysisProfiles));
+	}
+	if(key == 'w' || key == 'W'){
+		flowerField.setRipples(!flowerField.getRipples());
+	}
+	if(key == 'g' || key == 'G'){
+		setGovernor(!governorEnabled);
+	}
+	if(key == 's' || key == 'S'){
+		setStress(!governor.isStress());
+	}
 	if(key == ' '){
 		flowerField.setReactiveMode(!flowerField.isReactiveMode());
 	}
+	if(key == 'c' || key == 'C'){
+		latencyCompensation = !latencyCompensation;
+	}
+	if(key == '[' || key == ']'){
+		lookaheadTrimMs += (key == ']') ? 5.0f : -5.0f;
+	}
+	if(key == 'i' || key == 'I'){
+		bool instanced = flowerField.getRenderMode() == FieldRenderMode::INSTANCED;
+		flowerField.setRenderMode(instanced ? FieldRenderMode::IMMEDIATE : FieldRenderMode::INSTANCED);
+	}
 	// Color schemes: 0=iterate, 1-8=scheme, 9=random
 	if(key >= '0' && key <= '9'){
 		flowerField.setColorMode(key - '0');
@@ -2,10 +2,15 @@
 
 #include "ofMain.h"
 #include "Flower.h"
+#include "AudioRingBuffer.h"
+#include "AudioAnalyzer.h"
+#include "Profiler.h"
+#include "DebugPlots.h"
+#include "PulseCapture.h"
+#include "LatencyMonitor.h"
+#include "FrameGovernor.h"
+#include <chrono>
 #include <essentia/essentia.h>
-#include <essentia/algorithmfactory.h>
-#include <mutex>
-#include <deque>
 
 class ofApp : public ofBaseApp{
 
@@ -30,48 +35,78 @@ class ofApp : public ofBaseApp{
 		void dragEvent(ofDragInfo dragInfo) override;
 		void gotMessage(ofMessage msg) override;
 
+		// Split the window into cols x rows outputs (e.g. one per projector
+		// of a spanning fullscreen window); call before setup
+		void setTiles(int cols, int rows);
+
+		// Preallocate this many flowers and start in stress mode, pinning the
+		// count at the most this machine holds within the frame budget; call
+		// before setup
+		void setStressCapacity(int maxFlowers);
+
 	private:
 		void drawDebug();
 		void drawMain();
+		void drawField();
+		void drawProfiler(float x, float y);
+		void drawLatency(float x, float y);
 		std::string pitchToNoteName(float freqHz);
-		void autoRouteAudio();
+		void setupCapture(int bufferSize);
+		void setAnalysisProfile(AnalysisProfile profile);
+		void saveSnapshot();
+		void setGovernor(bool enabled);
+		void setStress(bool enabled);
+		void applyGovernor();
 
 		// Mode
 		bool debugMode = true;
+		bool showProfiler = false;   // overlay in main mode (always on in debug)
 
-		// Audio input
+		// Audio input: native capture from the playing sink's monitor, or
+		// oF's sound stream on the default input if no server is reachable
+		PulseCapture capture;
 		ofSoundStream soundStream;
+		int streamBufferSize = 0;
+
+		// Lock-free hand-off from the audio callback
+		AudioRingBuffer audioRing;
+
+		// Essentia pipeline on its own thread, hop-based
+		AudioAnalyzer analyzer;
+		AnalysisProfile analysisProfile = AnalysisProfile::STANDARD;
 
-		// Thread-safe audio buffering
-		std::mutex audioMutex;
-		std::vector<float> audioInputBuffer;
-		std::vector<float> processingBuffer;
-		float rmsVolume = 0.0f;
-
-		// Essentia algorithms
-		essentia::standard::Algorithm* windowing = nullptr;
-		essentia::standard::Algorithm* spectrum = nullptr;
-		essentia::standard::Algorithm* pitchYinFFT = nullptr;
-
-		// Essentia I/O buffers
-		std::vector<essentia::Real> frame;
-		std::vector<essentia::Real> windowedFrame;
-		std::vector<essentia::Real> spectrumValues;
-		essentia::Real currentPitch = 0.0f;
-		essentia::Real currentPitchConfidence = 0.0f;
-
-		// Visualization state
-		std::vector<float> displaySpectrum;
-		float smoothedPitch = 0.0f;
-		float smoothedConfidence = 0.0f;
-		std::deque<std::pair<float, float>> melodyHistory; // pitch, confidence
-
-		// Flower field visualization
+		// Sound-to-screen latency from the capture stamps, and optional
+		// predictive beat compensation by the measured median
+		LatencyMonitor latency;
+		bool latencyCompensation = false;
+		float lookaheadTrimMs = 0.0f;     // added to the measured median
+
+		// Debug view: fixed rings and persistent GPU buffers
+		MelodyTrail melodyTrail;
+		SpectrumBars spectrumBars;
+
+		// Flower field visualization: one simulation, drawn once per tile
 		FlowerField flowerField;
-		float spectralFullness = 0.0f;
-		float bassEnergy = 0.0f;
+		int tileCols = 1;
+		int tileRows = 1;
+		static const int kFlowerCount = 300;
+
+		// Frame-time governor: spawn/death budgets, count limit and LOD kept
+		// within the 60 Hz budget
+		FrameGovernor governor;
+		bool governorEnabled = false;
+		int stressCapacity = 0;           // 0 = the field's default capacity
+		float frameWorkMs = 0.0f;         // CPU time of the last update + draw
+		std::chrono::steady_clock::time_point frameStart;
+
+		// Field state saved in the background every few seconds and restored
+		// at startup, so a restarted installation comes back where it was
+		SnapshotWriter snapshotWriter;
+		SnapshotBuilder snapshotBuilder;
+		std::string snapshotPath;
+		float lastSnapshotTime = 0.0f;
+		static constexpr float kSnapshotInterval = 10.0f;   // seconds
 
-		// Constants
-		static const int kFrameSize = 2048;
+		// Constants (frame, hop and buffer sizes come from the analysis profile)
 		static const int kSampleRate = 44100;
 };